@@ -1,6 +1,7 @@
 #include <unistd.h>
 #include "protocol.h"
 #include "network.h"
+#include "compress.h"
 #include "ui.h"
 #include "menu.h"
 #include <stdio.h>
@@ -10,6 +11,16 @@
 #include <signal.h>
 #include <sys/wait.h>
 #include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+#define LOCAL_CHECKPOINT_DIR "checkpoints"  // checkpointy lokalneho servera (obnova hier po jeho pade)
+#define RECONNECT_ATTEMPTS 10               // pokusy o navrat do hry po vypadku servera
+#define RECONNECT_DELAY_US 1000000          // pauza medzi pokusmi
+#define DATAGRAM_HELLO_ATTEMPTS 10          // pokusy o otvorenie UDP kanala (potom len TCP)
+#define DATAGRAM_POLL_MS 200                // odstup pokusov a kontroly ukoncenia UDP vlakna
 
 typedef struct {//stav klienta
     int socket;//socket spojenia
@@ -21,54 +32,258 @@ typedef struct {//stav klienta
     bool state_updated;//ci bol stav aktualizovany
     char connected_host[256];//host servera
     int connected_port;//port servera
+    int connected_game_id;//ID hry na serveri (pre rejoin)
     bool death_handled;//ci bola smrt uz spracovana
+    pthread_mutex_t send_mutex;//mutex pre posielanie (vstupy a potvrdenia z dvoch vlakien)
+    GameState history[STATE_HISTORY_SIZE];//posledne prijate snapshoty (baseline pre delty)
+    uint8_t *obstacles;//prekazky z MSG_MAP (zdielane vsetkymi snapshotmi)
+    uint32_t map_id;//ID mapy, ku ktorej patria obstacles
+    char names[MAX_PLAYERS][MAX_NAME_LENGTH];//mena hracov z MSG_ROSTER (nie su v snapshotoch)
+    int name_serials[MAX_PLAYERS];//spawn, ku ktoremu meno patri
+    bool joined;//server potvrdil vstup (MSG_JOINED)
+    uint64_t rejoin_token;//token na navrat do slotu po restarte servera (0 = ziadny)
+    bool connection_lost;//spojenie padlo (nie chyba od servera)
+    int latest_tick;//tick posledneho snapshotu (starsie sa zahodia - UDP a TCP sa mozu predbiehat)
+    int connection_serial;//cislo spojenia (UDP vlakno stareho spojenia skonci)
 } ClientState;
 
 static ClientState client_state;//globalny stav klienta
 static volatile bool running = true;//klient bezi
 static pid_t server_pid = -1;//PID lokalneho servera
 static int last_connected_port = DEFAULT_PORT;//posledny pouzity port
+static int last_connected_game_id = ANY_GAME_ID;//posledna hra (pre rejoin)
 
 void signal_handler(int sig) {//spracovanie signalov (Ctrl+C)
     (void)sig;
     running = false;//zastav klienta
 }
 
+static bool send_message(const Message *msg) {//serializuje a posle spravu serveru (thread-safe)
+    uint8_t buffer[SMALL_MESSAGE_MAX_SIZE];//spravy od klienta su male (bez stavu hry)
+    size_t size;
+    serialize_message(msg, buffer, &size);//serializuj spravu
+    
+    pthread_mutex_lock(&client_state.send_mutex);//ramce z roznych vlakien sa nesmu prekryvat
+    bool ok = send_data(client_state.socket, buffer, size);//posli serveru
+    pthread_mutex_unlock(&client_state.send_mutex);
+    return ok;
+}
+
+static void reset_history(void) {//zabudne prijate snapshoty a mena (nove spojenie)
+    for (int i = 0; i < STATE_HISTORY_SIZE; i++) {
+        client_state.history[i].tick = -1;//prazdny slot
+    }
+    client_state.latest_tick = -1;//obnovena hra moze pokracovat zo starsieho ticku
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        client_state.name_serials[i] = 0;//ziadne meno
+    }
+}
+
+static void apply_names(GameState *state) {//doplni mena hracov do stavu podla rosteru
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Snake *snake = &state->snakes[i];
+        if (snake->serial != 0 && snake->serial == client_state.name_serials[i]) {//meno patri tomuto spawnu
+            memcpy(snake->name, client_state.names[i], MAX_NAME_LENGTH);
+        } else {
+            snake->name[0] = '\0';//meno este neprislo
+        }
+    }
+}
+
+static void store_state(const GameState *state) {//ulozi novy snapshot a potvrdi ho serveru (mutex musi byt zamknuty)
+    client_state.history[state->tick % STATE_HISTORY_SIZE] = *state;//baseline pre buduce delty
+    client_state.current_state = *state;//uloz novy stav
+    client_state.current_state.obstacles = (client_state.obstacles && state->map_id == client_state.map_id)
+        ? client_state.obstacles : NULL;//prekazky su zdielane, ak uz mame spravnu mapu
+    apply_names(&client_state.current_state);//mena nie su v snapshotoch
+    client_state.state_updated = true;//oznac stav ako aktualizovany
+    
+    // Check if game is over
+    if (state->game_over) {//ak je hra ukoncena
+        client_state.game_active = false;
+    }
+}
+
+static void acknowledge_state(int tick) {//potvrdi serveru prijaty snapshot
+    Message ack;
+    ack.type = MSG_STATE_ACK;//potvrdenie snapshotu
+    ack.player_id = client_state.my_player_id;
+    ack.data.tick = tick;
+    send_message(&ack);
+}
+
+static void handle_snapshot(const Message *msg, const uint8_t *payload, size_t size) {//spracuje keyframe alebo deltu (TCP aj UDP)
+    static GameState next_state;//novy stav (velka struktura mimo zasobnika, chranena mutexom)
+    int tick = msg->type == MSG_GAME_STATE ? msg->data.keyframe.tick : msg->data.delta.tick;
+    bool applied = false;
+
+    pthread_mutex_lock(&client_state.state_mutex);//zamkni mutex
+    if (tick <= client_state.latest_tick) {//starsi snapshot prisiel po novsom
+        pthread_mutex_unlock(&client_state.state_mutex);
+        return;
+    }
+    if (msg->type == MSG_GAME_STATE) {//keyframe - cely stav hry od servera
+        if (deserialize_game_state(payload, size, &next_state)) {
+            store_state(&next_state);
+            applied = true;
+        }
+    } else {//delta voci potvrdenemu snapshotu
+        const GameState *baseline = &client_state.history[msg->data.delta.baseline_tick % STATE_HISTORY_SIZE];
+        if (baseline->tick == msg->data.delta.baseline_tick &&
+            apply_state_delta(payload, size, baseline, &next_state)) {//baseline mame, aplikuj deltu
+            store_state(&next_state);
+            applied = true;
+        }
+    }
+    if (applied) {
+        client_state.latest_tick = tick;
+    }
+    pthread_mutex_unlock(&client_state.state_mutex);//odomkni mutex
+
+    if (applied) {
+        acknowledge_state(tick);//server moze posielat delty voci tomuto stavu
+    }
+}
+
+static void *datagram_thread(void *arg) {//UDP kanal snapshotov jedneho spojenia
+    int serial = (int)(intptr_t)arg;
+    int sock = connect_datagram_socket(client_state.connected_host, client_state.connected_port);
+    if (sock < 0) {
+        return NULL;
+    }
+
+    Message hello;//overi hraca a cestu v oboch smeroch
+    memset(&hello, 0, sizeof(hello));
+    hello.type = MSG_UDP_HELLO;
+    hello.player_id = client_state.my_player_id;
+    hello.data.joined.game_id = client_state.connected_game_id;
+    hello.data.joined.rejoin_token = client_state.rejoin_token;
+    uint8_t hello_data[SMALL_MESSAGE_MAX_SIZE];
+    size_t hello_size;
+    serialize_message(&hello, hello_data, &hello_size);
+
+    Message msg;//prijaty snapshot (len hlavicka, telo sa aplikuje priamo do stavu)
+    uint8_t buffer[DATAGRAM_MAX_PAYLOAD];
+    MessageBuffer inflated = { NULL, 0 };//rozbaleny komprimovany snapshot
+    bool ready = false;//server odpovedal, snapshoty chodia cez UDP
+    int attempts = 0;
+    while (running && client_state.connected && client_state.connection_serial == serial) {
+        if (!ready) {
+            if (attempts++ == DATAGRAM_HELLO_ATTEMPTS) {//server bez UDP (alebo ho siet blokuje) - ostava TCP
+                break;
+            }
+            send(sock, hello_data, hello_size, 0);
+        }
+
+        struct pollfd pfd = { .fd = sock, .events = POLLIN };
+        if (poll(&pfd, 1, DATAGRAM_POLL_MS) <= 0) {//nic neprislo, znova over stav spojenia
+            continue;
+        }
+        ssize_t received = recv(sock, buffer, sizeof(buffer), 0);
+        if (received < 0) {
+            if (errno == ECONNREFUSED && !ready) {//server nepocuva na UDP
+                break;
+            }
+            continue;
+        }
+        const uint8_t *payload = buffer;
+        if (is_compressed_message(buffer, received)) {//snapshot komprimovany dohodnutym kodekom
+            received = decompress_message(buffer, received, &inflated);
+            payload = inflated.data;
+        }
+        if (received < 0 || !deserialize_message(payload, received, &msg)) {
+            continue;
+        }
+        if (msg.type == MSG_UDP_HELLO && !ready) {//cesta funguje, server moze prepnut snapshoty
+            Message confirm;
+            memset(&confirm, 0, sizeof(confirm));
+            confirm.type = MSG_UDP_READY;
+            confirm.player_id = client_state.my_player_id;
+            ready = send_message(&confirm);//spolahlivo cez TCP
+        } else if (msg.type == MSG_GAME_STATE || msg.type == MSG_STATE_DELTA) {
+            handle_snapshot(&msg, payload, received);
+        }
+    }
+
+    close(sock);
+    free_message_buffer(&inflated);
+    return NULL;
+}
+
 void *receive_thread(void *arg) {//vlakno pre prijem sprav od servera
     (void)arg;
-    uint8_t buffer[BUFFER_SIZE];//buffer pre prijem dat
+    FrameReader reader = { NULL, 0, 0, 0 };//citac ramcov (viac sprav na jeden recv)
+    MessageBuffer inflated = { NULL, 0 };//rozbalena komprimovana sprava
     
     while (running && client_state.connected) {//kym bezi klient a je pripojeny
-        ssize_t received = receive_data(client_state.socket, buffer, BUFFER_SIZE);//prijmi data
+        const uint8_t *payload;
+        ssize_t received = read_frame(&reader, client_state.socket, &payload);//prijmi spravu
         if (received <= 0) {//chyba alebo odpojenie
+            client_state.connection_lost = true;//server mohol spadnut - skusi sa rejoin
             client_state.connected = false;
             break;
         }
         
+        if (is_compressed_message(payload, received)) {//snapshot komprimovany dohodnutym kodekom
+            received = decompress_message(payload, received, &inflated);
+            if (received < 0) {
+                continue;//poskodena sprava
+            }
+            payload = inflated.data;
+        }
+        
         Message msg;
-        if (!deserialize_message(buffer, received, &msg)) {//deserializuj spravu
+        if (!deserialize_message(payload, received, &msg)) {//deserializuj spravu
             continue;//neplatna sprava
         }
         
         switch (msg.type) {//spracuj spravu podla typu
-            case MSG_GAME_STATE://stav hry od servera
+            case MSG_GAME_STATE://keyframe - cely stav hry od servera
+            case MSG_STATE_DELTA://delta voci potvrdenemu snapshotu
+                handle_snapshot(&msg, payload, received);
+                break;
+
+            case MSG_MAP://staticka mapa prekazok (raz pri pripojeni)
                 pthread_mutex_lock(&client_state.state_mutex);//zamkni mutex
-                
-                // Free old obstacles if any
-                if (client_state.current_state.obstacles) {//uvolni stare prekazky
-                    free(client_state.current_state.obstacles);
+                if (client_state.obstacles && client_state.map_id == msg.data.map.map_id) {//tuto mapu uz mame
+                    free(msg.data.map.obstacles);
+                } else {
+                    free(client_state.obstacles);//uvolni staru mapu
+                    client_state.obstacles = msg.data.map.obstacles;
+                    client_state.map_id = msg.data.map.map_id;
                 }
+                if (client_state.current_state.map_id == client_state.map_id) {//aktualny stav moze hned kreslit prekazky
+                    client_state.current_state.obstacles = client_state.obstacles;
+                }
+                pthread_mutex_unlock(&client_state.state_mutex);//odomkni mutex
+                break;
                 
-                client_state.current_state = msg.data.state;//uloz novy stav
-                client_state.state_updated = true;//oznac stav ako aktualizovany
-                
-                // Check if game is over
-                if (msg.data.state.game_over) {//ak je hra ukoncena
-                    client_state.game_active = false;
+            case MSG_ROSTER://mena hracov (pri kazdom pripojeni)
+                pthread_mutex_lock(&client_state.state_mutex);//zamkni mutex
+                for (int i = 0; i < msg.data.roster.count; i++) {
+                    int id = msg.data.roster.players[i].player_id;
+                    if (id >= 0 && id < MAX_PLAYERS) {
+                        client_state.name_serials[id] = msg.data.roster.players[i].serial;
+                        memcpy(client_state.names[id], msg.data.roster.players[i].name, MAX_NAME_LENGTH);
+                    }
                 }
+                apply_names(&client_state.current_state);
                 pthread_mutex_unlock(&client_state.state_mutex);//odomkni mutex
                 break;
                 
+            case MSG_JOINED: {//nase ID a token (pred mapou a prvym stavom)
+                client_state.my_player_id = msg.player_id;
+                client_state.rejoin_token = msg.data.joined.rejoin_token;
+                client_state.connected_game_id = msg.data.joined.game_id;//aj ked sme sa pripajali do ANY_GAME_ID
+                client_state.joined = true;
+
+                pthread_t thread;//snapshoty cez UDP, ak ho server podporuje
+                if (pthread_create(&thread, NULL, datagram_thread, (void *)(intptr_t)client_state.connection_serial) == 0) {
+                    pthread_detach(thread);
+                }
+                break;
+            }
+                
             case MSG_ERROR://chybova sprava od servera
                 show_error(msg.data.error_msg);//zobraz chybu
                 client_state.connected = false;//odpoj sa
@@ -79,10 +294,23 @@ void *receive_thread(void *arg) {//vlakno pre prijem sprav od servera
         }
     }
     
+    free_frame_reader(&reader);//uvolni buffer
+    free_message_buffer(&inflated);
     return NULL;
 }
 
-bool start_local_server(const GameConfig *config, int *port) {//spusti lokalny server ako child proces
+bool start_local_server(int port) {//zabezpeci lokalny server na porte (spusti ho ako child proces ak nebezi)
+    int test_sock = connect_to_server("127.0.0.1", port);//bezi uz server na tomto porte?
+    if (test_sock >= 0) {//ano - nova hra sa vytvori v nom
+        close_socket(test_sock);
+        return true;
+    }
+    
+    if (server_pid > 0) {//predchadzajuci server uz skoncil (vsetky jeho hry dobehli)
+        waitpid(server_pid, NULL, WNOHANG);//uprac child proces
+        server_pid = -1;
+    }
+    
     server_pid = fork();//vytvor child proces
     
     if (server_pid < 0) {//chyba pri forku
@@ -96,46 +324,13 @@ bool start_local_server(const GameConfig *config, int *port) {//spusti lokalny s
         freopen("/dev/null", "w", stdout);//presmeruj stdout do /dev/null (aby neskreslil ncurses)
         freopen("/dev/null", "w", stderr);//presmeruj stderr do /dev/null
         
-        char port_str[16];//stringy pre argumenty servera
-        char width_str[16];
-        char height_str[16];
-        char time_str[16];
-        char max_players_str[16];
-        
-        snprintf(port_str, sizeof(port_str), "%d", *port);//konvertuj cisla na stringy
-        snprintf(width_str, sizeof(width_str), "%d", config->width);
-        snprintf(height_str, sizeof(height_str), "%d", config->height);
-        snprintf(max_players_str, sizeof(max_players_str), "%d", config->max_players);
+        char port_str[16];//string pre port
+        snprintf(port_str, sizeof(port_str), "%d", port);
         
-        char *args[20];//pole argumentov pre execvp
-        int arg_idx = 0;
-        
-        args[arg_idx++] = "./server";//nazov programu
-        args[arg_idx++] = "-p";//port
-        args[arg_idx++] = port_str;
-        args[arg_idx++] = "-w";//sirka
-        args[arg_idx++] = width_str;
-        args[arg_idx++] = "-h";//vyska
-        args[arg_idx++] = height_str;
-        args[arg_idx++] = "-n";//max pocet hracov
-        args[arg_idx++] = max_players_str;
-        
-        if (config->mode == MODE_TIMED) {//ak je casovany mod
-            args[arg_idx++] = "-t";
-            snprintf(time_str, sizeof(time_str), "%d", config->time_limit);
-            args[arg_idx++] = time_str;
-        }
-        
-        if (config->world_type == WORLD_WITH_OBSTACLES) {//ak ma prekazky
-            if (config->load_from_file && config->map_file[0] != '\0') {//nacitaj zo suboru
-                args[arg_idx++] = "-m";
-                args[arg_idx++] = (char *)config->map_file;
-            } else {//generuj nahodne
-                args[arg_idx++] = "-o";
-            }
-        }
-        
-        args[arg_idx] = NULL;//ukoncovaci NULL
+        // Server without initial game: games are created over the network
+        // and the server exits after the last one ends
+        // Checkpoints let a restarted server continue the games of a crashed one
+        char *args[] = { "./server", "-p", port_str, "-x", "-C", LOCAL_CHECKPOINT_DIR, NULL };//argumenty servera
         
         execvp("./server", args);//spusti server (nahradi tento proces)
         exit(1);//ak execvp zlyhalo
@@ -143,16 +338,13 @@ bool start_local_server(const GameConfig *config, int *port) {//spusti lokalny s
     
     // Parent process - wait for server to start
     // Check if server started successfully by trying to connect
-    sleep(1);//pocakaj 1 sekundu aby server nabehol
-    
-    // Try to verify server is listening (with retries)
-    for (int i = 0; i < 3; i++) {//skus 3x ci server nabehol
-        int test_sock = connect_to_server("127.0.0.1", *port);//pokus sa pripojit
+    for (int i = 0; i < 30; i++) {//cakaj max 3s kym server nabehne
+        usleep(100000);//cakaj 100ms medzi pokusmi
+        test_sock = connect_to_server("127.0.0.1", port);//pokus sa pripojit
         if (test_sock >= 0) {//ak sa podarilo pripojit
             close_socket(test_sock);//zatvor testovaci socket
             return true;//server bezi!
         }
-        usleep(500000);//cakaj 0.5s medzi pokusmi
     }
     
     // Server didn't start - kill the child process
@@ -162,15 +354,108 @@ bool start_local_server(const GameConfig *config, int *port) {//spusti lokalny s
     return false;//server sa nespustil
 }
 
-void stop_local_server(void) {//zastavi lokalny server
-    if (server_pid > 0) {//ak je server spusteny
-        kill(server_pid, SIGTERM);//posli signal SIGTERM
-        waitpid(server_pid, NULL, 0);//pocakaj na ukoncenie
-        server_pid = -1;//vynuluj PID
+bool request_new_game(const char *host, int port, const GameConfig *config, int *game_id) {//vytvori novu hru na serveri
+    int socket = connect_to_server(host, port);//samostatne kratke spojenie
+    if (socket < 0) {
+        return false;
     }
+    
+    Message msg;//vytvor poziadavku na novu hru
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_CREATE_GAME;
+    msg.player_id = -1;
+    msg.data.config = *config;
+    
+    uint8_t buffer[SMALL_MESSAGE_MAX_SIZE];
+    size_t size;
+    serialize_message(&msg, buffer, &size);
+    
+    bool created = false;
+    if (send_data(socket, buffer, size)) {
+        MessageBuffer reply = { NULL, 0 };//odpoved servera
+        ssize_t received = receive_message(socket, &reply);
+        Message answer;
+        if (received > 0 && deserialize_message(reply.data, received, &answer)) {
+            if (answer.type == MSG_GAME_CREATED) {//server vratil ID hry
+                *game_id = answer.data.game_id;
+                created = true;
+            } else if (answer.type == MSG_ERROR) {
+                show_error(answer.data.error_msg);//zobraz chybu
+            }
+        }
+        free_message_buffer(&reply);
+    }
+    
+    close_socket(socket);
+    return created;
 }
 
-bool connect_to_game(const char *host, int port, const char *player_name) {//pripoj sa k serveru a vstup do hry
+bool browse_games(const char *host, int port, int *game_id) {//zobrazi zoznam hier na serveri a necha hraca vybrat
+    int socket = connect_to_server(host, port);//spojenie pre dotazy do lobby
+    if (socket < 0) {
+        show_error("Failed to connect to server");
+        return false;
+    }
+    
+    int cursors[256];//kurzor (ID poslednej hry predchadzajucej stranky) pre kazdu navstivenu stranku
+    int page = 0;//aktualna stranka
+    int selected = 0;//vybrana hra v stranke
+    cursors[0] = 0;//prva stranka
+    bool chosen = false;
+    MessageBuffer buffer = { NULL, 0 };//buffer pre odpovede
+    
+    while (running) {
+        Message msg;//poziadavka na stranku
+        memset(&msg, 0, sizeof(msg));
+        msg.type = MSG_LIST_GAMES;
+        msg.player_id = -1;
+        msg.data.after_game_id = cursors[page];
+        
+        uint8_t request[SMALL_MESSAGE_MAX_SIZE];
+        size_t size;
+        serialize_message(&msg, request, &size);
+        
+        Message reply;
+        ssize_t received = send_data(socket, request, size) ? receive_message(socket, &buffer) : -1;
+        if (received <= 0 || !deserialize_message(buffer.data, received, &reply) || reply.type != MSG_GAME_LIST) {
+            show_error("Failed to get list of games");
+            break;
+        }
+        
+        if (reply.data.game_list.count == 0 && page > 0) {//stranka medzicasom zanikla
+            page--;
+            continue;
+        }
+        
+        BrowserAction action = show_game_browser(reply.data.game_list.games, reply.data.game_list.count,
+                                                 reply.data.game_list.total, page, &selected);
+        if (action == BROWSER_JOIN) {//hrac vybral hru
+            *game_id = reply.data.game_list.games[selected].game_id;
+            chosen = true;
+            break;
+        } else if (action == BROWSER_NEXT_PAGE) {//dalsia stranka ak existuje
+            int count = reply.data.game_list.count;
+            if (count == GAME_LIST_PAGE_SIZE && page + 1 < (int)(sizeof(cursors) / sizeof(cursors[0]))) {
+                cursors[page + 1] = reply.data.game_list.games[count - 1].game_id;
+                page++;
+                selected = 0;
+            }
+        } else if (action == BROWSER_PREV_PAGE) {//predchadzajuca stranka
+            if (page > 0) {
+                page--;
+                selected = 0;
+            }
+        } else if (action == BROWSER_CANCEL) {//spat do menu
+            break;
+        }
+    }
+    
+    free_message_buffer(&buffer);
+    close_socket(socket);
+    return chosen;
+}
+
+static bool join_server(const char *host, int port, int game_id, const char *player_name, uint64_t rejoin_token) {//pripoj sa k serveru a vstup do hry (token = navrat do slotu)
     client_state.socket = connect_to_server(host, port);//pripoj sa k serveru
     if (client_state.socket < 0) {//ak sa nepodarilo pripojit
         return false;
@@ -178,26 +463,33 @@ bool connect_to_game(const char *host, int port, const char *player_name) {//pri
     
     // Send join message
     Message msg;//vytvor join spravu
+    memset(&msg, 0, sizeof(msg));
     msg.type = MSG_JOIN_GAME;//typ - pripojenie do hry
     msg.player_id = -1;//este nemame ID
+    msg.data.join_info.version = PROTOCOL_VERSION;//server odmietne nepodporovanu verziu
     strncpy(msg.data.join_info.name, player_name, MAX_NAME_LENGTH - 1);//meno hraca
-    msg.data.join_info.port = port;//port servera
-    
-    uint8_t buffer[BUFFER_SIZE];//buffer pre serializaciu
-    size_t size;
-    serialize_message(&msg, buffer, &size);//serializuj spravu
+    msg.data.join_info.game_id = game_id;//hra na serveri
+    msg.data.join_info.rejoin_token = rejoin_token;
+    msg.data.join_info.codecs = SUPPORTED_CODECS;//server vyberie kodek snapshotov
     
-    if (!send_data(client_state.socket, buffer, size)) {//posli join spravu
+    reset_history();//snapshoty z predchadzajuceho spojenia neplatia
+    client_state.connection_serial++;//UDP vlakno stareho spojenia skonci
+
+    if (!send_message(&msg)) {//posli join spravu
         close_socket(client_state.socket);
         return false;
     }
     
     client_state.connected = true;//sme pripojeni
+    client_state.connection_lost = false;
+    client_state.joined = false;//caka na MSG_JOINED
     client_state.game_active = true;//hra je aktivna
     client_state.death_handled = false;//resetuj flag smrti
     last_connected_port = port;//uloz port pre rejoin
+    last_connected_game_id = game_id;//uloz hru pre rejoin
     strncpy(client_state.connected_host, host, sizeof(client_state.connected_host) - 1);//uloz host
     client_state.connected_port = port;//uloz port
+    client_state.connected_game_id = game_id;//uloz ID hry
     
     // Start receive thread
     pthread_t thread;//vlakno pre prijem sprav
@@ -212,8 +504,8 @@ bool connect_to_game(const char *host, int port, const char *player_name) {//pri
     // Extra wait to ensure we get the REAL initialized state (not stale data)
     usleep(200000);//este 200ms pre istotu (aby sme dostali spravne inicializovany stav)
     
-    // Find our player ID
-    for (int i = 0; i < MAX_PLAYERS; i++) {//najdi nase ID podla mena
+    // Find our player ID (server without MSG_JOINED)
+    for (int i = 0; i < MAX_PLAYERS && !client_state.joined; i++) {//najdi nase ID podla mena
         if (strcmp(client_state.current_state.snakes[i].name, player_name) == 0) {
             client_state.my_player_id = i;//uloz nase ID
             break;
@@ -223,16 +515,49 @@ bool connect_to_game(const char *host, int port, const char *player_name) {//pri
     return true;//pripojenie uspesne
 }
 
+bool connect_to_game(const char *host, int port, int game_id, const char *player_name) {//pripoj sa k serveru a vstup do hry
+    return join_server(host, port, game_id, player_name, 0);
+}
+
+static bool reconnect_to_game(void) {//po vypadku servera sa vrati do svojho slotu (server obnovi hru z checkpointu)
+    char host[256];//join_server prepisuje connected_host
+    strncpy(host, client_state.connected_host, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+    int port = client_state.connected_port;
+    int game_id = client_state.connected_game_id;
+    uint64_t token = client_state.rejoin_token;
+    close_socket(client_state.socket);//spadnute spojenie
+    
+    int max_y, max_x;
+    getmaxyx(stdscr, max_y, max_x);
+    for (int attempt = 0; attempt < RECONNECT_ATTEMPTS && running; attempt++) {
+        clear();
+        mvprintw(max_y / 2, (max_x - 30) / 2, "Server lost, reconnecting...");//zobraz spravu
+        refresh();
+        
+        if (server_pid > 0) {//nas lokalny server spadol - spusti ho znova
+            start_local_server(port);
+        }
+        if (join_server(host, port, game_id, "", token)) {
+            if (client_state.connected && client_state.joined) {//server vratil slot
+                return true;
+            }
+            close_socket(client_state.socket);
+            if (!client_state.connection_lost) {//server odmietol (hra uz neexistuje)
+                return false;
+            }
+        }
+        usleep(RECONNECT_DELAY_US);//server este nenabehol
+    }
+    return false;
+}
+
 void disconnect_from_game(void) {//odpoj sa od hry
     if (client_state.connected) {//ak sme pripojeni
         Message msg;//vytvor disconnect spravu
         msg.type = MSG_PLAYER_DISCONNECT;//typ - odpojenie
         msg.player_id = client_state.my_player_id;//nase ID
-        
-        uint8_t buffer[BUFFER_SIZE];//buffer pre serializaciu
-        size_t size;
-        serialize_message(&msg, buffer, &size);//serializuj spravu
-        send_data(client_state.socket, buffer, size);//posli serveru
+        send_message(&msg);//posli serveru
         
         client_state.connected = false;//uz nie sme pripojeni
         close_socket(client_state.socket);//zatvor socket
@@ -242,7 +567,13 @@ void disconnect_from_game(void) {//odpoj sa od hry
 void game_loop(void) {//hlavna hernia slucka klienta
     bool locally_paused = false;//ci sme lokalne v pause menu
     
-    while (running && client_state.game_active && client_state.connected) {//kym bezi klient, hra je aktivna a sme pripojeni
+    while (running && client_state.game_active) {//kym bezi klient a hra je aktivna
+        if (!client_state.connected) {//spojenie skoncilo
+            if (!client_state.connection_lost || client_state.rejoin_token == 0 || !reconnect_to_game()) {
+                break;//chyba od servera alebo sa nepodarilo vratit
+            }
+        }
+        
         // Handle input
         int ch = getch();//precitaj klavesovu spravu (non-blocking)
         
@@ -283,10 +614,7 @@ void game_loop(void) {//hlavna hernia slucka klienta
                     // Send MSG_PAUSE immediately
                     msg.type = MSG_PAUSE;//posli pause spravu
                     if (client_state.connected) {
-                        uint8_t buffer[BUFFER_SIZE];
-                        size_t size;
-                        serialize_message(&msg, buffer, &size);
-                        send_data(client_state.socket, buffer, size);
+                        send_message(&msg);
                     }
                     
                     locally_paused = true;//sme v pauze
@@ -298,10 +626,7 @@ void game_loop(void) {//hlavna hernia slucka klienta
                         // Send MSG_RESUME immediately
                         msg.type = MSG_RESUME;//posli resume spravu
                         if (client_state.connected) {
-                            uint8_t buffer[BUFFER_SIZE];
-                            size_t size;
-                            serialize_message(&msg, buffer, &size);
-                            send_data(client_state.socket, buffer, size);
+                            send_message(&msg);
                         }
                         locally_paused = false;//uz nie sme v pauze
                     } else if (choice == MENU_EXIT || choice == MENU_NEW_GAME) {//hrac chce odist
@@ -317,10 +642,7 @@ void game_loop(void) {//hlavna hernia slucka klienta
         }
         
         if (send_input && client_state.connected) {//ak mame poslat vstup a sme pripojeni
-            uint8_t buffer[BUFFER_SIZE];
-            size_t size;
-            serialize_message(&msg, buffer, &size);//serializuj spravu
-            send_data(client_state.socket, buffer, size);//posli serveru
+            send_message(&msg);//posli serveru
         }
         
         // Render - always render to show game state, even when in pause menu
@@ -403,7 +725,7 @@ void game_loop(void) {//hlavna hernia slucka klienta
                         usleep(500000);//cakaj 0.5s
                         
                         // Reconnect (this will reset death_handled to false)
-                        if (connect_to_game(client_state.connected_host, last_connected_port, saved_name)) {//pripoj sa znova
+                        if (connect_to_game(client_state.connected_host, last_connected_port, last_connected_game_id, saved_name)) {//pripoj sa znova
                             // Wait for server to send first game state
                             usleep(500000);//cakaj 0.5s na prvy stav
                             continue;//pokracuj v slucke
@@ -443,6 +765,7 @@ int main(void) {//hlavna funkcia klienta
     client_state.my_player_id = -1;//ziadne ID
     client_state.death_handled = false;//smrt nebola spracovana
     pthread_mutex_init(&client_state.state_mutex, NULL);//inicializuj mutex
+    pthread_mutex_init(&client_state.send_mutex, NULL);//inicializuj mutex pre posielanie
     
     // Initialize UI
     if (!init_ui()) {//inicializuj ncurses UI
@@ -486,7 +809,7 @@ int main(void) {//hlavna funkcia klienta
                     
                     // Title
                     attron(A_REVERSE);
-                    mvprintw(start_y + 2, start_x + (box_width - 20) / 2, "  STARTING SERVER  ");
+                    mvprintw(start_y + 2, start_x + (box_width - 18) / 2, "  CREATING GAME  ");
                     attroff(A_REVERSE);
                     
                     // Server info
@@ -504,7 +827,10 @@ int main(void) {//hlavna funkcia klienta
                     attroff(A_BOLD);
                     refresh();
                     
-                    if (start_local_server(&config, &port)) {//ak sa podarilo spustit server
+                    int game_id;//ID novej hry na serveri
+                    if (!start_local_server(port)) {//server nebezi a nepodarilo sa ho spustit
+                        show_error("Failed to start server. Port may be in use.");//chyba pri spusteni servera
+                    } else if (request_new_game("127.0.0.1", port, &config, &game_id)) {//hra vytvorena
                         char name[MAX_NAME_LENGTH];//meno hraca
                         
                         clear();//vycisti obrazovku
@@ -562,13 +888,14 @@ int main(void) {//hlavna funkcia klienta
                             // Connection info
                             mvprintw(conn_start_y + 4, conn_start_x + 4, "Player:  %s", name);
                             mvprintw(conn_start_y + 5, conn_start_x + 4, "Server:  127.0.0.1:%d", port);
+                            mvprintw(conn_start_y + 6, conn_start_x + 4, "Game:    %d", game_id);
                             
                             mvprintw(conn_start_y + 7, conn_start_x + (box_width - 18) / 2, "Please wait...");
                             
                             attroff(A_BOLD);
                             refresh();
                             
-                            if (connect_to_game("127.0.0.1", port, name)) {//pripoj sa k serveru
+                            if (connect_to_game("127.0.0.1", port, game_id, name)) {//pripoj sa do novej hry
                                 game_loop();//spusti hernu slucku
                                 disconnect_from_game();//odpoj sa po skonceni
                             } else {
@@ -576,11 +903,8 @@ int main(void) {//hlavna funkcia klienta
                             }
                         }
                         
-                        // Don't stop server here - let it run according to game rules
+                        // Don't stop server here - the game runs according to game rules
                         // (10 seconds without players in Standard mode, or until time limit)
-                        // stop_local_server(); - nezastavuj server, nech bezi podla pravidiel
-                    } else {
-                        show_error("Failed to start server. Port may be in use.");//chyba pri spusteni servera
                     }
                 }
                 break;
@@ -588,9 +912,10 @@ int main(void) {//hlavna funkcia klienta
             
             case MENU_JOIN_GAME: {//pripojenie k existujucemu serveru
                 int port;//port servera
+                int game_id;//ID hry na serveri
                 char name[MAX_NAME_LENGTH];//meno hraca
                 
-                if (get_connection_info(&port, name)) {//ziskaj info od uzivatela
+                if (get_connection_info(&port, name) && browse_games("127.0.0.1", port, &game_id)) {//ziskaj info a vyber hru v lobby
                     clear();
                     int max_y, max_x;
                     getmaxyx(stdscr, max_y, max_x);
@@ -623,13 +948,14 @@ int main(void) {//hlavna funkcia klienta
                     // Connection info - always localhost
                     mvprintw(conn_start_y + 4, conn_start_x + 4, "Player:  %s", name);
                     mvprintw(conn_start_y + 5, conn_start_x + 4, "Server:  localhost:%d", port);
+                    mvprintw(conn_start_y + 6, conn_start_x + 4, "Game:    %d", game_id);
                     
                     mvprintw(conn_start_y + 7, conn_start_x + (box_width - 18) / 2, "Please wait...");
                     
                     attroff(A_BOLD);
                     refresh();
                     
-                    if (connect_to_game("127.0.0.1", port, name)) {//pripoj sa k serveru (vzdy localhost)
+                    if (connect_to_game("127.0.0.1", port, game_id, name)) {//pripoj sa k serveru (vzdy localhost)
                         game_loop();//spusti hernu slucku
                         disconnect_from_game();//odpoj sa po skonceni
                     } else {
@@ -650,9 +976,11 @@ int main(void) {//hlavna funkcia klienta
     
     cleanup_ui();//uprac ncurses UI
     pthread_mutex_destroy(&client_state.state_mutex);//znic mutex
+    pthread_mutex_destroy(&client_state.send_mutex);//znic mutex pre posielanie
+    free(client_state.obstacles);//uvolni prekazky
     
-    // Stop local server if it was created by this client
-    stop_local_server();//zastav lokalny server ak bol spusteny
+    // Local server is not stopped: other clients may play in it and it
+    // exits on its own once its last game has ended
     
     return 0;
 }
@@ -1,6 +1,7 @@
 #include "menu.h"
 #include "ui.h"
 #include "network.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <ncurses.h>
@@ -218,6 +219,8 @@ bool get_game_config(GameConfig *config, int *port) {
         player_mode = 1; // Default to Singleplayer
     }
     config->max_players = (player_mode == 1) ? 1 : MAX_PLAYERS;
+    config->tick_rate = 0; // Server default speed
+    config->seed = 0; // Server picks the seed
     start_y += 5;
     
     // Port
@@ -285,6 +288,121 @@ bool get_connection_info(int *port, char *player_name) {
     return strlen(player_name) > 0;
 }
 
+BrowserAction show_game_browser(const GameSummary *games, int count, int total, int page, int *selected) {
+    nodelay(stdscr, FALSE);
+    timeout(2000);  // Refresh list periodically
+    
+    int max_y, max_x;
+    getmaxyx(stdscr, max_y, max_x);
+    int start_x = max_x / 2 - 30;
+    
+    if (*selected >= count) *selected = count - 1;
+    if (*selected < 0) *selected = 0;
+    
+    BrowserAction action = BROWSER_REFRESH;
+    bool done = false;
+    while (!done) {
+        clear();
+        int start_y = max_y / 2 - GAME_LIST_PAGE_SIZE / 2 - 4;
+        
+        // Title
+        attron(A_BOLD | A_UNDERLINE);
+        mvprintw(start_y, start_x + 18, "=== RUNNING GAMES ===");
+        attroff(A_BOLD | A_UNDERLINE);
+        start_y += 2;
+        
+        int pages = (total + GAME_LIST_PAGE_SIZE - 1) / GAME_LIST_PAGE_SIZE;
+        mvprintw(start_y, start_x, "Games: %d   Page %d/%d", total, page + 1, pages > 0 ? pages : 1);
+        start_y += 2;
+        
+        // Table header
+        attron(A_BOLD);
+        mvprintw(start_y++, start_x, "%6s  %-8s  %-9s  %-9s  %-7s  %s", "ID", "Mode", "World", "Obstacles", "Players", "Time");
+        attroff(A_BOLD);
+        
+        if (count == 0) {
+            mvprintw(start_y + 1, start_x, "No games are running. Create one with New Game.");
+        }
+        
+        // Games
+        for (int i = 0; i < count; i++) {
+            const GameSummary *game = &games[i];
+            char world[32];
+            char players[32];
+            char time_str[32];
+            snprintf(world, sizeof(world), "%dx%d", game->width, game->height);
+            snprintf(players, sizeof(players), "%d/%d", game->player_count, game->max_players);
+            if (game->mode == MODE_TIMED) {
+                int left = game->time_limit - game->elapsed_time;
+                if (left < 0) left = 0;
+                snprintf(time_str, sizeof(time_str), "%d:%02d left", left / 60, left % 60);
+            } else {
+                snprintf(time_str, sizeof(time_str), "%d:%02d", game->elapsed_time / 60, game->elapsed_time % 60);
+            }
+            
+            if (i == *selected) {
+                attron(A_REVERSE);
+            }
+            mvprintw(start_y + i, start_x, "%6d  %-8s  %-9s  %-9s  %-7s  %s", game->game_id,
+                     game->mode == MODE_TIMED ? "Timed" : "Standard", world,
+                     game->obstacles ? "Yes" : "No", players, time_str);
+            if (i == *selected) {
+                attroff(A_REVERSE);
+            }
+        }
+        
+        // Controls
+        mvprintw(max_y / 2 + GAME_LIST_PAGE_SIZE / 2 + 2, start_x,
+                 "Arrows = select, ENTER = join, N/P = next/prev page, R = refresh, Q = back");
+        refresh();
+        
+        int key = getch();
+        switch (key) {
+            case KEY_UP:
+                if (*selected > 0) (*selected)--;
+                break;
+            case KEY_DOWN:
+                if (*selected < count - 1) (*selected)++;
+                break;
+            case '\n':
+            case '\r':
+            case KEY_ENTER:
+                if (count > 0) {
+                    action = BROWSER_JOIN;
+                    done = true;
+                }
+                break;
+            case 'n':
+            case 'N':
+            case KEY_NPAGE:
+                action = BROWSER_NEXT_PAGE;
+                done = true;
+                break;
+            case 'p':
+            case 'P':
+            case KEY_PPAGE:
+                action = BROWSER_PREV_PAGE;
+                done = true;
+                break;
+            case 'q':
+            case 'Q':
+            case 27:  // Escape
+                action = BROWSER_CANCEL;
+                done = true;
+                break;
+            default:  // 'r', timeout
+                if (key == ERR || key == 'r' || key == 'R') {
+                    action = BROWSER_REFRESH;
+                    done = true;
+                }
+                break;
+        }
+    }
+    
+    nodelay(stdscr, TRUE);
+    return action;
+}
+
 void show_error(const char *message) {
     clear();
     nodelay(stdscr, FALSE);
@@ -23,6 +23,17 @@ typedef enum {
     MENU_CANCEL         /**< Cancel current action */
 } MenuChoice;
 
+/**
+ * @brief Game browser actions
+ */
+typedef enum {
+    BROWSER_JOIN,       /**< Join selected game */
+    BROWSER_NEXT_PAGE,  /**< Show next page */
+    BROWSER_PREV_PAGE,  /**< Show previous page */
+    BROWSER_REFRESH,    /**< Reload current page */
+    BROWSER_CANCEL      /**< Back to main menu */
+} BrowserAction;
+
 /**
  * @brief Show main menu
  * @param can_resume Enable "Resume Game" option
@@ -44,7 +55,7 @@ MenuChoice show_main_menu(bool can_resume);
  * - World dimensions (20-200 × 10-100)
  * - Game mode (standard/timed)
  * - Player mode (single/multiplayer)
- * - Server port
+ * - Server port (local server is started if none is running)
  */
 bool get_game_config(GameConfig *config, int *port);
 
@@ -58,6 +69,21 @@ bool get_game_config(GameConfig *config, int *port);
  */
 bool get_connection_info(int *port, char *player_name);
 
+/**
+ * @brief Show one page of running games
+ * @param games Games in page
+ * @param count Number of games in page
+ * @param total Number of running games on server
+ * @param page Page number (0 = first)
+ * @param selected In/out index of selected game in page
+ * @return Action chosen by user
+ * 
+ * Arrows move selection, Enter joins, N/P switch pages, R refreshes,
+ * Q goes back. Returns BROWSER_REFRESH after 2 seconds without input,
+ * so player counts and times stay current.
+ */
+BrowserAction show_game_browser(const GameSummary *games, int count, int total, int page, int *selected);
+
 /**
  * @brief Show error message dialog
  * @param message Error message text
@@ -96,14 +96,14 @@ void render_game_state(const GameState *state, int my_player_id, const char *hos
                     attr |= A_REVERSE;
                 }
                 attron(attr);
-                mvaddch(start_y + state->snakes[i].positions[0].y, 
-                       start_x + state->snakes[i].positions[0].x, 'O');
+                Position head = snake_segment(&state->snakes[i], 0);
+                mvaddch(start_y + head.y, start_x + head.x, 'O');
                 attroff(attr);
                 
                 // Draw body
                 for (int j = 1; j < state->snakes[i].length; j++) {
-                    mvaddch(start_y + state->snakes[i].positions[j].y, 
-                           start_x + state->snakes[i].positions[j].x, 'o');
+                    Position segment = snake_segment(&state->snakes[i], j);
+                    mvaddch(start_y + segment.y, start_x + segment.x, 'o');
                 }
             }
             
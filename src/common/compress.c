@@ -0,0 +1,160 @@
+#include "compress.h"
+#include "protocol.h"
+#include <string.h>
+
+#define HASH_BITS 12                // velkost tabulky 4-bajtovych sekvencii (4096 pozicii)
+
+typedef struct {//zapis do obmedzeneho buffera
+    uint8_t *data;
+    size_t capacity;
+    size_t offset;
+    bool failed;                    // vystup sa nezmestil
+} Writer;
+
+typedef struct {//citanie s kontrolou hranic
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+    bool error;
+} Reader;
+
+static void put_bytes(Writer *w, const uint8_t *data, size_t size) {//prida bajty (pri nedostatku miesta nastavi failed)
+    if (w->failed || size > w->capacity - w->offset) {
+        w->failed = true;
+        return;
+    }
+    memcpy(w->data + w->offset, data, size);
+    w->offset += size;
+}
+
+static void put_varint(Writer *w, size_t value) {//LEB128
+    uint8_t bytes[10];
+    int count = 0;
+    do {
+        bytes[count] = (uint8_t)(value & 0x7F);
+        value >>= 7;
+        if (value) {
+            bytes[count] |= 0x80;
+        }
+        count++;
+    } while (value);
+    put_bytes(w, bytes, count);
+}
+
+static size_t get_varint(Reader *r) {//LEB128, najviac 5 bajtov
+    size_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (r->offset >= r->size) {
+            break;
+        }
+        uint8_t byte = r->data[r->offset++];
+        value |= (size_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    r->error = true;
+    return 0;
+}
+
+static uint32_t hash_sequence(const uint8_t *data) {//hash 4 bajtov (Knuth)
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+Codec choose_codec(uint32_t offered) {//najlepsi spolocny kodek
+    return (offered & SUPPORTED_CODECS & CODEC_MASK(CODEC_LZ)) ? CODEC_LZ : CODEC_NONE;
+}
+
+static void put_sequence(Writer *w, const uint8_t *literals, size_t count) {//literaly pred dalsou zhodou (alebo na konci)
+    put_varint(w, count);
+    put_bytes(w, literals, count);
+}
+
+size_t compress_message(Codec codec, const uint8_t *message, size_t size, uint8_t *out, size_t capacity) {//zabali spravu do MSG_COMPRESSED
+    if (codec != CODEC_LZ || size < COMPRESS_MIN_SIZE) {
+        return 0;
+    }
+
+    if (capacity < MESSAGE_HEADER_SIZE) {
+        return 0;
+    }
+    Writer w = { out, capacity, write_message_header(out, MSG_COMPRESSED, -1), false };//hlavicka ako pri kazdej sprave
+    uint8_t codec_id = (uint8_t)codec;
+    put_bytes(&w, &codec_id, 1);
+    put_varint(&w, size);
+
+    int32_t table[1 << HASH_BITS];//posledna pozicia kazdeho hashu (-1 = ziadna)
+    memset(table, 0xFF, sizeof(table));
+    size_t anchor = 0;//zaciatok literalov, ktore este nie su zapisane
+    size_t pos = 0;
+    while (pos + COMPRESS_MIN_MATCH <= size && !w.failed) {
+        uint32_t hash = hash_sequence(message + pos);
+        int32_t candidate = table[hash];
+        table[hash] = (int32_t)pos;
+        if (candidate < 0 || memcmp(message + candidate, message + pos, COMPRESS_MIN_MATCH) != 0) {//ziadna zhoda
+            pos++;
+            continue;
+        }
+
+        size_t length = COMPRESS_MIN_MATCH;
+        while (pos + length < size && message[candidate + length] == message[pos + length]) {//prekryv je dovoleny
+            length++;
+        }
+        put_sequence(&w, message + anchor, pos - anchor);
+        put_varint(&w, length - COMPRESS_MIN_MATCH);
+        put_varint(&w, pos - (size_t)candidate);
+        pos += length;
+        anchor = pos;
+    }
+    put_sequence(&w, message + anchor, size - anchor);//zvysok ako literaly
+
+    return w.failed ? 0 : w.offset;
+}
+
+bool is_compressed_message(const uint8_t *message, size_t size) {//je sprava MSG_COMPRESSED?
+    MessageType type;
+    int player_id;
+    return read_message_header(message, size, &type, &player_id) && type == MSG_COMPRESSED;
+}
+
+ssize_t decompress_message(const uint8_t *message, size_t size, MessageBuffer *out) {//rozbali MSG_COMPRESSED
+    if (!is_compressed_message(message, size) || size < MESSAGE_HEADER_SIZE + 1) {
+        return -1;
+    }
+    Reader r = { message, size, MESSAGE_HEADER_SIZE, false };
+    if (r.data[r.offset++] != CODEC_LZ) {//neznamy kodek
+        return -1;
+    }
+    size_t original = get_varint(&r);
+    if (r.error || original > MAX_MESSAGE_SIZE || !reserve_message_buffer(out, original ? original : 1)) {
+        return -1;
+    }
+
+    uint8_t *data = out->data;
+    size_t produced = 0;
+    while (true) {
+        size_t literals = get_varint(&r);
+        if (r.error || literals > r.size - r.offset || literals > original - produced) {
+            return -1;
+        }
+        memcpy(data + produced, r.data + r.offset, literals);
+        r.offset += literals;
+        produced += literals;
+        if (r.offset == r.size) {//posledna sekvencia
+            break;
+        }
+
+        size_t length = get_varint(&r) + COMPRESS_MIN_MATCH;
+        size_t distance = get_varint(&r);
+        if (r.error || distance == 0 || distance > produced || length > original - produced) {
+            return -1;
+        }
+        for (size_t i = 0; i < length; i++) {//po bajtoch - zdroj sa moze prekryvat s cielom
+            data[produced + i] = data[produced - distance + i];
+        }
+        produced += length;
+    }
+    return produced == original ? (ssize_t)original : -1;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file compress.h
+ * @brief Snapshot compression negotiated at join
+ *
+ * The client lists the codecs it decodes in MSG_JOIN_GAME; the server
+ * picks one per player and compresses every snapshot once per codec. A
+ * compressed message is a MSG_COMPRESSED wrapper around the original
+ * message and travels like any other message (TCP frame or datagram).
+ *
+ * Wrapper layout: message type and player ID as in every message, u8
+ * codec, varint size of the original message, codec data.
+ *
+ * CODEC_LZ data is a sequence of varint literal count, literal bytes,
+ * varint match length - COMPRESS_MIN_MATCH and varint match distance;
+ * the last sequence ends after its literals. Runs of zeros and repeated
+ * coordinates become short back references (distance 1 repeats a byte).
+ */
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include "network.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Messages smaller than this are not worth compressing */
+#define COMPRESS_MIN_SIZE 64
+
+/** Shortest back reference of CODEC_LZ */
+#define COMPRESS_MIN_MATCH 4
+
+/**
+ * @brief Compression codecs
+ */
+typedef enum {
+    CODEC_NONE,     /**< Messages are sent as is */
+    CODEC_LZ        /**< In-tree LZ77 with varint lengths */
+} Codec;
+
+/** Bit of codec in codec mask (MSG_JOIN_GAME) */
+#define CODEC_MASK(codec) (1u << (codec))
+
+/** Codecs this build decodes */
+#define SUPPORTED_CODECS CODEC_MASK(CODEC_LZ)
+
+/**
+ * @brief Pick codec for player
+ * @param offered Codec mask from MSG_JOIN_GAME
+ * @return Best codec supported by both sides (CODEC_NONE if none)
+ */
+Codec choose_codec(uint32_t offered);
+
+/**
+ * @brief Compress serialized message into MSG_COMPRESSED wrapper
+ * @param codec Codec
+ * @param message Serialized message
+ * @param size Size of message
+ * @param out Output buffer
+ * @param capacity Size of output buffer
+ * @return Size of wrapper, 0 if codec is CODEC_NONE, message is smaller
+ *         than COMPRESS_MIN_SIZE or wrapper does not fit into capacity
+ *
+ * Pass capacity smaller than size to keep only wrappers that save bytes.
+ */
+size_t compress_message(Codec codec, const uint8_t *message, size_t size, uint8_t *out, size_t capacity);
+
+/**
+ * @brief Check whether message is MSG_COMPRESSED wrapper
+ * @param message Received message
+ * @param size Size of message
+ * @return true if message must be decompressed first
+ */
+bool is_compressed_message(const uint8_t *message, size_t size);
+
+/**
+ * @brief Restore original message from MSG_COMPRESSED wrapper
+ * @param message Wrapper
+ * @param size Size of wrapper
+ * @param out Buffer for original message (grown as needed)
+ * @return Size of original message, -1 if wrapper is corrupt or exceeds
+ *         MAX_MESSAGE_SIZE
+ */
+ssize_t decompress_message(const uint8_t *message, size_t size, MessageBuffer *out);
+
+#endif // COMPRESS_H
@@ -4,9 +4,98 @@
 #include <string.h>
 #include <unistd.h> //kniznice pre pracu so socketmi, sietovymi adresami a chybami.
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+
+static bool send_vector(int socket, struct iovec *iov, int count) {//posle vsetky casti jednym sendmsg (pri ciastocnom odoslani pokracuje)
+    while (count > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t n = sendmsg(socket, &msg, MSG_NOSIGNAL);//hlavicka aj data v jednom volani (bez SIGPIPE)
+        if (n < 0 && errno == EINTR) {//prerusene signalom
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {//neblokujuci socket je plny
+            struct pollfd pfd = { .fd = socket, .events = POLLOUT };
+            int ready = poll(&pfd, 1, SEND_TIMEOUT_MS);//cakaj kym sa uvolni miesto (najviac SEND_TIMEOUT_MS)
+            if (ready == 0 || (ready < 0 && errno != EINTR)) {//protistrana nic neprebera alebo chyba
+                return false;
+            }
+            continue;
+        }
+        if (n <= 0) {//chyba alebo socket zatvoreny
+            return false;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {//preskoc odoslane casti
+            n -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {//cast odoslana len ciastocne
+            iov->iov_base = (uint8_t *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return true;
+}
+
+static void set_nodelay(int socket) {//vypne Nagle - male spravy (vstupy, potvrdenia) idu hned
+    int opt = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+}
+
+static bool recv_all(int socket, uint8_t *data, size_t size) {//prijme presne size bajtov
+    size_t received = 0;//pocet uz prijatych bajtov
+    while (received < size) {//prijimaj, kym neprijdu vsetky data
+        ssize_t n = recv(socket, data + received, size - received, 0);//prijmi zvysok dat
+        if (n < 0 && errno == EINTR) {//prerusene signalom
+            continue;
+        }
+        if (n <= 0) {//chyba alebo socket zatvoreny
+            return false;
+        }
+        received += n;//pripocitaj pocet prijatych bajtov
+    }
+    return true;
+}
+
+bool reserve_message_buffer(MessageBuffer *buffer, size_t size) {//zvacsi buffer aspon na size bajtov
+    if (size <= buffer->capacity) {//uz je dost velky
+        return true;
+    }
+    if (size > MAX_MESSAGE_SIZE) {//sprava presahuje tvrdy limit
+        return false;
+    }
+    
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < size) {//rast geometricky (menej realokacii)
+        capacity *= 2;
+    }
+    if (capacity > MAX_MESSAGE_SIZE) {
+        capacity = MAX_MESSAGE_SIZE;
+    }
+    
+    uint8_t *data = realloc(buffer->data, capacity);
+    if (!data) {
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+void free_message_buffer(MessageBuffer *buffer) {//uvolni pamat bufferu
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->capacity = 0;
+}
 
 int create_server_socket(int port) {//vytvori serverovy socket na danom porte.
     int server_fd;//file descriptor socketu, adresova struktura a volba pre socket
@@ -52,7 +141,7 @@ int accept_client(int server_socket) {//prijme nove klientske pripojenie na serv
     int addrlen = sizeof(address);
     int client_socket;
     
-    client_socket = accept(server_socket, (struct sockaddr *)&address, (socklen_t*)&addrlen);//blokuje, kym sa nepripoji klient
+    client_socket = accept(server_socket, (struct sockaddr *)&address, (socklen_t*)&addrlen);//na blokujucom sockete caka na klienta, na neblokujucom vrati EAGAIN
     if (client_socket < 0) {
         if (errno != EAGAIN && errno != EWOULDBLOCK) {//ak chyba nie je "by zablokoval", vypis chybu
             perror("accept");
@@ -60,6 +149,7 @@ int accept_client(int server_socket) {//prijme nove klientske pripojenie na serv
         return -1;
     }
     
+    set_nodelay(client_socket);//snapshoty a odpovede bez cakania na ACK
     return client_socket;//vrati file descriptor klientskeho socketu.
 }
 
@@ -88,53 +178,214 @@ int connect_to_server(const char *host, int port) {//klientska funkcia pre pripo
         return -1;
     }
     
+    set_nodelay(sock);//vstupy hraca bez oneskorenia
     return sock;//vrati socket pripojeny k serveru
 }
 
+int create_datagram_socket(int port) {//UDP socket servera pre snapshoty (rovnake cislo portu ako TCP)
+    int sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        perror("socket failed");
+        return -1;
+    }
+    
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;//vsetky rozhrania ako TCP socket
+    address.sin_port = htons(port);
+    if (bind(sock, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        perror("bind failed");
+        close(sock);
+        return -1;
+    }
+    
+    if (!set_nonblocking(sock)) {//plny socket snapshot zahodi, neblokuje tick
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+int connect_datagram_socket(const char *host, int port) {//UDP socket klienta spojeny so serverom
+    int sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        return -1;
+    }
+    
+    struct sockaddr_in serv_addr;
+    memset(&serv_addr, 0, sizeof(serv_addr));
+    serv_addr.sin_family = AF_INET;
+    serv_addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &serv_addr.sin_addr) <= 0 ||
+        connect(sock, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {//prijima len od servera
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
 bool send_data(int socket, const uint8_t *data, size_t size) {//posle data cez socket (najprv velkost, potom data)
-    // First send the size
-    uint32_t net_size = htonl((uint32_t)size);//velkost dat v sietovom byte order
-    if (send(socket, &net_size, sizeof(net_size), 0) != sizeof(net_size)) {//posli velkost
+    if (size > MAX_MESSAGE_SIZE) {//prijemca by taky ramec odmietol
         return false;
     }
     
-    // Then send the data
+    // Size and data in one call (no small segment waiting for an ACK)
+    uint8_t header[FRAME_HEADER_SIZE];
+    write_frame_header(header, size);//velkost dat v sietovom byte order
+    struct iovec iov[2] = {
+        { .iov_base = header, .iov_len = sizeof(header) },
+        { .iov_base = (void *)data, .iov_len = size },
+    };
+    return send_vector(socket, iov, size > 0 ? 2 : 1);
+}
+
+ssize_t send_available(int socket, const uint8_t *data, size_t size) {//posle co sa zmesti do socketu bez blokovania
     size_t sent = 0;//pocet uz poslanych bajtov
-    while (sent < size) {//posielaj, kym nepojdu vsetky data
-        ssize_t n = send(socket, data + sent, size - sent, 0);//posli zvysok dat
+    while (sent < size) {
+        ssize_t n = send(socket, data + sent, size - sent, MSG_NOSIGNAL | MSG_DONTWAIT);//neblokujuci send
+        if (n < 0 && errno == EINTR) {//prerusene signalom
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {//socket je plny
+            break;
+        }
         if (n <= 0) {//chyba alebo socket zatvoreny
-            return false;
+            return -1;
         }
-        sent += n;//pripocitaj pocet poslanych bajtov
+        sent += n;
     }
-    
-    return true;//vsetko uspesne odoslane
+    return (ssize_t)sent;//pocet poslanych bajtov
+}
+
+void write_frame_header(uint8_t *header, size_t size) {//zapise velkost ramca v sietovom byte order
+    uint32_t net_size = htonl((uint32_t)size);
+    memcpy(header, &net_size, sizeof(net_size));
+}
+
+size_t read_frame_header(const uint8_t *header) {//precita velkost ramca zo sietoveho byte order
+    uint32_t net_size;
+    memcpy(&net_size, header, sizeof(net_size));
+    return ntohl(net_size);
 }
 
 ssize_t receive_data(int socket, uint8_t *buffer, size_t buffer_size) {//prijme data zo socketu (najprv velkost, potom data)
     // First receive the size
-    uint32_t net_size;
-    ssize_t n = recv(socket, &net_size, sizeof(net_size), 0);//prijmi velkost dat
-    if (n != sizeof(net_size)) {//chyba pri prijimani velkosti
+    uint8_t header[FRAME_HEADER_SIZE];
+    if (!recv_all(socket, header, sizeof(header))) {//prijmi velkost dat
         return -1;
     }
     
-    size_t size = ntohl(net_size);//konvertuj velkost z network byte order
+    size_t size = read_frame_header(header);//konvertuj velkost z network byte order
     if (size > buffer_size) {//data su vacsie ako buffer
         return -1;
     }
     
     // Then receive the data
-    size_t received = 0;//pocet uz prijatych bajtov
-    while (received < size) {//prijimaj, kym neprijdes vsetky data
-        n = recv(socket, buffer + received, size - received, 0);//prijmi zvysok dat
-        if (n <= 0) {//chyba alebo socket zatvoreny
+    if (!recv_all(socket, buffer, size)) {//prijmi data
+        return -1;
+    }
+    
+    return (ssize_t)size;//vrat celkovy pocet prijatych bajtov
+}
+
+ssize_t receive_message(int socket, MessageBuffer *buffer) {//prijme spravu lubovolnej velkosti (do MAX_MESSAGE_SIZE)
+    uint8_t header[FRAME_HEADER_SIZE];
+    if (!recv_all(socket, header, sizeof(header))) {//prijmi velkost dat
+        return -1;
+    }
+    
+    size_t size = read_frame_header(header);
+    if (size > MAX_MESSAGE_SIZE) {//tvrdy limit velkosti spravy
+        return -1;
+    }
+    
+    // Grow buffer only as data actually arrives
+    size_t received = 0;
+    while (received < size) {
+        size_t chunk = size - received;
+        if (chunk > RECEIVE_CHUNK_SIZE) {
+            chunk = RECEIVE_CHUNK_SIZE;
+        }
+        if (!reserve_message_buffer(buffer, received + chunk) ||
+            !recv_all(socket, buffer->data + received, chunk)) {
             return -1;
         }
-        received += n;//pripocitaj pocet prijatych bajtov
+        received += chunk;
     }
     
-    return (ssize_t)size;//vrat celkovy pocet prijatych bajtov
+    return (ssize_t)size;
+}
+
+ssize_t read_frame(FrameReader *reader, int socket, const uint8_t **payload) {//dalsi uplny ramec, zo socketu cita len ked ziadny nema
+    while (true) {
+        size_t available = reader->end - reader->start;
+        size_t needed = FRAME_HEADER_SIZE;//bajty potrebne na dalsi ramec
+        if (available >= FRAME_HEADER_SIZE) {
+            size_t size = read_frame_header(reader->data + reader->start);
+            if (size > MAX_MESSAGE_SIZE) {//tvrdy limit velkosti spravy
+                return -1;
+            }
+            needed += size;
+            if (available >= needed) {//ramec je cely v bufferi
+                *payload = reader->data + reader->start + FRAME_HEADER_SIZE;
+                reader->start += needed;
+                return (ssize_t)size;
+            }
+        }
+        
+        // Move unfinished frame to the front
+        if (reader->start > 0) {
+            memmove(reader->data, reader->data + reader->start, available);
+            reader->start = 0;
+            reader->end = available;
+        }
+        
+        // Grow by at most RECEIVE_CHUNK_SIZE beyond received data (bogus prefix cannot allocate much)
+        size_t target = needed < available + RECEIVE_CHUNK_SIZE ? needed : available + RECEIVE_CHUNK_SIZE;
+        if (target < RECEIVE_CHUNK_SIZE) {//male ramce sa citaju po viacerych naraz
+            target = RECEIVE_CHUNK_SIZE;
+        }
+        if (reader->capacity < target) {
+            size_t capacity = reader->capacity * 2 > target ? reader->capacity * 2 : target;
+            uint8_t *data = realloc(reader->data, capacity);
+            if (!data) {
+                return -1;
+            }
+            reader->data = data;
+            reader->capacity = capacity;
+        }
+        
+        ssize_t n = recv(socket, reader->data + reader->end, reader->capacity - reader->end, 0);//vsetko, co je dostupne
+        if (n < 0 && errno == EINTR) {//prerusene signalom
+            continue;
+        }
+        if (n <= 0) {//chyba alebo socket zatvoreny
+            return -1;
+        }
+        reader->end += n;
+    }
+}
+
+void free_frame_reader(FrameReader *reader) {//uvolni buffer citaca
+    free(reader->data);
+    reader->data = NULL;
+    reader->capacity = 0;
+    reader->start = 0;
+    reader->end = 0;
+}
+
+bool set_nonblocking(int socket) {//prepne socket do neblokujuceho rezimu
+    int flags = fcntl(socket, F_GETFL, 0);//aktualne priznaky socketu
+    if (flags < 0) {
+        perror("fcntl");
+        return false;
+    }
+    if (fcntl(socket, F_SETFL, flags | O_NONBLOCK) < 0) {//pridaj O_NONBLOCK
+        perror("fcntl");
+        return false;
+    }
+    return true;
 }
 
 void close_socket(int socket) {//bezpecne zatvori socket
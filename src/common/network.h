@@ -1,10 +1,11 @@
 /**
  * @file network.h
- * @brief TCP socket networking functions
+ * @brief TCP and UDP socket networking functions
  * 
  * Provides abstraction layer for TCP socket operations used in client-server
  * communication. Handles server socket creation, client connections,
- * data transmission, and socket cleanup.
+ * data transmission, and socket cleanup. Optional UDP sockets carry
+ * snapshots that may be lost.
  */
 
 #ifndef NETWORK_H
@@ -22,9 +23,65 @@
 /** Default server port */
 #define DEFAULT_PORT 8888
 
-/** Maximum buffer size for network operations */
+/** Fixed receive buffer size; also the largest message a client may send to the server */
 #define BUFFER_SIZE 65536
 
+/** Hard upper bound of one framed message (larger frames are rejected) */
+#define MAX_MESSAGE_SIZE (16 * 1024 * 1024)
+
+/** Receive buffers grow by at most this many bytes per read (bounds memory per peer) */
+#define RECEIVE_CHUNK_SIZE 65536
+
+/** Size of frame length prefix (network byte order) */
+#define FRAME_HEADER_SIZE sizeof(uint32_t)
+
+/** Longest wait of send_data for a full non-blocking socket to drain */
+#define SEND_TIMEOUT_MS 5000
+
+/** Largest message sent as one datagram (fits common MTU without fragmentation) */
+#define DATAGRAM_MAX_PAYLOAD 1200
+
+/**
+ * @brief Growable message buffer reused across messages
+ * 
+ * Owned by one reader or writer (receive thread, tick thread) so that
+ * large messages do not allocate per frame. Capacity never exceeds
+ * MAX_MESSAGE_SIZE.
+ */
+typedef struct {
+    uint8_t *data;      /**< Buffer (NULL until first use) */
+    size_t capacity;    /**< Allocated size in bytes */
+} MessageBuffer;
+
+/**
+ * @brief Buffered reader of length-prefixed frames from one socket
+ *
+ * Each read pulls everything the socket has available, so a burst of
+ * small frames costs one recv. Zero-initialize before first use.
+ */
+typedef struct {
+    uint8_t *data;      /**< Received bytes (NULL until first use) */
+    size_t capacity;    /**< Allocated size in bytes */
+    size_t start;       /**< Offset of first unconsumed byte */
+    size_t end;         /**< End of received bytes */
+} FrameReader;
+
+/**
+ * @brief Ensure buffer can hold given number of bytes
+ * @param buffer Message buffer
+ * @param size Required size in bytes
+ * @return true on success, false if size exceeds MAX_MESSAGE_SIZE or allocation fails
+ * 
+ * Grows geometrically and keeps existing contents.
+ */
+bool reserve_message_buffer(MessageBuffer *buffer, size_t size);
+
+/**
+ * @brief Free message buffer memory
+ * @param buffer Message buffer (left empty and reusable)
+ */
+void free_message_buffer(MessageBuffer *buffer);
+
 /**
  * @brief Create and bind server socket
  * @param port Port number to bind to (1024-65535 recommended)
@@ -38,9 +95,13 @@ int create_server_socket(int port);
 /**
  * @brief Accept incoming client connection
  * @param server_socket Server socket file descriptor
- * @return Client socket file descriptor on success, -1 on failure
+ * @return Client socket file descriptor on success, -1 on failure or when
+ *         no connection is pending on a non-blocking socket
  * 
- * Blocks until client connects. Returns new socket for client communication.
+ * Blocks until a client connects only if server_socket is blocking; the
+ * event loop's non-blocking socket is polled until -1 with errno EAGAIN
+ * (not reported as an error). Returns new socket for client communication
+ * with TCP_NODELAY set.
  */
 int accept_client(int server_socket);
 
@@ -50,10 +111,31 @@ int accept_client(int server_socket);
  * @param port Server port number
  * @return Socket file descriptor on success, -1 on failure
  * 
- * Creates TCP socket and connects to specified server.
+ * Creates TCP socket, connects to specified server and disables Nagle's
+ * algorithm (TCP_NODELAY), so small input messages are sent at once.
  */
 int connect_to_server(const char *host, int port);
 
+/**
+ * @brief Create UDP socket of server
+ * @param port Port number to bind to (same number as the TCP port)
+ * @return Non-blocking socket file descriptor on success, -1 on failure
+ *
+ * Datagrams carry one message each, without a length prefix.
+ */
+int create_datagram_socket(int port);
+
+/**
+ * @brief Create UDP socket connected to server
+ * @param host Server IP address
+ * @param port Server port number
+ * @return Blocking socket file descriptor on success, -1 on failure
+ *
+ * The connected socket only receives datagrams from the server; send and
+ * recv exchange whole messages.
+ */
+int connect_datagram_socket(const char *host, int port);
+
 /**
  * @brief Send data over socket
  * @param socket Socket file descriptor
@@ -61,10 +143,37 @@ int connect_to_server(const char *host, int port);
  * @param size Size of data in bytes
  * @return true if all data sent successfully, false on error
  * 
- * Ensures all data is sent (handles partial sends).
+ * Length prefix and data go out in one sendmsg call; partial sends are
+ * continued. On non-blocking sockets waits for writability instead of
+ * failing with EAGAIN, but gives up (returns false) when the peer accepts
+ * nothing for SEND_TIMEOUT_MS. Messages larger than MAX_MESSAGE_SIZE are
+ * rejected. Not for event loop threads; those queue frames instead.
  */
 bool send_data(int socket, const uint8_t *data, size_t size);
 
+/**
+ * @brief Send as much data as socket accepts without blocking
+ * @param socket Non-blocking socket file descriptor
+ * @param data Data buffer to send (already framed)
+ * @param size Size of data in bytes
+ * @return Number of bytes sent (0 if socket is full), -1 on error
+ */
+ssize_t send_available(int socket, const uint8_t *data, size_t size);
+
+/**
+ * @brief Write frame length prefix
+ * @param header Output buffer (FRAME_HEADER_SIZE bytes)
+ * @param size Size of frame payload in bytes
+ */
+void write_frame_header(uint8_t *header, size_t size);
+
+/**
+ * @brief Read frame length prefix
+ * @param header Input buffer (FRAME_HEADER_SIZE bytes)
+ * @return Size of frame payload in bytes
+ */
+size_t read_frame_header(const uint8_t *header);
+
 /**
  * @brief Receive data from socket
  * @param socket Socket file descriptor
@@ -76,6 +185,46 @@ bool send_data(int socket, const uint8_t *data, size_t size);
  */
 ssize_t receive_data(int socket, uint8_t *buffer, size_t buffer_size);
 
+/**
+ * @brief Receive one message of any size up to MAX_MESSAGE_SIZE
+ * @param socket Socket file descriptor
+ * @param buffer Reusable buffer, grown as the payload arrives
+ * @return Message size in bytes, -1 on error, oversized frame or connection close
+ * 
+ * Blocking receive operation. The payload is read in chunks of at most
+ * RECEIVE_CHUNK_SIZE bytes, so a bogus length prefix cannot make the
+ * receiver allocate memory the peer never sends.
+ */
+ssize_t receive_message(int socket, MessageBuffer *buffer);
+
+/**
+ * @brief Receive next frame through buffered reader
+ * @param reader Reader of this socket
+ * @param socket Blocking socket file descriptor
+ * @param payload Output pointer to message (valid until next call)
+ * @return Message size in bytes, -1 on error, oversized frame or connection close
+ *
+ * Returns frames already buffered without a system call; otherwise reads
+ * as many bytes as are available. The buffer grows by at most
+ * RECEIVE_CHUNK_SIZE beyond the received bytes, like receive_message.
+ */
+ssize_t read_frame(FrameReader *reader, int socket, const uint8_t **payload);
+
+/**
+ * @brief Free frame reader memory
+ * @param reader Reader (left empty and reusable)
+ */
+void free_frame_reader(FrameReader *reader);
+
+/**
+ * @brief Switch socket to non-blocking mode
+ * @param socket Socket file descriptor
+ * @return true on success, false on failure
+ * 
+ * Required for sockets driven by the edge-triggered epoll event loop.
+ */
+bool set_nonblocking(int socket);
+
 /**
  * @brief Close socket connection
  * @param socket Socket file descriptor to close
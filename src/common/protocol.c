@@ -1,210 +1,1032 @@
 #include "protocol.h"
+#include <stddef.h>
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-void serialize_message(const Message *msg, uint8_t *buffer, size_t *size) {//serializuje Message do binarneho buffera
-    size_t offset = 0;//aktualny posun v bufferi
+/** Snake delta flags (MSG_STATE_DELTA) */
+#define SNAKE_DELTA_FULL      0x01  /**< Whole snake follows (new spawn or unknown baseline) */
+#define SNAKE_DELTA_BODY      0x02  /**< New heads, kept baseline prefix and length */
+#define SNAKE_DELTA_SCORE     0x04  /**< Score changed */
+#define SNAKE_DELTA_ALIVE     0x08  /**< Alive flag changed */
+#define SNAKE_DELTA_PAUSED    0x10  /**< Paused flag changed */
+#define SNAKE_DELTA_DIRECTION 0x20  /**< Direction changed */
+
+/** Snake body encodings */
+#define SNAKE_BODY_CHAIN      0     /**< Head, tail duplicate count, 2-bit step per segment */
+#define SNAKE_BODY_RAW        1     /**< Coordinates of every segment (fallback) */
+
+/** Upper bound of encoded snake without body (varints, flags, chain header) */
+#define SNAKE_HEADER_MAX_SIZE 48
+
+/** Upper bound of one encoded position (two zigzag varints) */
+#define POSITION_MAX_SIZE     10
+
+/** State delta flags (MSG_STATE_DELTA) */
+#define STATE_DELTA_GAME_OVER 0x01  /**< Game is over */
+#define STATE_DELTA_FOOD      0x02  /**< Food list follows */
+
+typedef struct {//zapisovac bajtov s kontrolou kapacity
+    uint8_t *data;//vystupny buffer
+    size_t capacity;//kapacita bufferu
+    size_t offset;//aktualny posun
+    bool overflow;//zapis presiahol kapacitu
+} ByteWriter;
+
+typedef struct {//citac bajtov s kontrolou velkosti
+    const uint8_t *data;//vstupny buffer
+    size_t size;//velkost bufferu
+    size_t offset;//aktualny posun
+    bool error;//citanie za koncom bufferu alebo neplatne data
+} ByteReader;
+
+static void put_u8(ByteWriter *w, uint8_t value) {//zapise jeden bajt
+    if (w->offset >= w->capacity) {
+        w->overflow = true;
+        return;
+    }
+    w->data[w->offset++] = value;
+}
+
+static void put_u32(ByteWriter *w, uint32_t value) {//zapise 4 bajty (little-endian)
+    for (int i = 0; i < 4; i++) {
+        put_u8(w, (uint8_t)(value >> (8 * i)));
+    }
+}
+
+static void put_u64(ByteWriter *w, uint64_t value) {//zapise 8 bajtov (little-endian)
+    for (int i = 0; i < 8; i++) {
+        put_u8(w, (uint8_t)(value >> (8 * i)));
+    }
+}
+
+static void put_varint(ByteWriter *w, uint32_t value) {//zapise cislo ako varint (7 bitov na bajt)
+    while (value >= 0x80) {
+        put_u8(w, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    put_u8(w, (uint8_t)value);
+}
+
+static void put_svarint(ByteWriter *w, int32_t value) {//zapise znamienkove cislo (zigzag varint)
+    put_varint(w, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+static void put_position(ByteWriter *w, Position pos) {//zapise poziciu (suradnice mozu byt mimo mapy)
+    put_svarint(w, pos.x);
+    put_svarint(w, pos.y);
+}
+
+static uint8_t get_u8(ByteReader *r) {//precita jeden bajt
+    if (r->offset >= r->size) {
+        r->error = true;
+        return 0;
+    }
+    return r->data[r->offset++];
+}
+
+static uint32_t get_u32(ByteReader *r) {//precita 4 bajty (little-endian)
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)get_u8(r) << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t get_u64(ByteReader *r) {//precita 8 bajtov (little-endian)
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)get_u8(r) << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t get_varint(ByteReader *r) {//precita varint
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte = get_u8(r);
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    r->error = true;//prilis dlhy varint
+    return 0;
+}
+
+static int32_t get_svarint(ByteReader *r) {//precita zigzag varint
+    uint32_t value = get_varint(r);
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static Position get_position(ByteReader *r) {//precita poziciu
+    Position pos;
+    pos.x = get_svarint(r);
+    pos.y = get_svarint(r);
+    return pos;
+}
+
+static size_t varint_size(uint32_t value) {//pocet bajtov varintu
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+/** Encodings of fields in message table */
+typedef enum {
+    FIELD_ENUM,     /**< u8, at most limit */
+    FIELD_BOOL,     /**< u8 0 or 1 */
+    FIELD_VARINT,   /**< int or uint32_t as varint (negative ints take 5 bytes) */
+    FIELD_U64,      /**< u64 little-endian */
+    FIELD_STRING    /**< varint length and bytes without terminator */
+} FieldKind;
+
+/** One field of message (wire order is table order) */
+typedef struct {
+    MessageType type;   /**< Message the field belongs to */
+    FieldKind kind;     /**< Wire encoding */
+    size_t offset;      /**< Offset of member in Message */
+    size_t size;        /**< Size of member */
+    uint32_t limit;     /**< Largest valid value (FIELD_ENUM) */
+} MessageField;
+
+#define FIELD(type, kind, member) { type, kind, offsetof(Message, data.member), sizeof(((Message *)0)->data.member), 0 }
+#define ENUM_FIELD(type, member, last) { type, FIELD_ENUM, offsetof(Message, data.member), sizeof(((Message *)0)->data.member), last }
+
+// Schema of messages encoded by serialize_message - new fields go at the end of their message
+// (MSG_GAME_STATE, MSG_STATE_DELTA, MSG_MAP, MSG_ROSTER, MSG_GAME_LIST and MSG_COMPRESSED have own encoders)
+static const MessageField message_fields[] = {
+    ENUM_FIELD(MSG_CREATE_GAME, config.mode, MODE_TIMED),
+    ENUM_FIELD(MSG_CREATE_GAME, config.world_type, WORLD_WITH_OBSTACLES),
+    FIELD(MSG_CREATE_GAME, FIELD_VARINT, config.width),
+    FIELD(MSG_CREATE_GAME, FIELD_VARINT, config.height),
+    FIELD(MSG_CREATE_GAME, FIELD_VARINT, config.time_limit),
+    FIELD(MSG_CREATE_GAME, FIELD_STRING, config.map_file),
+    FIELD(MSG_CREATE_GAME, FIELD_BOOL, config.load_from_file),
+    FIELD(MSG_CREATE_GAME, FIELD_VARINT, config.max_players),
+    FIELD(MSG_CREATE_GAME, FIELD_VARINT, config.tick_rate),
+    FIELD(MSG_CREATE_GAME, FIELD_U64, config.seed),
     
-    // Message type
-    memcpy(buffer + offset, &msg->type, sizeof(MessageType));//skopiruj typ spravy
-    offset += sizeof(MessageType);
+    FIELD(MSG_JOIN_GAME, FIELD_VARINT, join_info.version),//vzdy prve - server podla neho odmietne stary klient
+    FIELD(MSG_JOIN_GAME, FIELD_VARINT, join_info.game_id),
+    FIELD(MSG_JOIN_GAME, FIELD_STRING, join_info.name),
+    FIELD(MSG_JOIN_GAME, FIELD_U64, join_info.rejoin_token),
+    FIELD(MSG_JOIN_GAME, FIELD_VARINT, join_info.codecs),
     
-    // Player ID
-    memcpy(buffer + offset, &msg->player_id, sizeof(int));//skopiruj ID hraca
-    offset += sizeof(int);
+    FIELD(MSG_JOINED, FIELD_VARINT, joined.game_id),
+    FIELD(MSG_JOINED, FIELD_U64, joined.rejoin_token),
+    FIELD(MSG_JOINED, FIELD_VARINT, joined.version),
     
-    // Data based on type
-    switch (msg->type) {//serializuj data podla typu spravy
-        case MSG_CREATE_GAME:
-            memcpy(buffer + offset, &msg->data.config, sizeof(GameConfig));//skopiruj konfiguraciu hry
-            offset += sizeof(GameConfig);
-            break;
-            
-        case MSG_JOIN_GAME:
-            memcpy(buffer + offset, &msg->data.join_info, sizeof(msg->data.join_info));//skopiruj join info (port, meno)
-            offset += sizeof(msg->data.join_info);
-            break;
-            
-        case MSG_GAME_STATE: {//serializuj stav hry
-            // Serialize game state without the pointer
-            const GameState *state = &msg->data.state;
-            
-            // Copy basic fields
-            memcpy(buffer + offset, &state->game_id, sizeof(int));//ID hry
-            offset += sizeof(int);
-            
-            memcpy(buffer + offset, state->snakes, sizeof(Snake) * MAX_PLAYERS);//vsetky hady
-            offset += sizeof(Snake) * MAX_PLAYERS;
-            
-            memcpy(buffer + offset, &state->player_count, sizeof(int));//pocet hracov
-            offset += sizeof(int);
-            
-            memcpy(buffer + offset, state->food, sizeof(Position) * MAX_PLAYERS);//pozicie jedla
-            offset += sizeof(Position) * MAX_PLAYERS;
-            
-            memcpy(buffer + offset, &state->food_count, sizeof(int));//pocet jedla
-            offset += sizeof(int);
-            
-            // Serialize obstacles array
-            memcpy(buffer + offset, &state->width, sizeof(int));//sirka mapy
-            offset += sizeof(int);
-            
-            memcpy(buffer + offset, &state->height, sizeof(int));//vyska mapy
-            offset += sizeof(int);
-            
-            int obstacle_size = state->width * state->height;//velkost bitmapy prekazok
-            if (state->obstacles && obstacle_size > 0) {
-                memcpy(buffer + offset, state->obstacles, obstacle_size);//skopiruj prekazky
-            } else {
-                memset(buffer + offset, 0, obstacle_size);//alebo vynuluj
+    FIELD(MSG_UDP_HELLO, FIELD_VARINT, joined.game_id),
+    FIELD(MSG_UDP_HELLO, FIELD_U64, joined.rejoin_token),
+    
+    ENUM_FIELD(MSG_PLAYER_INPUT, direction, DIR_NONE),
+    FIELD(MSG_ERROR, FIELD_STRING, error_msg),
+    FIELD(MSG_STATE_ACK, FIELD_VARINT, tick),
+    FIELD(MSG_GAME_CREATED, FIELD_VARINT, game_id),
+    FIELD(MSG_LIST_GAMES, FIELD_VARINT, after_game_id),
+};
+
+#define MESSAGE_FIELD_COUNT (sizeof(message_fields) / sizeof(message_fields[0]))
+
+static uint64_t load_member(const uint8_t *member, size_t size) {//nacita cele cislo lubovolnej velkosti zo struktury
+    switch (size) {
+        case 1: { uint8_t value; memcpy(&value, member, 1); return value; }
+        case 2: { uint16_t value; memcpy(&value, member, 2); return value; }
+        case 4: { uint32_t value; memcpy(&value, member, 4); return value; }
+        default: { uint64_t value; memcpy(&value, member, 8); return value; }
+    }
+}
+
+static void store_member(uint8_t *member, size_t size, uint64_t value) {//ulozi cele cislo do clena struktury
+    switch (size) {
+        case 1: { uint8_t v = (uint8_t)value; memcpy(member, &v, 1); break; }
+        case 2: { uint16_t v = (uint16_t)value; memcpy(member, &v, 2); break; }
+        case 4: { uint32_t v = (uint32_t)value; memcpy(member, &v, 4); break; }
+        default: memcpy(member, &value, 8); break;
+    }
+}
+
+static void put_fields(ByteWriter *w, const Message *msg) {//zapise polia spravy podla tabulky
+    for (size_t i = 0; i < MESSAGE_FIELD_COUNT; i++) {
+        const MessageField *field = &message_fields[i];
+        if (field->type != msg->type) {
+            continue;
+        }
+        const uint8_t *member = (const uint8_t *)msg + field->offset;
+        switch (field->kind) {
+            case FIELD_ENUM:
+                put_u8(w, (uint8_t)load_member(member, field->size));
+                break;
+            case FIELD_BOOL:
+                put_u8(w, load_member(member, field->size) ? 1 : 0);
+                break;
+            case FIELD_VARINT:
+                put_varint(w, (uint32_t)load_member(member, field->size));
+                break;
+            case FIELD_U64:
+                put_u64(w, load_member(member, field->size));
+                break;
+            case FIELD_STRING: {
+                size_t length = strnlen((const char *)member, field->size - 1);//bez ukoncovacej nuly
+                put_varint(w, (uint32_t)length);
+                for (size_t j = 0; j < length; j++) {
+                    put_u8(w, member[j]);
+                }
+                break;
+            }
+        }
+    }
+}
+
+static bool get_fields(ByteReader *r, Message *msg) {//precita polia spravy podla tabulky
+    for (size_t i = 0; i < MESSAGE_FIELD_COUNT; i++) {
+        const MessageField *field = &message_fields[i];
+        if (field->type != msg->type) {
+            continue;
+        }
+        uint8_t *member = (uint8_t *)msg + field->offset;
+        memset(member, 0, field->size);
+        if (r->offset == r->size) {//odosielatel pole este nepozna - ostava nula
+            continue;
+        }
+        switch (field->kind) {
+            case FIELD_ENUM: {
+                uint8_t value = get_u8(r);
+                if (value > field->limit) {//neznama hodnota enumu
+                    return false;
+                }
+                store_member(member, field->size, value);
+                break;
+            }
+            case FIELD_BOOL:
+                store_member(member, field->size, get_u8(r) != 0);
+                break;
+            case FIELD_VARINT:
+                store_member(member, field->size, get_varint(r));
+                break;
+            case FIELD_U64:
+                store_member(member, field->size, get_u64(r));
+                break;
+            case FIELD_STRING: {
+                size_t length = get_varint(r);
+                if (r->error || length >= field->size || length > r->size - r->offset) {//retazec sa nezmesti
+                    return false;
+                }
+                memcpy(member, r->data + r->offset, length);
+                r->offset += length;
+                break;//zvysok clena je vynulovany (ukoncovacia nula)
             }
-            offset += obstacle_size;
-            
-            memcpy(buffer + offset, &state->elapsed_time, sizeof(int));//uplynuly cas
-            offset += sizeof(int);
-            
-            memcpy(buffer + offset, &state->time_limit, sizeof(int));//casovy limit
-            offset += sizeof(int);
-            
-            memcpy(buffer + offset, &state->mode, sizeof(GameMode));//mod hry
-            offset += sizeof(GameMode);
-            
-            memcpy(buffer + offset, &state->game_over, sizeof(bool));//ci je hra ukoncena
-            offset += sizeof(bool);
-            
-            memcpy(buffer + offset, &state->max_players, sizeof(int));//max pocet hracov
-            offset += sizeof(int);
-            break;
         }
-            
-        case MSG_PLAYER_INPUT:
-            memcpy(buffer + offset, &msg->data.direction, sizeof(Direction));//skopiruj smer pohybu
-            offset += sizeof(Direction);
-            break;
-            
-        case MSG_ERROR:
-            memcpy(buffer + offset, msg->data.error_msg, 256);//skopiruj chybovu spravu
-            offset += 256;
-            break;
-            
-        case MSG_PAUSE:
-        case MSG_RESUME:
-        case MSG_PLAYER_DISCONNECT:
-        case MSG_GAME_OVER:
-        case MSG_LIST_GAMES:
-            // No additional data - tieto spravy nemaju ziadne dalsie data
-            break;
     }
+    return !r->error;
+}
+
+static bool same_position(Position a, Position b) {//porovna dve pozicie
+    return a.x == b.x && a.y == b.y;
+}
+
+static Position step_position(Position pos, int code, int width, int height) {//krok o jeden segment smerom k chvostu (s prechodom cez okraj)
+    static const int dx[4] = { 0, 0, -1, 1 };//hore, dole, vlavo, vpravo
+    static const int dy[4] = { -1, 1, 0, 0 };
+    Position next = { pos.x + dx[code], pos.y + dy[code] };
     
-    *size = offset;//vrat celkovu velkost serializovanej spravy
+    // Step off the map from inside wraps around (segments outside the map never wrap)
+    if (pos.x >= 0 && pos.x < width && (next.x < 0 || next.x >= width)) {
+        next.x = (next.x + width) % width;
+    }
+    if (pos.y >= 0 && pos.y < height && (next.y < 0 || next.y >= height)) {
+        next.y = (next.y + height) % height;
+    }
+    return next;
 }
 
-bool deserialize_message(const uint8_t *buffer, size_t size, Message *msg) {//deserializuje binarny buffer do Message struktury
-    if (size < sizeof(MessageType) + sizeof(int)) {//minimalna velkost spravy
+static int step_code(Position from, Position to, int width, int height) {//2-bitovy kod kroku medzi susednymi segmentmi, -1 ak nie su susedne
+    for (int code = 0; code < 4; code++) {
+        if (same_position(step_position(from, code, width, height), to)) {
+            return code;
+        }
+    }
+    return -1;
+}
+
+static void put_snake_body(ByteWriter *w, const Snake *snake, int width, int height) {//zapise telo hada (dlzka umerna dlzke hada)
+    put_varint(w, (uint32_t)snake->length);//dlzka
+    if (snake->length == 0) {
+        return;
+    }
+    
+    // Trailing duplicates come from growth, only their count is sent
+    int tail = snake->length - 1;//posledny segment retazca
+    while (tail > 0 && same_position(snake_segment(snake, tail), snake_segment(snake, tail - 1))) {
+        tail--;
+    }
+    
+    size_t body_offset = w->offset;
+    put_u8(w, SNAKE_BODY_CHAIN);
+    put_position(w, snake_segment(snake, 0));//hlava
+    put_varint(w, (uint32_t)(snake->length - 1 - tail));//pocet duplikatov chvosta
+    uint8_t bits = 0;//styri kroky na bajt
+    for (int i = 0; i < tail; i++) {
+        int code = step_code(snake_segment(snake, i), snake_segment(snake, i + 1), width, height);
+        if (code < 0) {//segmenty nie su susedne - posli suradnice
+            w->offset = body_offset;
+            put_u8(w, SNAKE_BODY_RAW);
+            for (int j = 0; j < snake->length; j++) {
+                put_position(w, snake_segment(snake, j));
+            }
+            return;
+        }
+        bits |= (uint8_t)(code << ((i % 4) * 2));
+        if (i % 4 == 3 || i == tail - 1) {
+            put_u8(w, bits);
+            bits = 0;
+        }
+    }
+}
+
+static bool get_snake_body(ByteReader *r, Snake *snake, int width, int height) {//precita telo hada
+    int length = (int)get_varint(r);
+    if (r->error || length < 0 || length > MAX_SNAKE_LENGTH) {//neplatna dlzka
+        return false;
+    }
+    snake->length = length;
+    snake->head = 0;//dekodovane telo zacina na zaciatku ring bufferu
+    if (length == 0) {
+        return true;
+    }
+    
+    uint8_t encoding = get_u8(r);
+    if (encoding == SNAKE_BODY_RAW) {//suradnice vsetkych segmentov
+        for (int i = 0; i < length; i++) {
+            set_snake_segment(snake, i, get_position(r));
+        }
+        return !r->error;
+    }
+    if (encoding != SNAKE_BODY_CHAIN) {
+        return false;
+    }
+    
+    set_snake_segment(snake, 0, get_position(r));//hlava
+    int duplicates = (int)get_varint(r);
+    if (r->error || duplicates < 0 || duplicates > length - 1) {
+        return false;
+    }
+    int tail = length - 1 - duplicates;
+    uint8_t bits = 0;
+    for (int i = 0; i < tail; i++) {//retazec krokov od hlavy
+        if (i % 4 == 0) {
+            bits = get_u8(r);
+        }
+        int code = (bits >> ((i % 4) * 2)) & 3;
+        set_snake_segment(snake, i + 1, step_position(snake_segment(snake, i), code, width, height));
+    }
+    for (int i = tail + 1; i < length; i++) {//duplikaty chvosta (had rastie)
+        set_snake_segment(snake, i, snake_segment(snake, i - 1));
+    }
+    return !r->error;
+}
+
+static void put_full_snake(ByteWriter *w, const Snake *snake, int width, int height) {//zapise celeho hada (meno ide v MSG_ROSTER)
+    put_varint(w, (uint32_t)snake->serial);//seriove cislo spawnu
+    put_varint(w, (uint32_t)snake->steps);//pocet krokov
+    put_snake_body(w, snake, width, height);//telo
+    put_u8(w, (uint8_t)snake->direction);//smer
+    put_varint(w, (uint32_t)snake->score);//skore
+    put_u8(w, snake->alive ? 1 : 0);//ci zije
+    put_u8(w, snake->paused ? 1 : 0);//ci je pozastaveny
+    put_varint(w, (uint32_t)snake->spawn_time);//cas spawnu
+}
+
+static bool get_full_snake(ByteReader *r, Snake *snake, int player_id, int width, int height) {//precita celeho hada
+    memset(snake, 0, sizeof(Snake));
+    snake->player_id = player_id;
+    snake->serial = (int)get_varint(r);
+    snake->steps = (int)get_varint(r);
+    if (!get_snake_body(r, snake, width, height)) {
+        return false;
+    }
+    uint8_t direction = get_u8(r);
+    if (direction > DIR_NONE) {//neznamy smer
         return false;
     }
+    snake->direction = (Direction)direction;
+    snake->score = (int)get_varint(r);
+    snake->alive = get_u8(r) != 0;
+    snake->paused = get_u8(r) != 0;
+    snake->spawn_time = (int)get_varint(r);
+    snake->turn_count = 0;
+    return !r->error;
+}
+
+static void put_state_body(ByteWriter *w, const GameState *state) {//zapise telo MSG_GAME_STATE (keyframe)
+    put_varint(w, (uint32_t)state->game_id);//ID hry
+    put_varint(w, (uint32_t)state->tick);//cislo snapshotu
+    put_varint(w, (uint32_t)state->player_count);//pocet hracov
+    put_varint(w, (uint32_t)state->width);//sirka mapy
+    put_varint(w, (uint32_t)state->height);//vyska mapy
+    put_varint(w, state->map_id);//odkaz na mapu prekazok (MSG_MAP)
+    put_varint(w, (uint32_t)state->elapsed_time);//uplynuly cas
+    put_varint(w, (uint32_t)state->time_limit);//casovy limit
+    put_u8(w, (uint8_t)state->mode);//mod hry
+    put_u8(w, state->game_over ? 1 : 0);//ci je hra ukoncena
+    put_varint(w, (uint32_t)state->max_players);//max pocet hracov
     
-    size_t offset = 0;//aktualny posun v bufferi
+    put_varint(w, (uint32_t)state->food_count);//jedlo
+    for (int i = 0; i < state->food_count; i++) {
+        put_position(w, state->food[i]);
+    }
     
-    // Message type
-    memcpy(&msg->type, buffer + offset, sizeof(MessageType));//nacitaj typ spravy
-    offset += sizeof(MessageType);
+    // Snakes - only slots that were ever spawned
+    uint8_t present = 0;//maska obsadenych slotov
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (state->snakes[i].serial != 0) {
+            present |= (uint8_t)(1u << i);
+        }
+    }
+    put_u8(w, present);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (present & (1u << i)) {
+            put_full_snake(w, &state->snakes[i], state->width, state->height);
+        }
+    }
+}
+
+static bool get_state_body(ByteReader *r, GameState *state) {//precita telo MSG_GAME_STATE (keyframe)
+    state->game_id = (int)get_varint(r);
+    state->tick = (int)get_varint(r);
+    state->player_count = (int)get_varint(r);
+    state->width = (int)get_varint(r);
+    state->height = (int)get_varint(r);
+    state->map_id = get_varint(r);
+    state->elapsed_time = (int)get_varint(r);
+    state->time_limit = (int)get_varint(r);
+    uint8_t mode = get_u8(r);
+    if (mode > MODE_TIMED) {//neznamy mod
+        return false;
+    }
+    state->mode = (GameMode)mode;
+    state->game_over = get_u8(r) != 0;
+    state->max_players = (int)get_varint(r);
+    state->obstacles = NULL;//prekazky drzi klient z MSG_MAP
     
-    // Player ID
-    memcpy(&msg->player_id, buffer + offset, sizeof(int));//nacitaj ID hraca
-    offset += sizeof(int);
+    int food_count = (int)get_varint(r);
+    if (r->error || food_count < 0 || food_count > MAX_PLAYERS) {
+        return false;
+    }
+    for (int i = 0; i < food_count; i++) {
+        state->food[i] = get_position(r);
+    }
+    state->food_count = food_count;
+    
+    uint8_t present = get_u8(r);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (!(present & (1u << i))) {//prazdny slot
+            memset(&state->snakes[i], 0, sizeof(Snake));
+            continue;
+        }
+        if (!get_full_snake(r, &state->snakes[i], i, state->width, state->height)) {
+            return false;
+        }
+    }
+    return !r->error;
+}
+
+uint32_t compute_map_id(const uint8_t *obstacles, int width, int height) {//FNV-1a hash rozmerov a prekazok
+    uint32_t hash = 2166136261u;
+    uint32_t dims[2] = { (uint32_t)width, (uint32_t)height };
+    for (int i = 0; i < 8; i++) {//rozmery mapy (little-endian na kazdej architekture)
+        uint8_t byte = (uint8_t)(dims[i / 4] >> (8 * (i % 4)));
+        hash = (hash ^ byte) * 16777619u;
+    }
+    for (int i = 0; i < width * height; i++) {//kazda bunka (0 alebo 1)
+        uint8_t cell = (obstacles && obstacles[i]) ? 1 : 0;
+        hash = (hash ^ cell) * 16777619u;
+    }
+    return hash;
+}
+
+size_t map_message_size(int width, int height) {//velkost serializovanej MSG_MAP spravy
+    return MESSAGE_HEADER_SIZE//typ a ID hraca
+        + 4 + varint_size((uint32_t)width) + varint_size((uint32_t)height)//ID mapy a rozmery
+        + (size_t)(width * height + 7) / 8;//jeden bit na bunku
+}
+
+void serialize_map(const GameState *state, uint8_t *buffer, size_t *size) {//serializuje MSG_MAP zo stavu hry
+    ByteWriter w = { buffer, map_message_size(state->width, state->height), 0, false };
+    w.offset = write_message_header(buffer, MSG_MAP, -1);//ziadny konkretny hrac
+    put_u32(&w, state->map_id);//ID mapy (hash, varint by ho nezmensil)
+    put_varint(&w, (uint32_t)state->width);//sirka mapy
+    put_varint(&w, (uint32_t)state->height);//vyska mapy
+    size_t offset = w.offset;
+    
+    // Pack obstacles, one bit per cell (LSB first)
+    int cells = state->width * state->height;
+    size_t packed = (size_t)(cells + 7) / 8;
+    memset(buffer + offset, 0, packed);
+    if (state->obstacles) {
+        for (int i = 0; i < cells; i++) {
+            if (state->obstacles[i]) {
+                buffer[offset + i / 8] |= (uint8_t)(1u << (i % 8));
+            }
+        }
+    }
+    offset += packed;
+    
+    *size = offset;
+}
+
+static size_t snake_max_size(const Snake *snake) {//horna hranica zakodovaneho hada
+    return SNAKE_HEADER_MAX_SIZE + (size_t)snake->length * POSITION_MAX_SIZE;//aj pri zalohe na suradnice
+}
+
+size_t game_state_message_size(const GameState *state) {//horna hranica velkosti MSG_GAME_STATE spravy
+    size_t size = MESSAGE_HEADER_SIZE//typ a ID hraca
+        + 16 * 5 + 1//skalarne polia ako varinty, maska hadov
+        + 5 + MAX_PLAYERS * POSITION_MAX_SIZE;//jedlo
+    for (int i = 0; i < MAX_PLAYERS; i++) {//hady (dlzka umerna dlzke hada)
+        size += snake_max_size(&state->snakes[i]);
+    }
+    return size;
+}
+
+void serialize_game_state(const GameState *state, uint8_t *buffer, size_t *size) {//serializuje MSG_GAME_STATE priamo zo stavu hry
+    ByteWriter w = { buffer, game_state_message_size(state), 0, false };
+    w.offset = write_message_header(buffer, MSG_GAME_STATE, -1);//ziadny konkretny hrac
+    put_state_body(&w, state);//telo spravy
+    *size = w.offset;
+}
+
+bool deserialize_game_state(const uint8_t *buffer, size_t size, GameState *state) {//precita MSG_GAME_STATE priamo do stavu hry
+    ByteReader r = { buffer, size, MESSAGE_HEADER_SIZE, false };
+    if (size < r.offset) {
+        return false;
+    }
+    return get_state_body(&r, state);
+}
+
+size_t serialize_roster(const GameState *state, uint8_t *buffer, size_t capacity) {//serializuje mena hracov (MSG_ROSTER)
+    ByteWriter w = { buffer, capacity, 0, false };
+
+    if (capacity < MESSAGE_HEADER_SIZE) {
+        return 0;
+    }
+    w.offset = write_message_header(buffer, MSG_ROSTER, -1);//ziadny konkretny hrac
+    
+    uint8_t count = 0;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (state->snakes[i].serial != 0) {
+            count++;
+        }
+    }
+    put_u8(&w, count);
+    for (int i = 0; i < MAX_PLAYERS; i++) {//kazdy obsadeny slot
+        const Snake *snake = &state->snakes[i];
+        if (snake->serial == 0) {
+            continue;
+        }
+        put_u8(&w, (uint8_t)i);//ID hraca
+        put_varint(&w, (uint32_t)snake->serial);//spawn, ku ktoremu meno patri
+        size_t name_len = strnlen(snake->name, MAX_NAME_LENGTH - 1);//dlzka mena
+        put_u8(&w, (uint8_t)name_len);
+        for (size_t j = 0; j < name_len; j++) {
+            put_u8(&w, (uint8_t)snake->name[j]);
+        }
+    }
+    return w.overflow ? 0 : w.offset;
+}
+
+size_t serialize_game_list(int total, const GameSummary *games, int count, uint8_t *buffer, size_t capacity) {//serializuje stranku zoznamu hier (MSG_GAME_LIST)
+    ByteWriter w = { buffer, capacity, 0, false };
+
+    if (capacity < MESSAGE_HEADER_SIZE || count > GAME_LIST_PAGE_SIZE) {
+        return 0;
+    }
+    w.offset = write_message_header(buffer, MSG_GAME_LIST, -1);//ziadny konkretny hrac
+    
+    put_varint(&w, (uint32_t)total);//pocet vsetkych hier
+    put_u8(&w, (uint8_t)count);//pocet hier v stranke
+    for (int i = 0; i < count; i++) {
+        const GameSummary *game = &games[i];
+        put_varint(&w, (uint32_t)game->game_id);
+        put_u8(&w, (uint8_t)game->mode);
+        put_u8(&w, game->obstacles ? 1 : 0);
+        put_varint(&w, (uint32_t)game->width);
+        put_varint(&w, (uint32_t)game->height);
+        put_u8(&w, (uint8_t)game->player_count);
+        put_u8(&w, (uint8_t)game->max_players);
+        put_varint(&w, (uint32_t)game->elapsed_time);
+        put_varint(&w, (uint32_t)game->time_limit);
+    }
+    return w.overflow ? 0 : w.offset;
+}
+
+static bool put_snake_body_delta(ByteWriter *w, const SnakeBaseline *base, const Snake *snake) {//zapise zmenu tela voci baseline, false ak sa neda
+    if (snake->serial != base->serial || snake->steps < base->steps) {//iny spawn
+        return false;
+    }
+    
+    int moved = snake->steps - base->steps;//pocet krokov od baseline
+    if ((base->head + MAX_SNAKE_LENGTH - moved % MAX_SNAKE_LENGTH) % MAX_SNAKE_LENGTH != snake->head) {//ring buffer bol poskladany nanovo
+        return false;
+    }
+    int moves = moved < snake->length ? moved : snake->length;//pocet novych hlav (viac ako dlzka = cele telo je nove)
+    
+    // Baseline body is still in the ring behind the new heads; growth writes only
+    // behind the tail (duplicates), so it ends where the trailing duplicates start
+    int tail = snake->length;//zaciatok duplikatov chvosta
+    while (tail > 1 && same_position(snake_segment(snake, tail - 1), snake_segment(snake, tail - 2))) {
+        tail--;
+    }
+    int kept = tail > moves ? tail - moves : 0;//pocet segmentov prevzatych z baseline
+    if (kept > base->length || (snake->length > 0 && moves + kept == 0)) {//telo sa neda vyjadrit voci baseline
+        return false;
+    }
+    
+    put_varint(w, (uint32_t)moves);//nove hlavy
+    for (int i = 0; i < moves; i++) {
+        put_position(w, snake_segment(snake, i));
+    }
+    put_varint(w, (uint32_t)kept);//segmenty z baseline
+    put_varint(w, (uint32_t)snake->length);//nova dlzka (zvysok su duplikaty chvosta)
+    return true;
+}
+
+static bool get_snake_body_delta(ByteReader *r, const Snake *base, Snake *snake) {//aplikuje zmenu tela na baseline
+    uint32_t moves = get_varint(r);//bez znamienka - velke hodnoty nesmu byt zaporne indexy
+    if (r->error || moves > MAX_SNAKE_LENGTH) {
+        return false;
+    }
+    snake->head = 0;//telo sa sklada nanovo od zaciatku ring bufferu (baseline je samostatna kopia)
+    for (uint32_t i = 0; i < moves; i++) {//nove hlavy
+        set_snake_segment(snake, (int)i, get_position(r));
+    }
+    uint32_t kept = get_varint(r);
+    uint32_t length = get_varint(r);
+    if (r->error || kept > (uint32_t)base->length || length > MAX_SNAKE_LENGTH || moves + kept > length ||
+        (length > 0 && moves + kept == 0)) {//neplatna delta (moves aj kept su najviac MAX_SNAKE_LENGTH, sucet nepretecie)
+        return false;
+    }
+    for (uint32_t i = 0; i < kept; i++) {//prevzaty zaciatok baseline
+        set_snake_segment(snake, (int)(moves + i), snake_segment(base, (int)i));
+    }
+    for (uint32_t i = moves + kept; i < length; i++) {//duplikaty chvosta (had rastie)
+        set_snake_segment(snake, (int)i, snake_segment(snake, (int)i - 1));
+    }
+    snake->length = (int)length;
+    snake->steps = base->steps + (int)moves;
+    return true;
+}
+
+void capture_state_baseline(const GameState *state, StateBaseline *baseline) {//zapamata polia, voci ktorym sa koduje delta (bez tiel)
+    baseline->tick = state->tick;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const Snake *snake = &state->snakes[i];
+        SnakeBaseline *base = &baseline->snakes[i];
+        base->head = snake->head;//telo ostava v ring bufferi hada
+        base->length = snake->length;
+        base->steps = snake->steps;
+        base->serial = snake->serial;
+        base->spawn_time = snake->spawn_time;
+        base->score = snake->score;
+        base->direction = snake->direction;
+        base->alive = snake->alive;
+        base->paused = snake->paused;
+    }
+    memcpy(baseline->food, state->food, sizeof(baseline->food));
+    baseline->food_count = state->food_count;
+}
+
+size_t serialize_state_delta(const StateBaseline *baseline, const GameState *state,
+                             uint8_t *buffer, size_t capacity) {//serializuje MSG_STATE_DELTA voci baseline
+    ByteWriter w = { buffer, capacity, 0, false };
+
+    if (capacity < MESSAGE_HEADER_SIZE) {
+        return 0;
+    }
+    w.offset = write_message_header(buffer, MSG_STATE_DELTA, -1);//ziadny konkretny hrac
+    
+    // Header
+    put_varint(&w, (uint32_t)state->tick);//tick snapshotu
+    put_varint(&w, (uint32_t)baseline->tick);//tick baseline
+    put_varint(&w, (uint32_t)state->elapsed_time);//uplynuly cas
+    put_varint(&w, (uint32_t)state->player_count);//pocet hracov
+    
+    bool food_changed = state->food_count != baseline->food_count ||
+                        memcmp(state->food, baseline->food, state->food_count * sizeof(Position)) != 0;//zmenilo sa jedlo?
+    uint8_t flags = (state->game_over ? STATE_DELTA_GAME_OVER : 0) | (food_changed ? STATE_DELTA_FOOD : 0);
+    put_u8(&w, flags);
+    
+    // Food
+    if (food_changed) {//posli cely zoznam jedla (je maly)
+        put_varint(&w, (uint32_t)state->food_count);
+        for (int i = 0; i < state->food_count; i++) {
+            put_position(&w, state->food[i]);
+        }
+    }
+    
+    // Snakes - count of changed snakes is patched after encoding them
+    size_t count_offset = w.offset;//miesto pre pocet zmenenych hadov
+    put_u8(&w, 0);
+    uint8_t changed = 0;
+    
+    for (int i = 0; i < MAX_PLAYERS; i++) {//zakoduj zmeny kazdeho hada
+        const SnakeBaseline *base = &baseline->snakes[i];
+        const Snake *snake = &state->snakes[i];
+        
+        size_t snake_offset = w.offset;//zaciatok zaznamu hada
+        put_u8(&w, (uint8_t)i);//ID hraca
+        size_t mask_offset = w.offset;//miesto pre masku zmien
+        put_u8(&w, 0);
+        uint8_t mask = 0;
+        
+        bool body_changed = snake->steps != base->steps || snake->length != base->length ||
+                            snake->serial != base->serial;//zmenilo sa telo?
+        if (snake->serial != base->serial || snake->spawn_time != base->spawn_time) {//novy had - posli cely
+            mask = SNAKE_DELTA_FULL;
+            put_full_snake(&w, snake, state->width, state->height);
+        } else {
+            if (body_changed) {//nove hlavy, odstraneny chvost, rast
+                size_t body_offset = w.offset;
+                if (put_snake_body_delta(&w, base, snake)) {
+                    mask |= SNAKE_DELTA_BODY;
+                } else {//telo sa neda vyjadrit ako delta - posli cely
+                    w.offset = body_offset;
+                    mask = SNAKE_DELTA_FULL;
+                    put_full_snake(&w, snake, state->width, state->height);
+                }
+            }
+            if (!(mask & SNAKE_DELTA_FULL)) {
+                if (snake->score != base->score) {//zmena skore
+                    mask |= SNAKE_DELTA_SCORE;
+                    put_varint(&w, (uint32_t)snake->score);
+                }
+                if (snake->alive != base->alive) {//zmena zivota
+                    mask |= SNAKE_DELTA_ALIVE;
+                    put_u8(&w, snake->alive ? 1 : 0);
+                }
+                if (snake->paused != base->paused) {//zmena pauzy
+                    mask |= SNAKE_DELTA_PAUSED;
+                    put_u8(&w, snake->paused ? 1 : 0);
+                }
+                if (snake->direction != base->direction) {//zmena smeru
+                    mask |= SNAKE_DELTA_DIRECTION;
+                    put_u8(&w, (uint8_t)snake->direction);
+                }
+            }
+        }
+        
+        if (mask == 0) {//had sa nezmenil - zaznam sa vynecha
+            w.offset = snake_offset;
+            continue;
+        }
+        if (!w.overflow) {
+            buffer[mask_offset] = mask;
+        }
+        changed++;
+    }
+    
+    if (w.overflow) {//delta sa nezmestila
+        return 0;
+    }
+    buffer[count_offset] = changed;//pocet zmenenych hadov
+    return w.offset;
+}
+
+bool apply_state_delta(const uint8_t *buffer, size_t size, const GameState *baseline, GameState *state) {//aplikuje MSG_STATE_DELTA na baseline
+    ByteReader r = { buffer, size, MESSAGE_HEADER_SIZE, false };
+    if (size < r.offset) {
+        return false;
+    }
+    
+    *state = *baseline;//staticke polia (mapa, mod, limity) su z baseline
+    
+    // Header
+    state->tick = (int)get_varint(&r);
+    int baseline_tick = (int)get_varint(&r);
+    state->elapsed_time = (int)get_varint(&r);
+    state->player_count = (int)get_varint(&r);
+    uint8_t flags = get_u8(&r);
+    if (r.error || baseline_tick != baseline->tick) {//delta je voci inemu snapshotu
+        return false;
+    }
+    state->game_over = (flags & STATE_DELTA_GAME_OVER) != 0;
+    
+    // Food
+    if (flags & STATE_DELTA_FOOD) {
+        int food_count = (int)get_varint(&r);
+        if (r.error || food_count < 0 || food_count > MAX_PLAYERS) {
+            return false;
+        }
+        for (int i = 0; i < food_count; i++) {
+            state->food[i] = get_position(&r);
+        }
+        state->food_count = food_count;
+    }
+    
+    // Snakes
+    uint8_t changed = get_u8(&r);
+    for (int n = 0; n < changed && !r.error; n++) {//aplikuj zmeny hadov
+        uint8_t id = get_u8(&r);
+        uint8_t mask = get_u8(&r);
+        if (id >= MAX_PLAYERS) {
+            return false;
+        }
+        Snake *snake = &state->snakes[id];
+        
+        if (mask & SNAKE_DELTA_FULL) {//cely had
+            if (!get_full_snake(&r, snake, id, state->width, state->height)) {
+                return false;
+            }
+            continue;
+        }
+        if ((mask & SNAKE_DELTA_BODY) && !get_snake_body_delta(&r, &baseline->snakes[id], snake)) {//zmena tela
+            return false;
+        }
+        if (mask & SNAKE_DELTA_SCORE) {
+            snake->score = (int)get_varint(&r);
+        }
+        if (mask & SNAKE_DELTA_ALIVE) {
+            snake->alive = get_u8(&r) != 0;
+        }
+        if (mask & SNAKE_DELTA_PAUSED) {
+            snake->paused = get_u8(&r) != 0;
+        }
+        if (mask & SNAKE_DELTA_DIRECTION) {
+            uint8_t direction = get_u8(&r);
+            if (direction > DIR_NONE) {//neznamy smer
+                return false;
+            }
+            snake->direction = (Direction)direction;
+        }
+    }
+    
+    return !r.error;
+}
+
+size_t write_message_header(uint8_t *buffer, MessageType type, int player_id) {//zapise hlavicku spravy
+    buffer[0] = (uint8_t)type;//typ spravy
+    buffer[1] = (uint8_t)(player_id + 1);//ID hraca (0 = ziadny)
+    return MESSAGE_HEADER_SIZE;
+}
+
+bool read_message_header(const uint8_t *buffer, size_t size, MessageType *type, int *player_id) {//precita hlavicku spravy
+    if (size < MESSAGE_HEADER_SIZE || buffer[0] > MSG_COMPRESSED) {//kratka sprava alebo neznamy typ (MSG_COMPRESSED je posledny)
+        return false;
+    }
+    *type = (MessageType)buffer[0];
+    *player_id = (int)buffer[1] - 1;
+    return true;
+}
+
+size_t message_size(const Message *msg) {//velkost serializovanej spravy (podla tabulky)
+    size_t size = MESSAGE_HEADER_SIZE;
+    for (size_t i = 0; i < MESSAGE_FIELD_COUNT; i++) {
+        const MessageField *field = &message_fields[i];
+        if (field->type != msg->type) {
+            continue;
+        }
+        const uint8_t *member = (const uint8_t *)msg + field->offset;
+        switch (field->kind) {
+            case FIELD_ENUM:
+            case FIELD_BOOL:
+                size += 1;
+                break;
+            case FIELD_VARINT:
+                size += varint_size((uint32_t)load_member(member, field->size));
+                break;
+            case FIELD_U64:
+                size += 8;
+                break;
+            case FIELD_STRING: {
+                size_t length = strnlen((const char *)member, field->size - 1);
+                size += varint_size((uint32_t)length) + length;
+                break;
+            }
+        }
+    }
+    return size;
+}
+
+void serialize_message(const Message *msg, uint8_t *buffer, size_t *size) {//serializuje Message do binarneho buffera
+    ByteWriter w = { buffer, SMALL_MESSAGE_MAX_SIZE, 0, false };
+    w.offset = write_message_header(buffer, msg->type, msg->player_id);
+    put_fields(&w, msg);//polia podla tabulky (spravy bez dat nemaju ziadne)
+    *size = w.offset;//vrat celkovu velkost serializovanej spravy
+}
+
+bool deserialize_message(const uint8_t *buffer, size_t size, Message *msg) {//deserializuje binarny buffer do Message struktury
+    if (!read_message_header(buffer, size, &msg->type, &msg->player_id)) {//typ a ID hraca
+        return false;
+    }
+    size_t offset = MESSAGE_HEADER_SIZE;//aktualny posun v bufferi
     
     // Data based on type
     switch (msg->type) {//deserializuj data podla typu spravy
         case MSG_CREATE_GAME:
-            if (size < offset + sizeof(GameConfig)) return false;//over velkost bufferu
-            memcpy(&msg->data.config, buffer + offset, sizeof(GameConfig));//nacitaj konfiguraciu
-            break;
-            
         case MSG_JOIN_GAME:
-            if (size < offset + sizeof(msg->data.join_info)) return false;//over velkost bufferu
-            memcpy(&msg->data.join_info, buffer + offset, sizeof(msg->data.join_info));//nacitaj join info
+        case MSG_JOINED:
+        case MSG_UDP_HELLO:
+        case MSG_PLAYER_INPUT:
+        case MSG_ERROR:
+        case MSG_STATE_ACK:
+        case MSG_GAME_CREATED:
+        case MSG_LIST_GAMES: {//polia podla tabulky
+            ByteReader r = { buffer, size, offset, false };
+            if (!get_fields(&r, msg)) return false;
             break;
+        }
             
-        case MSG_GAME_STATE: {//deserializuj stav hry
-            // Deserialize game state
-            GameState *state = &msg->data.state;
-            
-            if (size < offset + sizeof(int)) return false;//over velkost
-            memcpy(&state->game_id, buffer + offset, sizeof(int));//nacitaj ID hry
-            offset += sizeof(int);
-            
-            if (size < offset + sizeof(Snake) * MAX_PLAYERS) return false;//over velkost
-            memcpy(state->snakes, buffer + offset, sizeof(Snake) * MAX_PLAYERS);//nacitaj vsetkych hadov
-            offset += sizeof(Snake) * MAX_PLAYERS;
-            
-            if (size < offset + sizeof(int)) return false;//over velkost
-            memcpy(&state->player_count, buffer + offset, sizeof(int));//nacitaj pocet hracov
-            offset += sizeof(int);
-            
-            if (size < offset + sizeof(Position) * MAX_PLAYERS) return false;//over velkost
-            memcpy(state->food, buffer + offset, sizeof(Position) * MAX_PLAYERS);//nacitaj pozicie jedla
-            offset += sizeof(Position) * MAX_PLAYERS;
-            
-            if (size < offset + sizeof(int)) return false;//over velkost
-            memcpy(&state->food_count, buffer + offset, sizeof(int));//nacitaj pocet jedla
-            offset += sizeof(int);
-            
-            if (size < offset + sizeof(int) * 2) return false;//over velkost
-            memcpy(&state->width, buffer + offset, sizeof(int));//nacitaj sirku mapy
-            offset += sizeof(int);
-            
-            memcpy(&state->height, buffer + offset, sizeof(int));//nacitaj vysku mapy
-            offset += sizeof(int);
+        case MSG_GAME_STATE: {//len hlavicka, telo precita deserialize_game_state
+            ByteReader r = { buffer, size, offset, false };
+            msg->data.keyframe.game_id = (int)get_varint(&r);//prve polia tela
+            msg->data.keyframe.tick = (int)get_varint(&r);
+            if (r.error) return false;
+            break;
+        }
             
-            // Allocate and copy obstacles
-            int obstacle_size = state->width * state->height;//velkost bitmapy prekazok
-            if (obstacle_size > 0 && size >= offset + obstacle_size) {
-                state->obstacles = (uint8_t *)malloc(obstacle_size);//alokuj pamat pre prekazky
-                if (state->obstacles) {
-                    memcpy(state->obstacles, buffer + offset, obstacle_size);//skopiruj prekazky
+        case MSG_ROSTER: {//mena hracov
+            ByteReader r = { buffer, size, offset, false };
+            int count = get_u8(&r);
+            if (count > MAX_PLAYERS) return false;
+            msg->data.roster.count = count;
+            for (int i = 0; i < count; i++) {
+                msg->data.roster.players[i].player_id = get_u8(&r);
+                msg->data.roster.players[i].serial = (int)get_varint(&r);
+                int name_len = get_u8(&r);
+                if (name_len >= MAX_NAME_LENGTH) return false;//prilis dlhe meno
+                for (int j = 0; j < name_len; j++) {
+                    msg->data.roster.players[i].name[j] = (char)get_u8(&r);
                 }
-                offset += obstacle_size;
-            } else {
-                state->obstacles = NULL;//ziadne prekazky
+                msg->data.roster.players[i].name[name_len] = '\0';
             }
+            if (r.error) return false;
+            break;
+        }
             
-            if (size < offset + sizeof(int) * 2) return false;//over velkost
-            memcpy(&state->elapsed_time, buffer + offset, sizeof(int));//nacitaj uplynuly cas
-            offset += sizeof(int);
-            
-            memcpy(&state->time_limit, buffer + offset, sizeof(int));//nacitaj casovy limit
-            offset += sizeof(int);
-            
-            if (size < offset + sizeof(GameMode)) return false;//over velkost
-            memcpy(&state->mode, buffer + offset, sizeof(GameMode));//nacitaj mod hry
-            offset += sizeof(GameMode);
-            
-            if (size < offset + sizeof(bool)) return false;//over velkost
-            memcpy(&state->game_over, buffer + offset, sizeof(bool));//nacitaj ci je hra ukoncena
-            offset += sizeof(bool);
-            
-            if (size < offset + sizeof(int)) return false;//over velkost
-            memcpy(&state->max_players, buffer + offset, sizeof(int));//nacitaj max pocet hracov
+        case MSG_GAME_LIST: {//stranka zoznamu hier
+            ByteReader r = { buffer, size, offset, false };
+            msg->data.game_list.total = (int)get_varint(&r);
+            int count = get_u8(&r);
+            if (count > GAME_LIST_PAGE_SIZE) return false;
+            msg->data.game_list.count = count;
+            for (int i = 0; i < count; i++) {
+                GameSummary *game = &msg->data.game_list.games[i];
+                game->game_id = (int)get_varint(&r);
+                game->mode = get_u8(&r) == MODE_TIMED ? MODE_TIMED : MODE_STANDARD;
+                game->obstacles = get_u8(&r) != 0;
+                game->width = (int)get_varint(&r);
+                game->height = (int)get_varint(&r);
+                game->player_count = get_u8(&r);
+                game->max_players = get_u8(&r);
+                game->elapsed_time = (int)get_varint(&r);
+                game->time_limit = (int)get_varint(&r);
+            }
+            if (r.error) return false;
             break;
         }
             
-        case MSG_PLAYER_INPUT:
-            if (size < offset + sizeof(Direction)) return false;//over velkost
-            memcpy(&msg->data.direction, buffer + offset, sizeof(Direction));//nacitaj smer pohybu
+        case MSG_STATE_DELTA: {//len hlavicka, telo aplikuje apply_state_delta
+            ByteReader r = { buffer, size, offset, false };
+            msg->data.delta.tick = (int)get_varint(&r);//tick snapshotu
+            msg->data.delta.baseline_tick = (int)get_varint(&r);//tick baseline snapshotu
+            if (r.error) return false;
             break;
+        }
             
-        case MSG_ERROR:
-            if (size < offset + 256) return false;//over velkost
-            memcpy(msg->data.error_msg, buffer + offset, 256);//nacitaj chybovu spravu
+        case MSG_COMPRESSED://najprv decompress_message
+            return false;
+            
+        case MSG_MAP: {//rozbal bitmapu prekazok (volajuci uvolni obstacles)
+            ByteReader r = { buffer, size, offset, false };
+            msg->data.map.map_id = get_u32(&r);//ID mapy
+            msg->data.map.width = (int)get_varint(&r);//sirka mapy
+            msg->data.map.height = (int)get_varint(&r);//vyska mapy
+            if (r.error) return false;//over velkost
+            offset = r.offset;
+            
+            int width = msg->data.map.width;
+            int height = msg->data.map.height;
+            if (width <= 0 || height <= 0) return false;//neplatne rozmery
+            size_t cells = (size_t)width * (size_t)height;
+            if ((size - offset) * 8 < cells) return false;//over velkost (jeden bit na bunku)
+            
+            msg->data.map.obstacles = (uint8_t *)malloc(cells);//alokuj rozbalenu bitmapu
+            if (!msg->data.map.obstacles) return false;
+            for (size_t i = 0; i < cells; i++) {
+                msg->data.map.obstacles[i] = (buffer[offset + i / 8] >> (i % 8)) & 1;
+            }
             break;
+        }
             
         case MSG_PAUSE:
         case MSG_RESUME:
         case MSG_PLAYER_DISCONNECT:
         case MSG_GAME_OVER:
-        case MSG_LIST_GAMES:
+        case MSG_UDP_READY:
             // No additional data - tieto spravy nemaju ziadne dalsie data
             break;
     }
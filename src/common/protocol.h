@@ -4,6 +4,15 @@
  * 
  * Defines all message types, data structures, and serialization functions
  * for the Snake Game client-server protocol.
+ * 
+ * Wire schema: every message starts with u8 type and u8 player ID + 1.
+ * Fields follow in a fixed order as varints, u8 enums and flags, u64
+ * little-endian and length-prefixed strings, so the format does not depend
+ * on compiler or architecture. Simple messages are described by one field
+ * table in protocol.c; snapshots, map, roster and game list have their own
+ * encoders. Fields are only ever appended: a message that ends before a
+ * field leaves it zero, and a client and server agree on the protocol
+ * version in MSG_JOIN_GAME and MSG_JOINED.
  */
 
 #ifndef PROTOCOL_H
@@ -13,6 +22,18 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+/** Wire protocol version of this build */
+#define PROTOCOL_VERSION 1
+
+/** Oldest client protocol version the server accepts */
+#define PROTOCOL_MIN_VERSION 1
+
+/** Size of message header (u8 type, u8 player ID + 1) */
+#define MESSAGE_HEADER_SIZE 2
+
+/** Maximum serialized size of message encoded by serialize_message (longest is MSG_CREATE_GAME) */
+#define SMALL_MESSAGE_MAX_SIZE (MESSAGE_HEADER_SIZE + 320)
+
 /** Maximum number of players in a game */
 #define MAX_PLAYERS 8
 
@@ -22,6 +43,27 @@
 /** Maximum length of a snake */
 #define MAX_SNAKE_LENGTH 1000
 
+/** Maximum turns buffered per snake (one is applied per tick) */
+#define TURN_QUEUE_SIZE 3
+
+/** Number of recent snapshots kept for delta baselines (server and client) */
+#define STATE_HISTORY_SIZE 16
+
+/** Full keyframe is sent every N ticks regardless of acknowledgements */
+#define KEYFRAME_INTERVAL 50
+
+/** Game ID in MSG_JOIN_GAME that joins the oldest running game */
+#define ANY_GAME_ID 0
+
+/** Maximum number of games in one MSG_GAME_LIST page */
+#define GAME_LIST_PAGE_SIZE 16
+
+/** Maximum serialized size of MSG_GAME_LIST (header, total, count, then per game 5 varints and 4 bytes) */
+#define GAME_LIST_MESSAGE_MAX_SIZE (MESSAGE_HEADER_SIZE + 5 + 1 + GAME_LIST_PAGE_SIZE * (5 * 5 + 4))
+
+/** Maximum serialized size of MSG_ROSTER (header, count, then ID, serial varint, name per player) */
+#define ROSTER_MESSAGE_MAX_SIZE (MESSAGE_HEADER_SIZE + 1 + MAX_PLAYERS * (1 + 5 + 1 + MAX_NAME_LENGTH))
+
 /**
  * @brief Message types for client-server communication
  */
@@ -35,7 +77,17 @@ typedef enum {
     MSG_ERROR,               /**< Server sends error message */
     MSG_PAUSE,               /**< Client pauses game */
     MSG_RESUME,              /**< Client resumes game */
-    MSG_LIST_GAMES           /**< Client requests list of active games */
+    MSG_LIST_GAMES,          /**< Client requests list of active games */
+    MSG_STATE_DELTA,         /**< Server sends game state as delta to acknowledged snapshot */
+    MSG_STATE_ACK,           /**< Client acknowledges received snapshot tick */
+    MSG_MAP,                 /**< Server sends static obstacle map once at join */
+    MSG_ROSTER,              /**< Server sends player names (on every join) */
+    MSG_GAME_CREATED,        /**< Server replies to MSG_CREATE_GAME with ID of new game */
+    MSG_GAME_LIST,           /**< Server replies to MSG_LIST_GAMES with one page of games */
+    MSG_JOINED,              /**< Server confirms join with player slot and rejoin token */
+    MSG_UDP_HELLO,           /**< Client opens UDP snapshot channel (datagram, server echoes it) */
+    MSG_UDP_READY,           /**< Client received echo, server sends snapshots over UDP */
+    MSG_COMPRESSED           /**< Compressed message (see compress.h), unwrapped before deserialize */
 } MessageType;
 
 /**
@@ -87,18 +139,42 @@ typedef struct {
  * @brief Snake data structure
  */
 typedef struct {
-    Position positions[MAX_SNAKE_LENGTH];  /**< Snake body positions */
+    Position positions[MAX_SNAKE_LENGTH];  /**< Snake body ring buffer (use snake_segment) */
+    int head;                               /**< Index of head in positions */
     int length;                             /**< Current snake length */
     Direction direction;                    /**< Current direction */
-    Direction pending_direction;            /**< Next direction to apply */
+    Direction turns[TURN_QUEUE_SIZE];       /**< Buffered turns, oldest first (server only, not serialized) */
+    int turn_count;                         /**< Number of buffered turns */
     int player_id;                          /**< Player ID (0-7) */
     int score;                              /**< Player score */
     bool alive;                             /**< Is snake alive */
     bool paused;                            /**< Is snake paused */
     char name[MAX_NAME_LENGTH];             /**< Player name */
     int spawn_time;                         /**< Spawn time in seconds */
+    int serial;                             /**< Spawn serial (changes on every spawn) */
+    int steps;                              /**< Number of moves since spawn */
 } Snake;
 
+/**
+ * @brief Get snake body segment
+ * @param snake Snake
+ * @param index Segment index (0 = head, length - 1 = tail)
+ * @return Segment position
+ */
+static inline Position snake_segment(const Snake *snake, int index) {
+    return snake->positions[(snake->head + index) % MAX_SNAKE_LENGTH];
+}
+
+/**
+ * @brief Set snake body segment
+ * @param snake Snake
+ * @param index Segment index (0 = head, length - 1 = tail)
+ * @param pos New segment position
+ */
+static inline void set_snake_segment(Snake *snake, int index, Position pos) {
+    snake->positions[(snake->head + index) % MAX_SNAKE_LENGTH] = pos;
+}
+
 /**
  * @brief Game configuration
  */
@@ -111,6 +187,8 @@ typedef struct {
     char map_file[256];       /**< Map file path */
     bool load_from_file;      /**< Load map from file? */
     int max_players;          /**< Max players (1-8) */
+    int tick_rate;            /**< Ticks per second (0 = server default) */
+    uint64_t seed;            /**< Random seed (0 = derived from server seed) */
 } GameConfig;
 
 /**
@@ -120,48 +198,277 @@ typedef struct {
  */
 typedef struct {
     int game_id;                    /**< Unique game ID */
+    int tick;                       /**< Snapshot sequence (simulation tick) */
     Snake snakes[MAX_PLAYERS];      /**< All snakes in game */
     int player_count;               /**< Number of active players */
     Position food[MAX_PLAYERS];     /**< Food positions */
     int food_count;                 /**< Number of food items */
-    uint8_t *obstacles;             /**< Obstacle bitmap (width * height) */
+    uint8_t *obstacles;             /**< Obstacle bitmap (width * height), not serialized */
+    uint32_t map_id;                /**< Hash of obstacle map (sent once in MSG_MAP) */
     int width;                      /**< World width */
     int height;                     /**< World height */
     int elapsed_time;               /**< Elapsed time in seconds */
+    int64_t time_ms;                /**< Game time in milliseconds (tick * period), not serialized */
     int time_limit;                 /**< Time limit in seconds */
     GameMode mode;                  /**< Game mode */
     bool game_over;                 /**< Is game over */
     int max_players;                /**< Max allowed players */
 } GameState;
 
+/**
+ * @brief Snake fields a delta is encoded against (body is not copied)
+ */
+typedef struct {
+    int head;               /**< Index of head in positions */
+    int length;             /**< Snake length */
+    int steps;              /**< Number of moves since spawn */
+    int serial;             /**< Spawn serial */
+    int spawn_time;         /**< Spawn time in seconds */
+    int score;              /**< Player score */
+    Direction direction;    /**< Current direction */
+    bool alive;             /**< Is snake alive */
+    bool paused;            /**< Is snake paused */
+} SnakeBaseline;
+
+/**
+ * @brief Compact record of a broadcast snapshot (server side delta baseline)
+ *
+ * Holds everything except snake bodies, so keeping STATE_HISTORY_SIZE of
+ * them costs a few kilobytes instead of full GameState copies.
+ */
+typedef struct {
+    int tick;                           /**< Snapshot tick (-1 = empty slot) */
+    SnakeBaseline snakes[MAX_PLAYERS];  /**< Snake fields */
+    Position food[MAX_PLAYERS];         /**< Food positions */
+    int food_count;                     /**< Number of food items */
+} StateBaseline;
+
+/**
+ * @brief Lobby summary of one running game (MSG_GAME_LIST entry)
+ */
+typedef struct {
+    int game_id;            /**< Game ID */
+    GameMode mode;          /**< Game mode */
+    bool obstacles;         /**< World has obstacles */
+    int width;              /**< World width */
+    int height;             /**< World height */
+    int player_count;       /**< Connected players */
+    int max_players;        /**< Max allowed players */
+    int elapsed_time;       /**< Elapsed time in seconds */
+    int time_limit;         /**< Time limit in seconds (0 = unlimited) */
+} GameSummary;
+
 /**
  * @brief Message structure for client-server communication
  * 
- * Uses union for different message data types.
+ * Uses union for different message data types. Snapshots are not part of
+ * the union: only their headers are decoded here, bodies go straight into
+ * a GameState (deserialize_game_state, apply_state_delta), so a Message
+ * stays small enough for the stack.
  */
 typedef struct {
     MessageType type;   /**< Message type */
     int player_id;      /**< Sender player ID (-1 if not applicable) */
     union {
         GameConfig config;      /**< Game configuration (MSG_CREATE_GAME) */
-        GameState state;        /**< Game state (MSG_GAME_STATE) */
         Direction direction;    /**< Player input (MSG_PLAYER_INPUT) */
         char error_msg[256];    /**< Error message (MSG_ERROR) */
+        int tick;               /**< Acknowledged snapshot tick (MSG_STATE_ACK) */
+        int game_id;            /**< ID of created game (MSG_GAME_CREATED) */
+        int after_game_id;      /**< List games with greater ID (MSG_LIST_GAMES, 0 = first page) */
+        struct {
+            uint32_t map_id;                /**< Map hash referenced by snapshots */
+            int width;                      /**< Map width */
+            int height;                     /**< Map height */
+            uint8_t *obstacles;             /**< Unpacked bitmap (allocated, caller frees) */
+        } map;                  /**< Obstacle map (MSG_MAP) */
+        struct {
+            int count;                      /**< Number of entries */
+            struct {
+                int player_id;              /**< Player slot */
+                int serial;                 /**< Spawn serial the name belongs to */
+                char name[MAX_NAME_LENGTH]; /**< Player name */
+            } players[MAX_PLAYERS];
+        } roster;               /**< Player names (MSG_ROSTER) */
+        struct {
+            int total;                              /**< Number of running games */
+            int count;                              /**< Games in this page */
+            GameSummary games[GAME_LIST_PAGE_SIZE]; /**< Games sorted by ID */
+        } game_list;            /**< One page of running games (MSG_GAME_LIST) */
         struct {
-            int port;                       /**< Server port */
+            int game_id;                    /**< Game of snapshot */
+            int tick;                       /**< Snapshot tick */
+        } keyframe;             /**< Keyframe header (MSG_GAME_STATE), body via deserialize_game_state */
+        struct {
+            int tick;                       /**< Snapshot tick */
+            int baseline_tick;              /**< Tick of baseline snapshot */
+        } delta;                /**< Delta header (MSG_STATE_DELTA), body via apply_state_delta */
+        struct {
+            uint32_t version;               /**< Protocol version of the client (PROTOCOL_VERSION) */
+            int game_id;                    /**< Game to join (ANY_GAME_ID = oldest running game) */
             char name[MAX_NAME_LENGTH];     /**< Player name */
+            uint64_t rejoin_token;          /**< Token of slot to take back after server restart (0 = new player) */
+            uint32_t codecs;                /**< Codecs the client decodes (CODEC_MASK bits, compress.h) */
         } join_info;            /**< Join info (MSG_JOIN_GAME) */
+        struct {
+            int game_id;                    /**< Joined game */
+            uint64_t rejoin_token;          /**< Token that takes the slot back after a server restart */
+            uint32_t version;               /**< Protocol version of the server (both use the lower one) */
+        } joined;               /**< Join confirmation (MSG_JOINED, slot in player_id), also MSG_UDP_HELLO */
     } data;
 } Message;
 
+/**
+ * @brief Write message header
+ * @param buffer Output buffer (at least MESSAGE_HEADER_SIZE bytes)
+ * @param type Message type
+ * @param player_id Player ID (-1 if not applicable)
+ * @return MESSAGE_HEADER_SIZE
+ */
+size_t write_message_header(uint8_t *buffer, MessageType type, int player_id);
+
+/**
+ * @brief Read message header
+ * @param buffer Serialized message
+ * @param size Message size in bytes
+ * @param type Output message type
+ * @param player_id Output player ID
+ * @return false if message is shorter than header or type is unknown
+ */
+bool read_message_header(const uint8_t *buffer, size_t size, MessageType *type, int *player_id);
+
+/**
+ * @brief Get serialized size of message
+ * @param msg Message encoded by serialize_message
+ * @return Size in bytes (at most SMALL_MESSAGE_MAX_SIZE)
+ */
+size_t message_size(const Message *msg);
+
 /**
  * @brief Serialize message to binary format
- * @param msg Message to serialize
- * @param buffer Output buffer
+ * @param msg Message to serialize (not MSG_GAME_STATE, MSG_STATE_DELTA, MSG_MAP,
+ *            MSG_ROSTER and MSG_GAME_LIST, which have own serializers)
+ * @param buffer Output buffer (message_size bytes, SMALL_MESSAGE_MAX_SIZE is enough)
  * @param size Output size in bytes
  */
 void serialize_message(const Message *msg, uint8_t *buffer, size_t *size);
 
+/**
+ * @brief Compute map ID (FNV-1a hash of little-endian dimensions and obstacles)
+ * @param obstacles Obstacle bitmap (may be NULL for empty map)
+ * @param width Map width
+ * @param height Map height
+ * @return Map ID
+ */
+uint32_t compute_map_id(const uint8_t *obstacles, int width, int height);
+
+/**
+ * @brief Get serialized size of MSG_MAP message
+ * @param width Map width
+ * @param height Map height
+ * @return Size in bytes
+ */
+size_t map_message_size(int width, int height);
+
+/**
+ * @brief Serialize MSG_MAP message (one bit per cell)
+ * @param state Game state with obstacles, dimensions and map ID
+ * @param buffer Output buffer (at least map_message_size bytes)
+ * @param size Output size in bytes
+ */
+void serialize_map(const GameState *state, uint8_t *buffer, size_t *size);
+
+/**
+ * @brief Serialize MSG_ROSTER message (names of all spawned players)
+ * @param state Game state
+ * @param buffer Output buffer
+ * @param capacity Output buffer capacity (ROSTER_MESSAGE_MAX_SIZE is enough)
+ * @return Size in bytes, 0 on overflow
+ * 
+ * Names are not part of snapshots; clients match roster entries to snakes
+ * by player ID and spawn serial.
+ */
+size_t serialize_roster(const GameState *state, uint8_t *buffer, size_t capacity);
+
+/**
+ * @brief Serialize MSG_GAME_LIST message (one page of lobby)
+ * @param total Number of running games
+ * @param games Games in page
+ * @param count Number of games in page (at most GAME_LIST_PAGE_SIZE)
+ * @param buffer Output buffer
+ * @param capacity Output buffer capacity (GAME_LIST_MESSAGE_MAX_SIZE is enough)
+ * @return Size in bytes, 0 on overflow
+ */
+size_t serialize_game_list(int total, const GameSummary *games, int count, uint8_t *buffer, size_t capacity);
+
+/**
+ * @brief Get upper bound of serialized MSG_GAME_STATE message size
+ * @param state Game state
+ * @return Size in bytes (proportional to snake lengths)
+ */
+size_t game_state_message_size(const GameState *state);
+
+/**
+ * @brief Serialize MSG_GAME_STATE message directly from game state
+ * @param state Game state to serialize
+ * @param buffer Output buffer (at least game_state_message_size bytes)
+ * @param size Output size in bytes
+ * 
+ * Obstacles are referenced only by map_id, names are sent in MSG_ROSTER.
+ * Snake bodies are encoded as head, 2-bit steps toward the tail (wrap-aware)
+ * and a count of trailing duplicates, falling back to raw coordinates.
+ */
+void serialize_game_state(const GameState *state, uint8_t *buffer, size_t *size);
+
+/**
+ * @brief Deserialize MSG_GAME_STATE message into game state
+ * @param buffer Serialized MSG_GAME_STATE message
+ * @param size Message size in bytes
+ * @param state Output state (obstacles are NULL, names empty)
+ * @return true if successful, false if message is malformed
+ */
+bool deserialize_game_state(const uint8_t *buffer, size_t size, GameState *state);
+
+/**
+ * @brief Record the fields of a broadcast state that deltas are encoded against
+ * @param state Game state being broadcast
+ * @param baseline Output record
+ */
+void capture_state_baseline(const GameState *state, StateBaseline *baseline);
+
+/**
+ * @brief Serialize MSG_STATE_DELTA message
+ * @param baseline Record of snapshot acknowledged by the client
+ * @param state Current game state (the one the baseline was captured from, moved on)
+ * @param buffer Output buffer
+ * @param capacity Output buffer capacity
+ * @return Size in bytes, 0 if delta does not fit (send keyframe instead)
+ * 
+ * Encodes per-snake head-added/tail-removed/grew changes, score and
+ * flag changes and food changes. Static fields (map, mode, limits)
+ * are taken from the baseline by the receiver.
+ *
+ * Baseline bodies are read from the live ring buffers: a snake only writes
+ * new heads in front of its head and tail duplicates behind its tail, so
+ * the segments behind the new heads up to the trailing duplicates are
+ * still the baseline body. A snake whose ring no longer lines up with the
+ * baseline head (other spawn, restored state) is sent whole.
+ */
+size_t serialize_state_delta(const StateBaseline *baseline, const GameState *state,
+                             uint8_t *buffer, size_t capacity);
+
+/**
+ * @brief Apply MSG_STATE_DELTA message to baseline snapshot
+ * @param buffer Serialized MSG_STATE_DELTA message
+ * @param size Message size in bytes
+ * @param baseline Snapshot with tick equal to delta baseline tick
+ * @param state Output state (may not alias baseline)
+ * @return true if successful, false if message is malformed
+ * 
+ * Obstacles pointer and map ID are copied from baseline.
+ */
+bool apply_state_delta(const uint8_t *buffer, size_t size, const GameState *baseline, GameState *state);
+
 /**
  * @brief Deserialize message from binary format
  * @param buffer Input buffer
@@ -0,0 +1,283 @@
+#include "protocol.h"
+#include "game_logic.h"
+#include "replay_log.h"
+#include "ui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MIN_SPEED 0.125     // najpomalsie prehravanie
+#define MAX_SPEED 64.0      // najrychlejsie prehravanie
+#define SEEK_STEP_SECONDS 10 // skok sipkami (herny cas)
+
+typedef struct {//nastavenie prehravania
+    bool view;          // zobrazuj v ncurses
+    double speed;       // nasobok realnej rychlosti
+    bool paused;        // prehravanie zastavene
+    bool quit;          // pouzivatel ukoncil prehravanie
+    int seek_tick;      // pozadovany skok na tick (-1 = ziadny)
+    int show_from;      // tiky pred tymto sa nezobrazuju (pretacanie)
+} Playback;
+
+typedef enum {//vysledok skoku
+    SEEK_FAILED,        // hru sa nepodarilo obnovit
+    SEEK_CONTINUE,      // ciel je blizko dopredu, pokracuje sa v citani
+    SEEK_RESTORED       // hra aj citanie zaznamu su na novom mieste
+} SeekResult;
+
+static double now_seconds(void) {//monotonny cas v sekundach
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void handle_keys(Playback *playback, const Game *game) {//q koniec, medzera pauza, +/- rychlost, sipky skok
+    int step = SEEK_STEP_SECONDS * game->tick_rate;
+    int ch;
+    while ((ch = getch()) != ERR) {
+        if (ch == 'q' || ch == 'Q') {
+            playback->quit = true;
+        } else if (ch == ' ' || ch == 'p' || ch == 'P') {
+            playback->paused = !playback->paused;
+        } else if ((ch == '+' || ch == '=') && playback->speed < MAX_SPEED) {
+            playback->speed *= 2;
+        } else if (ch == '-' && playback->speed > MIN_SPEED) {
+            playback->speed /= 2;
+        } else if (ch == KEY_LEFT) {
+            int from = playback->seek_tick >= 0 ? playback->seek_tick : game->state.tick;
+            playback->seek_tick = from > step ? from - step : 0;
+        } else if (ch == KEY_RIGHT) {
+            int from = playback->seek_tick >= 0 ? playback->seek_tick : game->state.tick;
+            playback->seek_tick = from + step;
+        }
+    }
+}
+
+static void show_frame(Game *game, Playback *playback) {//vykresli tick a pocka podla rychlosti prehravania
+    render_game_state(&game->state, -1, "replay", game->state.game_id);
+    mvprintw(0, 2, "Replay tick %d  speed %gx%s - 'q' quit, space pause, +/- speed, arrows seek        ",
+             game->state.tick, playback->speed, playback->paused ? " [PAUSED]" : "");
+    refresh();
+
+    double frame_end = now_seconds() + 1.0 / (game->tick_rate * playback->speed);
+    do {
+        handle_keys(playback, game);
+        usleep(5000);
+    } while (!playback->quit && playback->seek_tick < 0 && (playback->paused || now_seconds() < frame_end));
+}
+
+static void advance_to(Game *game, int tick, Playback *playback) {//odsimuluje tiky az po dany tick
+    while (game->state.tick < tick && !game->state.game_over && !playback->quit && playback->seek_tick < 0) {
+        update_game(game);//rovnaka logika ako na serveri
+        if (playback->view && game->state.tick >= playback->show_from) {
+            show_frame(game, playback);
+        }
+    }
+}
+
+static Game *start_game(const ReplayReader *reader) {//hra v stave pred prvym zaznamom
+    Game *game = create_game(&reader->config);//rovnaka konfiguracia a seed ako nahrana hra
+    if (!game) {
+        fprintf(stderr, "Failed to create game\n");
+        return NULL;
+    }
+    if (game->state.map_id != reader->map_id) {//mapa zo suboru sa zmenila
+        fprintf(stderr, "Map differs from recorded game (%08x, recorded %08x)\n", game->state.map_id, reader->map_id);
+        release_game(game);
+        return NULL;
+    }
+    return game;
+}
+
+static SeekResult seek_to(Game **game, ReplayReader *reader, int tick, Playback *playback) {//skok na tick: najblizsi keyframe + resimulacia
+    playback->show_from = tick;
+    int current = (*game)->state.tick;
+    if (tick >= current && tick - current < REPLAY_KEYFRAME_INTERVAL) {//blizko dopredu - staci dosimulovat
+        return SEEK_CONTINUE;
+    }
+    
+    ReplayRecord keyframe;
+    if (seek_replay(reader, tick, &keyframe)) {
+        ReplayReader payload;
+        open_keyframe(reader, &keyframe, &payload);
+        if (restore_keyframe(*game, &payload) && hash_game_state(&(*game)->state) == keyframe.state_hash) {
+            return SEEK_RESTORED;
+        }
+        fprintf(stderr, "Keyframe at tick %d is corrupt, re-simulating from start\n", keyframe.tick);
+    } else if (tick >= current) {//pred prvym keyframom, ale dopredu
+        return SEEK_CONTINUE;
+    }
+    
+    rewind_replay(reader);//od zaciatku hry
+    release_game(*game);
+    *game = start_game(reader);
+    return *game ? SEEK_RESTORED : SEEK_FAILED;
+}
+
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s [-v] [-s speed] [-t tick] replay_file\n", program);
+    fprintf(stderr, "  -v        play back in the game view (default: re-simulate and verify)\n");
+    fprintf(stderr, "  -s speed  playback speed multiplier for -v (default 1)\n");
+    fprintf(stderr, "  -t tick   start at tick (restored from the nearest keyframe)\n");
+}
+
+int main(int argc, char *argv[]) {
+    Playback playback = { false, 1.0, false, false, -1, 0 };
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {//spracuj argumenty
+        if (strcmp(argv[i], "-v") == 0) {
+            playback.view = true;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            playback.speed = atof(argv[i + 1]);
+            if (playback.speed < MIN_SPEED) playback.speed = MIN_SPEED;
+            if (playback.speed > MAX_SPEED) playback.speed = MAX_SPEED;
+            i++;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            playback.seek_tick = atoi(argv[i + 1]);
+            if (playback.seek_tick < 0) playback.seek_tick = 0;
+            i++;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    ReplayReader reader;
+    if (!open_replay_reader(&reader, path)) {
+        fprintf(stderr, "Cannot read replay %s\n", path);
+        return 1;
+    }
+
+    Game *game = start_game(&reader);
+    if (!game) {
+        close_replay_reader(&reader);
+        return 1;
+    }
+
+    double start = now_seconds();
+    if (playback.seek_tick >= 0) {//-t: zacni od keyframu (resimuluje sa len zvysok)
+        int tick = playback.seek_tick;
+        playback.seek_tick = -1;
+        if (seek_to(&game, &reader, tick, &playback) == SEEK_FAILED) {
+            close_replay_reader(&reader);
+            return 1;
+        }
+    }
+
+    if (playback.view) {
+        init_ui();
+    }
+
+    int start_tick = game->state.tick;
+    int joins = 0;
+    int commands = 0;
+    bool desync = false;
+    bool ended = false;
+    uint32_t recorded_hash = 0;
+    ReplayRecord record;
+    bool pending = false;//zaznam je nacitany, ale este nevykonany
+    while (!desync && !playback.quit) {
+        if (playback.seek_tick >= 0) {//skok sipkami
+            int tick = playback.seek_tick;
+            playback.seek_tick = -1;
+            SeekResult result = seek_to(&game, &reader, tick, &playback);
+            if (result == SEEK_FAILED) {
+                break;
+            }
+            if (result == SEEK_RESTORED) {//nacitany zaznam patri k starej pozicii
+                pending = false;
+            }
+            continue;
+        }
+        if (!pending && !next_replay_record(&reader, &record)) {//udalosti v poradi, v akom ich hra vykonala
+            break;
+        }
+        pending = true;
+        advance_to(game, record.tick, &playback);
+        if (playback.seek_tick >= 0) {//skok pocas prehravania
+            continue;
+        }
+        pending = false;
+        if (game->state.tick != record.tick) {//hra skoncila skor nez v zazname
+            desync = !playback.quit;
+            break;
+        }
+        switch (record.type) {
+            case REPLAY_JOIN:
+                if (add_player(game, -1, record.name) != record.player_id) {//slot sa musi zhodovat
+                    desync = true;
+                }
+                joins++;
+                break;
+            case REPLAY_LEAVE:
+                remove_player(game, record.player_id);
+                break;
+            case REPLAY_COMMAND:
+                push_command(&game->commands, &record.command);//hra ho vykona na zaciatku dalsieho tiku
+                commands++;
+                break;
+            case REPLAY_END:
+                recorded_hash = record.state_hash;
+                ended = true;
+                break;
+            case REPLAY_KEYFRAME:
+                if (hash_game_state(&game->state) != record.state_hash) {//odchylka sa zisti najneskor o interval
+                    desync = true;
+                }
+                break;
+        }
+    }
+    if (!game) {//skok na zaciatok zlyhal
+        if (playback.view) {
+            cleanup_ui();
+        }
+        close_replay_reader(&reader);
+        return 1;
+    }
+    double elapsed = now_seconds() - start;
+
+    if (playback.view) {
+        if (!playback.quit && ended) {//nechaj posledny stav na obrazovke
+            render_game_state(&game->state, -1, "replay", game->state.game_id);
+            mvprintw(0, 2, "Replay finished at tick %d - press any key                     ", game->state.tick);
+            refresh();
+            nodelay(stdscr, FALSE);
+            getch();
+        }
+        cleanup_ui();
+    }
+
+    int status = 0;
+    if (reader.error) {
+        fprintf(stderr, "Replay file is truncated or corrupt\n");
+        status = 1;
+    } else if (desync) {
+        fprintf(stderr, "Replay diverged at tick %d\n", game->state.tick);
+        status = 1;
+    } else if (!ended) {
+        if (!playback.quit) {
+            printf("Replay has no end record (game still running or server crashed), simulated %d ticks\n", game->state.tick);
+        }
+    } else {
+        uint32_t hash = hash_game_state(&game->state);
+        int ticks = game->state.tick - start_tick;
+        printf("Replayed %d ticks from tick %d (%d joins, %d commands) in %.3f s (%.0f ticks/s), final state %s\n",
+               ticks, start_tick, joins, commands, elapsed, elapsed > 0 ? ticks / elapsed : 0.0,
+               hash == recorded_hash ? "matches" : "DIFFERS");
+        if (hash != recorded_hash) {
+            status = 1;
+        }
+    }
+
+    release_game(game);
+    close_replay_reader(&reader);
+    return status;
+}
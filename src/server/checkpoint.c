@@ -0,0 +1,290 @@
+#include "checkpoint.h"
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_MAP_CELLS (1 << 20)     // najvacsia obnovitelna mapa (ochrana pred poskodenym suborom)
+
+struct Checkpointer {//vlakno zapisujuce checkpointy
+    GameRegistry *registry;         // hry, ktore sa ukladaju
+    char dir[1024];                 // adresar checkpointov
+    pthread_mutex_t mutex;          // chrani stopping
+    pthread_cond_t cond;            // prebudi vlakno pri zastaveni
+    bool stopping;                  // posledne kolo a koniec
+    pthread_t thread;               // vlakno checkpointov
+    ReplayBuffer buffer;            // kodovany checkpoint (znovu pouzity)
+    Game *games[MAX_GAMES];         // beziace hry v aktualnom kole
+    int written[MAX_GAMES];         // ID hier, ktore maju subor (zoradene)
+    int written_count;              // pocet ID vo written
+};
+
+static uint32_t hash_bytes(const uint8_t *data, size_t size) {//FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void checkpoint_path(char *path, size_t size, const char *dir, int game_id, const char *suffix) {//cesta k suboru checkpointu
+    snprintf(path, size, "%s/game-%d.ckpt%s", dir, game_id, suffix);
+}
+
+bool encode_game_checkpoint(ReplayBuffer *out, Game *game) {//zakoduje cely subor checkpointu, false ak hra skoncila
+    const GameState *state = &game->state;//mapa a konfiguracia sa po vytvoreni nemenia
+    out->size = 0;
+    out->failed = false;
+    for (int i = 0; i < 4; i++) {
+        replay_put_u8(out, (uint8_t)CHECKPOINT_MAGIC[i]);
+    }
+    replay_put_u8(out, CHECKPOINT_VERSION);
+    replay_put_varint(out, (uint32_t)state->game_id);
+    replay_put_config(out, &game->config);
+    replay_put_varint(out, (uint32_t)state->width);
+    replay_put_varint(out, (uint32_t)state->height);
+    int cells = state->width * state->height;
+    for (int i = 0; i < cells; i += 8) {//prekazky po bitoch
+        uint8_t bits = 0;
+        for (int j = 0; j < 8 && i + j < cells; j++) {
+            if (state->obstacles && state->obstacles[i + j]) {
+                bits |= (uint8_t)(1 << j);
+            }
+        }
+        replay_put_u8(out, bits);
+    }
+    if (!encode_checkpoint(game, out)) {
+        return false;
+    }
+    replay_put_u32(out, hash_bytes(out->data, out->size));
+    return true;
+}
+
+static void write_checkpoint(Checkpointer *checkpointer, int game_id) {//zapise buffer cez docasny subor a premenovanie
+    char path[1100];
+    char temp[1100];
+    checkpoint_path(path, sizeof(path), checkpointer->dir, game_id, "");
+    checkpoint_path(temp, sizeof(temp), checkpointer->dir, game_id, ".tmp");
+
+    const ReplayBuffer *buffer = &checkpointer->buffer;
+    FILE *file = buffer->failed ? NULL : fopen(temp, "wb");
+    bool ok = file != NULL;
+    if (file) {
+        ok = fwrite(buffer->data, 1, buffer->size, file) == buffer->size && fflush(file) == 0 &&
+             fsync(fileno(file)) == 0;//po premenovani musi byt obsah na disku
+        ok = fclose(file) == 0 && ok;
+    }
+    if (ok && rename(temp, path) == 0) {//atomicka vymena - stary checkpoint plati az do tejto chvile
+        return;
+    }
+    fprintf(stderr, "Cannot write checkpoint %s\n", path);//stary checkpoint ostava
+    unlink(temp);
+}
+
+static void checkpoint_round(Checkpointer *checkpointer) {//ulozi vsetky beziace hry a zmaze checkpointy skoncenych
+    int count = acquire_running_games(checkpointer->registry, checkpointer->games, MAX_GAMES);
+    int current[MAX_GAMES];//ID ulozenych hier v tomto kole (zoradene ako hry)
+    int current_count = 0;
+    for (int i = 0; i < count; i++) {
+        Game *game = checkpointer->games[i];
+        if (encode_game_checkpoint(&checkpointer->buffer, game)) {//kodovanie drzi mutex hry len kratko, zapis uz nie
+            write_checkpoint(checkpointer, game->state.game_id);
+            current[current_count++] = game->state.game_id;
+        }
+        release_game(game);
+    }
+
+    int j = 0;
+    for (int i = 0; i < checkpointer->written_count; i++) {//hry, ktore skoncili, sa po restarte neobnovia
+        int game_id = checkpointer->written[i];
+        while (j < current_count && current[j] < game_id) {
+            j++;
+        }
+        if (j == current_count || current[j] != game_id) {
+            char path[1100];
+            checkpoint_path(path, sizeof(path), checkpointer->dir, game_id, "");
+            unlink(path);
+        }
+    }
+    memcpy(checkpointer->written, current, current_count * sizeof(int));
+    checkpointer->written_count = current_count;
+}
+
+static void *checkpoint_thread(void *arg) {//periodicky uklada hry (mimo tick vlakien)
+    Checkpointer *checkpointer = arg;
+    pthread_mutex_lock(&checkpointer->mutex);
+    while (!checkpointer->stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += CHECKPOINT_INTERVAL_MS / 1000;
+        deadline.tv_nsec += (CHECKPOINT_INTERVAL_MS % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&checkpointer->cond, &checkpointer->mutex, &deadline);
+        pthread_mutex_unlock(&checkpointer->mutex);
+        checkpoint_round(checkpointer);//aj pri zastaveni - posledny stav hier
+        pthread_mutex_lock(&checkpointer->mutex);
+    }
+    pthread_mutex_unlock(&checkpointer->mutex);
+    return NULL;
+}
+
+Checkpointer *start_checkpoints(GameRegistry *registry, const char *dir) {//vytvori adresar a spusti vlakno checkpointov
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        return NULL;
+    }
+    Checkpointer *checkpointer = calloc(1, sizeof(Checkpointer));
+    if (!checkpointer) {
+        return NULL;
+    }
+    checkpointer->registry = registry;
+    snprintf(checkpointer->dir, sizeof(checkpointer->dir), "%s", dir);
+    pthread_mutex_init(&checkpointer->mutex, NULL);
+    pthread_cond_init(&checkpointer->cond, NULL);
+    if (pthread_create(&checkpointer->thread, NULL, checkpoint_thread, checkpointer) != 0) {
+        pthread_mutex_destroy(&checkpointer->mutex);
+        pthread_cond_destroy(&checkpointer->cond);
+        free(checkpointer);
+        return NULL;
+    }
+    return checkpointer;
+}
+
+void stop_checkpoints(Checkpointer *checkpointer) {//posledne kolo checkpointov a zastavenie vlakna
+    if (!checkpointer) {
+        return;
+    }
+    pthread_mutex_lock(&checkpointer->mutex);
+    checkpointer->stopping = true;
+    pthread_cond_signal(&checkpointer->cond);
+    pthread_mutex_unlock(&checkpointer->mutex);
+    pthread_join(checkpointer->thread, NULL);
+
+    pthread_mutex_destroy(&checkpointer->mutex);
+    pthread_cond_destroy(&checkpointer->cond);
+    free_replay_buffer(&checkpointer->buffer);
+    free(checkpointer);
+}
+
+static uint8_t *read_file(const char *path, size_t *size) {//nacita cely subor do pamate
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    uint8_t *data = NULL;
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)length);
+        if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    *size = length > 0 ? (size_t)length : 0;
+    return data;
+}
+
+Game *decode_game_checkpoint(const uint8_t *data, size_t size, bool live) {//obnovi hru zo suboru checkpointu, NULL ak je poskodeny
+    if (size < 4) {
+        return NULL;
+    }
+    ReplayReader reader;
+    memset(&reader, 0, sizeof(reader));
+    reader.data = data;
+    reader.size = size;
+    reader.offset = size - 4;//hash na konci
+    if (replay_get_u32(&reader) != hash_bytes(data, size - 4)) {
+        return NULL;
+    }
+    reader.size = size - 4;
+    reader.offset = 0;
+
+    char magic[4];
+    for (int i = 0; i < 4; i++) {
+        magic[i] = (char)replay_get_u8(&reader);
+    }
+    if (memcmp(magic, CHECKPOINT_MAGIC, 4) != 0 || replay_get_u8(&reader) != CHECKPOINT_VERSION) {
+        return NULL;
+    }
+    int game_id = (int)replay_get_varint(&reader);
+    GameConfig config;
+    replay_get_config(&reader, &config);
+    int width = (int)replay_get_varint(&reader);
+    int height = (int)replay_get_varint(&reader);
+    if (reader.error || game_id < FIRST_GAME_ID || width <= 0 || height <= 0 ||
+        (int64_t)width * height > MAX_MAP_CELLS) {
+        return NULL;
+    }
+
+    int cells = width * height;
+    uint8_t *obstacles = calloc((size_t)cells, sizeof(uint8_t));
+    if (!obstacles) {
+        return NULL;
+    }
+    for (int i = 0; i < cells; i += 8) {
+        uint8_t bits = replay_get_u8(&reader);
+        for (int j = 0; j < 8 && i + j < cells; j++) {
+            obstacles[i + j] = (bits >> j) & 1;
+        }
+    }
+
+    Game *game = create_game_with_map(&config, obstacles, width, height);//mapa patri hre
+    if (!game) {
+        return NULL;
+    }
+    game->state.game_id = game_id;
+    if (!restore_checkpoint(game, &reader, live) || reader.offset != reader.size) {
+        release_game(game);
+        return NULL;
+    }
+    return game;
+}
+
+int restore_checkpoints(GameRegistry *registry, const char *dir) {//obnovi hry zo vsetkych checkpointov v adresari
+    DIR *directory = opendir(dir);
+    if (!directory) {//zatial ziadne checkpointy
+        return 0;
+    }
+
+    int restored = 0;
+    struct dirent *entry;
+    while ((entry = readdir(directory)) != NULL) {
+        int game_id;
+        int length = 0;
+        if (sscanf(entry->d_name, "game-%d.ckpt%n", &game_id, &length) != 1 ||
+            entry->d_name[length] != '\0' || length == 0) {//iny subor (aj nedopisany .tmp)
+            continue;
+        }
+
+        char path[1100];
+        checkpoint_path(path, sizeof(path), dir, game_id, "");
+        size_t size;
+        uint8_t *data = read_file(path, &size);
+        Game *game = data ? decode_game_checkpoint(data, size, false) : NULL;
+        free(data);
+        if (!game || game->state.game_id != game_id) {
+            fprintf(stderr, "Checkpoint %s is corrupt, skipped\n", path);
+            release_game(game);
+            continue;
+        }
+
+        int players = game->state.player_count;
+        int tick = game->state.tick;
+        if (restore_game(registry, game)) {//referencia patri registru
+            printf("Game %d restored at tick %d (%d players may rejoin)\n", game_id, tick, players);
+            restored++;
+        } else {
+            fprintf(stderr, "Cannot restore game %d\n", game_id);
+        }
+    }
+    closedir(directory);
+    return restored;
+}
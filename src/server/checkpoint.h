@@ -0,0 +1,82 @@
+/**
+ * @file checkpoint.h
+ * @brief Periodic checkpoints of running games and their restore at startup
+ *
+ * A checkpoint thread encodes every running game once per
+ * CHECKPOINT_INTERVAL_MS (briefly under the game mutex, into memory) and
+ * writes it to dir/game-<id>.ckpt through a temporary file and rename, so
+ * the file on disk is always a complete checkpoint. Checkpoints of games
+ * that have ended are deleted. After a crash or restart the server
+ * registers the saved games under their old IDs; their players rejoin
+ * with the token from MSG_JOINED within REJOIN_TIMEOUT_MS.
+ *
+ * File layout: "SNKC", version, varint game ID, game configuration,
+ * map (varint width and height, obstacle bitmap with one bit per cell),
+ * checkpoint of the game (encode_checkpoint) and a u32 FNV-1a hash of
+ * all preceding bytes.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "game_registry.h"
+
+/** File magic */
+#define CHECKPOINT_MAGIC "SNKC"
+
+/** Format version */
+#define CHECKPOINT_VERSION 1
+
+/** Wall time between checkpoints of a game (ms) */
+#define CHECKPOINT_INTERVAL_MS 1000
+
+/**
+ * @brief Opaque checkpoint writer
+ */
+typedef struct Checkpointer Checkpointer;
+
+/**
+ * @brief Create checkpoint directory and start checkpoint thread
+ * @param registry Games to checkpoint
+ * @param dir Checkpoint directory (created if missing)
+ * @return Checkpointer, or NULL if the directory or thread cannot be created
+ */
+Checkpointer *start_checkpoints(GameRegistry *registry, const char *dir);
+
+/**
+ * @brief Write last checkpoint of all running games and stop thread
+ * @param checkpointer Checkpointer (may be NULL)
+ *
+ * Called before connections are closed, so a restarted server gives
+ * every player their slot back.
+ */
+void stop_checkpoints(Checkpointer *checkpointer);
+
+/**
+ * @brief Encode checkpoint of game in file layout
+ * @param out Buffer (cleared first)
+ * @param game Running game
+ * @return true on success, false if the game is over
+ */
+bool encode_game_checkpoint(ReplayBuffer *out, Game *game);
+
+/**
+ * @brief Create game from checkpoint in file layout
+ * @param data Checkpoint
+ * @param size Size of checkpoint
+ * @param live Connections are handed over too (see restore_checkpoint)
+ * @return Game with refcount 1 (not registered), NULL if checkpoint is corrupt
+ */
+Game *decode_game_checkpoint(const uint8_t *data, size_t size, bool live);
+
+/**
+ * @brief Restore and start all games checkpointed in directory
+ * @param registry Registry to register games in
+ * @param dir Checkpoint directory
+ * @return Number of restored games
+ *
+ * Corrupt checkpoints are reported and skipped.
+ */
+int restore_checkpoints(GameRegistry *registry, const char *dir);
+
+#endif // CHECKPOINT_H
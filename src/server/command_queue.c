@@ -0,0 +1,47 @@
+#include "command_queue.h"
+#include <stdint.h>
+
+#define COMMAND_QUEUE_MASK (COMMAND_QUEUE_CAPACITY - 1)
+
+void init_command_queue(CommandQueue *queue) {//prazdna fronta, kazdy slot caka na svoju poziciu
+    for (size_t i = 0; i < COMMAND_QUEUE_CAPACITY; i++) {
+        atomic_init(&queue->slots[i].sequence, i);
+    }
+    atomic_init(&queue->tail, 0);
+    queue->head = 0;
+}
+
+bool push_command(CommandQueue *queue, const PlayerCommand *command) {//prida prikaz bez zamku (viac producentov)
+    size_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    CommandSlot *slot;
+    for (;;) {
+        slot = &queue->slots[pos & COMMAND_QUEUE_MASK];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {//slot je volny - skus si ho zabrat
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {//konzument este neprecital prikaz spred celej otocky - plna fronta
+            return false;
+        } else {//iny producent nas predbehol
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
+    slot->command = *command;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);//zverejni prikaz konzumentovi
+    return true;
+}
+
+bool pop_command(CommandQueue *queue, PlayerCommand *command) {//vyberie najstarsi prikaz (jeden konzument)
+    CommandSlot *slot = &queue->slots[queue->head & COMMAND_QUEUE_MASK];
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != queue->head + 1) {//prazdna fronta (alebo producent este zapisuje)
+        return false;
+    }
+    *command = slot->command;
+    atomic_store_explicit(&slot->sequence, queue->head + COMMAND_QUEUE_CAPACITY, memory_order_release);//slot pre dalsiu otocku
+    queue->head++;
+    return true;
+}
@@ -0,0 +1,88 @@
+/**
+ * @file command_queue.h
+ * @brief Lock-free multi-producer/single-consumer queue of player commands
+ *
+ * Network threads push direction changes, pauses and resumes without taking
+ * the game mutex, so handling a client message never waits for a running
+ * tick. The tick drains the queue at its start and applies the commands
+ * while it owns the game state. Bounded ring with a sequence number per slot:
+ * producers claim a slot with compare-and-swap on the tail and publish it by
+ * bumping the slot sequence; the single consumer needs no atomic
+ * read-modify-write at all.
+ */
+
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include "protocol.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Queue capacity (power of two) */
+#define COMMAND_QUEUE_CAPACITY 256
+
+/**
+ * @brief Kind of player command
+ */
+typedef enum {
+    COMMAND_DIRECTION,  /**< Change snake direction */
+    COMMAND_PAUSE,      /**< Pause snake */
+    COMMAND_RESUME      /**< Start resume countdown */
+} CommandType;
+
+/**
+ * @brief Command sent by player to the simulation
+ */
+typedef struct {
+    CommandType type;       /**< Command kind */
+    int player_id;          /**< Player the command belongs to */
+    Direction direction;    /**< New direction (COMMAND_DIRECTION) */
+} PlayerCommand;
+
+/**
+ * @brief Slot of command ring
+ *
+ * sequence == position: free for the producer claiming that position,
+ * sequence == position + 1: holds a command ready for the consumer.
+ */
+typedef struct {
+    atomic_size_t sequence;     /**< Slot state (see above) */
+    PlayerCommand command;      /**< Stored command */
+} CommandSlot;
+
+/**
+ * @brief Bounded MPSC command ring
+ */
+typedef struct {
+    CommandSlot slots[COMMAND_QUEUE_CAPACITY];  /**< Ring of commands */
+    atomic_size_t tail;                         /**< Next position claimed by producers */
+    size_t head;                                /**< Next position read by consumer */
+} CommandQueue;
+
+/**
+ * @brief Initialize empty queue
+ * @param queue Queue to initialize
+ */
+void init_command_queue(CommandQueue *queue);
+
+/**
+ * @brief Append command (any thread, never blocks)
+ * @param queue Queue
+ * @param command Command to append
+ * @return true on success, false if queue is full (command is dropped)
+ */
+bool push_command(CommandQueue *queue, const PlayerCommand *command);
+
+/**
+ * @brief Take oldest command (one consumer at a time)
+ * @param queue Queue
+ * @param command Output command
+ * @return true if a command was taken, false if queue is empty
+ *
+ * Commands whose producer has claimed a slot but not yet published it
+ * are picked up by the next call.
+ */
+bool pop_command(CommandQueue *queue, PlayerCommand *command);
+
+#endif // COMMAND_QUEUE_H
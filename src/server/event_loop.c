@@ -0,0 +1,663 @@
+#include "event_loop.h"
+#include "network.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+/** Size of one read from socket into connection buffer */
+#define READ_CHUNK 4096
+
+typedef struct Connection {//stav jedneho klientskeho spojenia
+    int socket;//socket klienta
+    Game *game;//hra, do ktorej spojenie vstupilo (drzi referenciu, NULL ak este nie je v hre)
+    int player_id;//ID hraca (-1 ak este nie je v hre)
+    uint8_t *in_buf;//buffer pre neuplne prijate ramce
+    size_t in_len;//pocet bajtov v bufferi
+    size_t in_cap;//kapacita bufferu
+    OutboundQueue lobby_queue;//odpovede mimo hry (neblokujuco ako snapshoty v hre)
+    struct sockaddr_storage datagram_address;//UDP adresa z overeneho MSG_UDP_HELLO
+    socklen_t datagram_address_len;//velkost adresy (0 = klient neotvoril UDP)
+    bool datagrams;//snapshoty idu cez UDP
+    Codec codec;//kodek snapshotov dohodnuty pri vstupe
+    struct Connection *prev;//predchadzajuce spojenie v zozname
+    struct Connection *next;//nasledujuce spojenie v zozname
+} Connection;
+
+struct EventLoop {//epoll reaktor
+    int epoll_fd;//epoll instancia
+    int server_socket;//pocuvajuci socket
+    GameRegistry *registry;//hry, do ktorych sa smeruju spravy
+    Connection *connections;//zoznam vsetkych spojeni
+    int handoff_socket;//Unix socket pre nasledovnika (-1 = ziadny)
+    int successor;//pripojeny nasledovnik, ktoremu sa maju odovzdat hry (-1 = ziadny)
+    int datagram_socket;//UDP socket pre snapshoty (-1 = len TCP)
+};
+
+static void close_connection(EventLoop *loop, Connection *conn) {//zatvori spojenie a uvolni jeho zdroje
+    if (conn->player_id != -1) {//ak mal pridelene ID
+        printf("Player %d disconnected\n", conn->player_id);
+        remove_player(conn->game, conn->player_id);//odstran hraca z hry (predtym nez sa zatvori socket)
+    }
+    release_game(conn->game);//spojenie uz hru nedrzi
+    destroy_outbound_queue(&conn->lobby_queue);//neodoslane odpovede z lobby
+
+    epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, conn->socket, NULL);//odregistruj socket
+    close_socket(conn->socket);//zatvor socket
+
+    // Unlink from connection list
+    if (conn->prev) {
+        conn->prev->next = conn->next;
+    } else {
+        loop->connections = conn->next;
+    }
+    if (conn->next) {
+        conn->next->prev = conn->prev;
+    }
+
+    free(conn->in_buf);//uvolni buffer
+    free(conn);//uvolni spojenie
+}
+
+static OutboundQueue *connection_queue(Connection *conn) {//fronta, cez ktoru idu ramce spojenia
+    return conn->game ? &conn->game->out_queues[conn->player_id] : &conn->lobby_queue;
+}
+
+static void send_frame(Connection *conn, const uint8_t *data, size_t size) {//posle odpoved klientovi
+    // Queue behind snapshots (in game) or earlier replies (lobby); the reactor never waits for a client
+    Snapshot *frame = create_snapshot(size);
+    if (frame) {
+        memcpy(frame->data + FRAME_HEADER_SIZE, data, size);
+        enqueue_reliable(connection_queue(conn), frame);//plna fronta odpoji klienta
+        release_snapshot(frame);
+    }
+}
+
+static void send_reply(Connection *conn, const Message *msg) {//posle kratku odpoved klientovi
+    Snapshot *frame = create_snapshot(message_size(msg));//odpoved sa koduje priamo do ramca vo fronte
+    if (frame) {
+        size_t size;
+        serialize_message(msg, frame->data + FRAME_HEADER_SIZE, &size);
+        enqueue_reliable(connection_queue(conn), frame);
+        release_snapshot(frame);
+    }
+}
+
+static void send_error(Connection *conn, const char *text) {//posle chybovu spravu klientovi
+    Message error_msg;//vytvor chybovu spravu
+    memset(&error_msg, 0, sizeof(error_msg));
+    error_msg.type = MSG_ERROR;
+    error_msg.player_id = -1;
+    snprintf(error_msg.data.error_msg, sizeof(error_msg.data.error_msg), "%s", text);//text sa oreze na velkost spravy
+    send_reply(conn, &error_msg);
+}
+
+static void send_game_list(EventLoop *loop, Connection *conn, int after_game_id) {//posle stranku zoznamu hier z lobby
+    GameSummary page[GAME_LIST_PAGE_SIZE];
+    int total;
+    int count = list_games(&loop->registry->lobby, after_game_id, page, GAME_LIST_PAGE_SIZE, &total);//kopia z indexu, hry sa neprechadzaju
+    
+    uint8_t buffer[GAME_LIST_MESSAGE_MAX_SIZE];
+    size_t size = serialize_game_list(total, page, count, buffer, sizeof(buffer));
+    if (size > 0) {
+        send_frame(conn, buffer, size);
+    }
+}
+
+static bool is_valid_config(GameConfig *config) {//over konfiguraciu hry od klienta
+    config->map_file[sizeof(config->map_file) - 1] = '\0';//nazov suboru musi byt ukonceny
+    if (config->mode != MODE_STANDARD && config->mode != MODE_TIMED) {
+        return false;
+    }
+    if (config->world_type != WORLD_NO_OBSTACLES && config->world_type != WORLD_WITH_OBSTACLES) {
+        return false;
+    }
+    if (config->width < 20 || config->width > 200 || config->height < 10 || config->height > 100) {//rozsahy ako v menu klienta
+        return false;
+    }
+    if (config->time_limit < 0 || config->max_players < 1 || config->max_players > MAX_PLAYERS) {
+        return false;
+    }
+    if (config->tick_rate < 0 || config->tick_rate > MAX_TICK_RATE) {//0 = predvolena rychlost servera
+        return false;
+    }
+    return true;
+}
+
+static bool create_game_request(EventLoop *loop, Connection *conn, const GameConfig *requested) {//vytvori novu hru a posle klientovi jej ID
+    GameConfig config = *requested;
+    if (!is_valid_config(&config)) {
+        send_error(conn, "Invalid game configuration");
+        return false;//ukonci spojenie
+    }
+
+    int game_id = start_game(loop->registry, &config);//spusti hru v registri
+    if (game_id < 0) {
+        send_error(conn, "Failed to create game");
+        return false;//ukonci spojenie
+    }
+    printf("Game %d created (%dx%d, %s)\n", game_id, config.width, config.height,
+           config.mode == MODE_STANDARD ? "Standard" : "Timed");
+
+    Message reply;
+    memset(&reply, 0, sizeof(reply));
+    reply.type = MSG_GAME_CREATED;
+    reply.player_id = -1;
+    reply.data.game_id = game_id;
+    send_reply(conn, &reply);//klient sa potom pripoji cez MSG_JOIN_GAME
+    return true;
+}
+
+static bool join_game_request(EventLoop *loop, Connection *conn, int game_id, const char *name,
+                              uint64_t rejoin_token, uint32_t codecs) {//vstupi do hry podla ID (token = vrati sa do svojho slotu)
+    if (!drain_outbound_queue(&conn->lobby_queue, 0)) {//klient necita odpovede z lobby - ramce by sa prekryli s hrou
+        return false;//ukonci spojenie
+    }
+    
+    Game *game = acquire_game(loop->registry, game_id);//najdi hru (spojenie ziska referenciu)
+    if (!game) {
+        char text[256];
+        if (game_id == ANY_GAME_ID) {
+            strcpy(text, "No game is running");
+        } else {
+            snprintf(text, sizeof(text), "Game %d not found", game_id);
+        }
+        send_error(conn, text);//posli chybu klientovi
+        return false;//ukonci spojenie
+    }
+
+    if (rejoin_token != 0) {//hrac z hry obnovenej po restarte servera
+        conn->player_id = rejoin_player(game, conn->socket, rejoin_token);
+    } else {
+        conn->player_id = add_player(game, conn->socket, name);//pridaj hraca
+    }
+    if (conn->player_id == -1) {//ak sa nepodarilo pridat (hra plna alebo skoncila)
+        char text[256];
+        if (rejoin_token != 0) {
+            strcpy(text, "Cannot rejoin game");
+        } else if (game->state.game_over) {
+            strcpy(text, "Game has ended");
+        } else if (game->state.max_players == 1) {
+            strcpy(text, "Game is singleplayer only");
+        } else {
+            snprintf(text, sizeof(text), "Game is full (%d/%d players)",
+                    game->state.player_count, game->state.max_players);
+        }
+        release_game(game);
+        send_error(conn, text);//posli chybu klientovi
+        return false;//ukonci spojenie
+    }
+
+    conn->game = game;
+    detach_outbound_queue(&conn->lobby_queue);//dalej ide vsetko cez frontu hry
+    conn->codec = choose_codec(codecs);//klient bez kodekov dostava snapshoty ako doteraz
+    set_player_codec(game, conn->player_id, conn->codec);
+    printf("Player %d (%s) joined game %d\n", conn->player_id, name, game->state.game_id);
+    return true;
+}
+
+static bool dispatch_message(EventLoop *loop, Connection *conn, const Message *msg) {//spracuje jednu spravu, vrati false ak sa ma spojenie zatvorit
+    Game *game = conn->game;
+
+    switch (msg->type) {//spracuj spravu podla typu
+        case MSG_CREATE_GAME://klient chce vytvorit novu hru
+            return create_game_request(loop, conn, &msg->data.config);
+
+        case MSG_LIST_GAMES://klient prehladava lobby
+            send_game_list(loop, conn, msg->data.after_game_id);
+            break;
+
+        case MSG_JOIN_GAME://klient sa chce pripojit do hry
+            if (conn->player_id == -1) {//ak este nema pridelene ID
+                if (msg->data.join_info.version < PROTOCOL_MIN_VERSION) {//klient starsej verzie protokolu
+                    char text[256];
+                    snprintf(text, sizeof(text), "Protocol version %u is not supported (server speaks %d to %d)",
+                             msg->data.join_info.version, PROTOCOL_MIN_VERSION, PROTOCOL_VERSION);
+                    send_error(conn, text);
+                    return false;//ukonci spojenie
+                }
+                char name[MAX_NAME_LENGTH];
+                memcpy(name, msg->data.join_info.name, MAX_NAME_LENGTH);
+                name[MAX_NAME_LENGTH - 1] = '\0';//meno od klienta musi byt ukoncene
+                return join_game_request(loop, conn, msg->data.join_info.game_id, name,
+                                         msg->data.join_info.rejoin_token, msg->data.join_info.codecs);
+            }
+            break;
+
+        case MSG_PLAYER_INPUT://vstup od hraca (smer)
+            if (conn->player_id != -1) {
+                handle_player_input(game, conn->player_id, msg->data.direction);//spracuj vstup
+            }
+            break;
+
+        case MSG_PAUSE://pozastavenie hry
+            if (conn->player_id != -1) {
+                pause_player(game, conn->player_id);//pozastav hraca
+            }
+            break;
+
+        case MSG_RESUME://obnovenie hry
+            if (conn->player_id != -1) {
+                resume_player(game, conn->player_id);//obnov hraca
+            }
+            break;
+
+        case MSG_STATE_ACK://klient potvrdil snapshot (baseline pre delty)
+            if (conn->player_id != -1) {
+                acknowledge_state(game, conn->player_id, msg->data.tick);
+            }
+            break;
+
+        case MSG_UDP_READY://klient prijal odpoved na UDP hello
+            if (conn->player_id != -1 && conn->datagram_address_len > 0 && loop->datagram_socket >= 0) {
+                set_datagram_address(&game->out_queues[conn->player_id], loop->datagram_socket,
+                                     (struct sockaddr *)&conn->datagram_address, conn->datagram_address_len);
+                conn->datagrams = true;
+            }
+            break;
+
+        case MSG_PLAYER_DISCONNECT://hrac sa odpaja
+            return false;//ukonci spojenie
+
+        default:
+            break;
+    }
+
+    return true;
+}
+
+static bool process_frames(EventLoop *loop, Connection *conn) {//spracuje vsetky uplne ramce v bufferi spojenia
+    size_t offset = 0;//zaciatok dalsieho ramca
+    bool keep_open = true;
+
+    while (keep_open && conn->in_len - offset >= FRAME_HEADER_SIZE) {//kym mame aspon hlavicku ramca
+        size_t size = read_frame_header(conn->in_buf + offset);//velkost ramca
+        if (size > BUFFER_SIZE) {//prilis velky ramec - neplatny klient
+            return false;
+        }
+        if (conn->in_len - offset < FRAME_HEADER_SIZE + size) {//ramec este nie je cely
+            break;
+        }
+
+        Message msg;
+        if (deserialize_message(conn->in_buf + offset + FRAME_HEADER_SIZE, size, &msg)) {//deserializuj spravu
+            keep_open = dispatch_message(loop, conn, &msg);//spracuj spravu
+        }
+        offset += FRAME_HEADER_SIZE + size;//posun na dalsi ramec
+    }
+
+    // Keep only the unfinished frame
+    if (offset > 0) {
+        memmove(conn->in_buf, conn->in_buf + offset, conn->in_len - offset);//presun zvysok na zaciatok
+        conn->in_len -= offset;
+    }
+    if (conn->in_len == 0 && conn->in_cap > READ_CHUNK) {//necinne spojenie nema drzat velky buffer
+        free(conn->in_buf);
+        conn->in_buf = NULL;
+        conn->in_cap = 0;
+    }
+
+    return keep_open;
+}
+
+static bool handle_readable(EventLoop *loop, Connection *conn) {//precita vsetky dostupne data (edge-triggered), vrati false ak sa ma spojenie zatvorit
+    while (true) {
+        // Make room for next chunk
+        size_t max_cap = FRAME_HEADER_SIZE + BUFFER_SIZE + READ_CHUNK;//jeden maximalny ramec + jedno citanie
+        if (conn->in_cap - conn->in_len < READ_CHUNK && conn->in_cap < max_cap) {//malo miesta v bufferi
+            size_t new_cap = conn->in_cap ? conn->in_cap * 2 : READ_CHUNK;
+            if (new_cap > max_cap) {
+                new_cap = max_cap;
+            }
+            uint8_t *new_buf = realloc(conn->in_buf, new_cap);
+            if (!new_buf) {
+                return false;
+            }
+            conn->in_buf = new_buf;
+            conn->in_cap = new_cap;
+        }
+        if (conn->in_len == conn->in_cap) {//plny buffer bez uplneho ramca - neplatny klient
+            return false;
+        }
+
+        ssize_t n = recv(conn->socket, conn->in_buf + conn->in_len, conn->in_cap - conn->in_len, 0);//citaj co je dostupne
+        if (n > 0) {
+            conn->in_len += n;
+            if (!process_frames(loop, conn)) {//spracuj uplne ramce
+                return false;
+            }
+            continue;
+        }
+        if (n == 0) {//klient zatvoril spojenie
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return errno == EAGAIN || errno == EWOULDBLOCK;//socket je vyprazdneny
+    }
+}
+
+static Connection *find_player(EventLoop *loop, int game_id, int player_id) {//spojenie hraca v hre
+    for (Connection *conn = loop->connections; conn; conn = conn->next) {
+        if (conn->player_id == player_id && conn->player_id != -1 && conn->game->state.game_id == game_id) {
+            return conn;
+        }
+    }
+    return NULL;
+}
+
+static void handle_datagrams(EventLoop *loop) {//spracuje vsetky prijate UDP hello (edge-triggered)
+    uint8_t buffer[DATAGRAM_MAX_PAYLOAD];
+    while (true) {
+        struct sockaddr_storage address;
+        socklen_t address_len = sizeof(address);
+        ssize_t n = recvfrom(loop->datagram_socket, buffer, sizeof(buffer), 0, (struct sockaddr *)&address, &address_len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;//socket je vyprazdneny
+        }
+
+        Message msg;
+        if (!deserialize_message(buffer, n, &msg) || msg.type != MSG_UDP_HELLO) {//klienti posielaju cez UDP len hello
+            continue;
+        }
+        Connection *conn = find_player(loop, msg.data.joined.game_id, msg.player_id);
+        if (!conn || !check_player_token(conn->game, conn->player_id, msg.data.joined.rejoin_token)) {//cudzi alebo stary odosielatel
+            continue;
+        }
+        memcpy(&conn->datagram_address, &address, address_len);//snapshoty pojdu sem po MSG_UDP_READY
+        conn->datagram_address_len = address_len;
+        sendto(loop->datagram_socket, buffer, n, 0, (struct sockaddr *)&address, address_len);//odpoved overi cestu ku klientovi
+    }
+}
+
+static Connection *add_connection(EventLoop *loop, int client_socket) {//zaregistruje spojenie v epoll, NULL pri chybe (socket zatvori)
+    if (!set_nonblocking(client_socket)) {//prepni klienta na neblokujuci rezim
+        close_socket(client_socket);
+        return NULL;
+    }
+
+    Connection *conn = calloc(1, sizeof(Connection));//nove spojenie (bez bufferu, kym nepride data)
+    if (!conn) {
+        close_socket(client_socket);
+        return NULL;
+    }
+    conn->socket = client_socket;
+    conn->player_id = -1;
+    init_outbound_queue(&conn->lobby_queue);
+    attach_outbound_queue(&conn->lobby_queue, client_socket, 0);//len spolahlive ramce, nic sa nezahadzuje
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;//edge-triggered citanie aj zapis
+    ev.data.ptr = conn;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, client_socket, &ev) < 0) {//zaregistruj klienta
+        perror("epoll_ctl");
+        destroy_outbound_queue(&conn->lobby_queue);
+        close_socket(client_socket);
+        free(conn);
+        return NULL;
+    }
+
+    // Link into connection list
+    conn->next = loop->connections;
+    if (loop->connections) {
+        loop->connections->prev = conn;
+    }
+    loop->connections = conn;
+    return conn;
+}
+
+static void accept_clients(EventLoop *loop) {//prijme vsetkych cakajucich klientov
+    while (true) {
+        int client_socket = accept_client(loop->server_socket);//prijmi klienta
+        if (client_socket < 0) {//ziadny dalsi klient (EAGAIN) alebo chyba
+            return;
+        }
+
+        if (add_connection(loop, client_socket)) {
+            printf("New client connected\n");
+        }
+    }
+}
+
+static void accept_successor(EventLoop *loop) {//prijme novy proces servera, ktory chce prevziat hry
+    int successor = accept(loop->handoff_socket, NULL, NULL);
+    if (successor < 0) {
+        return;
+    }
+    loop->successor = successor;//run_event_loop skonci (prijaty socket je blokujuci)
+}
+
+EventLoop *create_event_loop(int server_socket, GameRegistry *registry) {//vytvori epoll reaktor
+    EventLoop *loop = calloc(1, sizeof(EventLoop));
+    if (!loop) {
+        return NULL;
+    }
+
+    loop->server_socket = server_socket;
+    loop->registry = registry;
+    loop->handoff_socket = -1;
+    loop->successor = -1;
+    loop->datagram_socket = -1;
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);//vytvor epoll instanciu
+    if (loop->epoll_fd < 0) {
+        perror("epoll_create1");
+        free(loop);
+        return NULL;
+    }
+
+    if (!set_nonblocking(server_socket)) {//pocuvajuci socket tiez neblokujuci (accept v slucke)
+        close(loop->epoll_fd);
+        free(loop);
+        return NULL;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = NULL;//NULL oznacuje pocuvajuci socket
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, server_socket, &ev) < 0) {//zaregistruj pocuvajuci socket
+        perror("epoll_ctl");
+        close(loop->epoll_fd);
+        free(loop);
+        return NULL;
+    }
+
+    return loop;
+}
+
+void run_event_loop(EventLoop *loop, volatile bool *running) {//hlavna slucka reaktora
+    struct epoll_event events[MAX_EVENTS];
+
+    while (*running && loop->successor < 0) {//kym bezi server a nikto ho nepreberie
+        int count = epoll_wait(loop->epoll_fd, events, MAX_EVENTS, EVENT_LOOP_TIMEOUT_MS);//cakaj na udalosti alebo timeout
+        if (count < 0) {
+            if (errno == EINTR) {//prerusene signalom (Ctrl+C)
+                continue;
+            }
+            perror("epoll_wait");
+            break;
+        }
+
+        reap_finished_games(loop->registry);//uprac skoncene hry (aspon raz za EVENT_LOOP_TIMEOUT_MS)
+        if (is_registry_idle(loop->registry)) {//posledna hra skoncila
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {//spracuj vsetky udalosti
+            Connection *conn = events[i].data.ptr;
+            if (!conn) {//udalost na pocuvajucom sockete
+                accept_clients(loop);
+                continue;
+            }
+            if (events[i].data.ptr == &loop->handoff_socket) {//novy proces servera
+                accept_successor(loop);
+                continue;
+            }
+            if (events[i].data.ptr == &loop->datagram_socket) {//UDP hello od klientov
+                handle_datagrams(loop);
+                continue;
+            }
+
+            bool keep_open = true;
+            if (events[i].events & EPOLLIN) {//data na citanie
+                keep_open = handle_readable(loop, conn);
+            }
+            if (keep_open && (events[i].events & EPOLLOUT)) {//socket sa uvolnil
+                keep_open = flush_outbound_queue(connection_queue(conn));//dokonci odosielanie snapshotov alebo odpovedi
+            }
+            if (events[i].events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) {//klient sa odpojil
+                keep_open = false;
+            }
+            if (!keep_open) {
+                close_connection(loop, conn);//zatvor spojenie
+            }
+        }
+    }
+}
+
+bool watch_handoff_socket(EventLoop *loop, int socket) {//prijima nasledovnikov na Unix sockete
+    if (!set_nonblocking(socket)) {
+        return false;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = &loop->handoff_socket;//odlisi ho od spojeni
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, socket, &ev) < 0) {
+        perror("epoll_ctl");
+        return false;
+    }
+    loop->handoff_socket = socket;
+    return true;
+}
+
+bool watch_datagram_socket(EventLoop *loop, int socket) {//prijima UDP hello klientov
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = &loop->datagram_socket;//odlisi ho od spojeni
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, socket, &ev) < 0) {
+        perror("epoll_ctl");
+        return false;
+    }
+    loop->datagram_socket = socket;
+    return true;
+}
+
+int take_successor(EventLoop *loop) {//nasledovnik, kvoli ktoremu skoncil run_event_loop
+    int successor = loop->successor;
+    loop->successor = -1;
+    return successor;
+}
+
+HandoffConnection *export_connections(EventLoop *loop, int *count) {//pripravi spojenia na odovzdanie (hry su pozastavene)
+    Connection *conn = loop->connections;
+    while (conn) {//klient musi dostat cele ramce, inak sa neodovzda
+        Connection *next = conn->next;
+        if (!drain_outbound_queue(connection_queue(conn), HANDOFF_DRAIN_MS)) {
+            close_connection(loop, conn);//hrac sa odstrani este pred checkpointom
+        }
+        conn = next;
+    }
+
+    int total = 0;
+    for (conn = loop->connections; conn; conn = conn->next) {
+        total++;
+    }
+    HandoffConnection *exported = calloc(total ? total : 1, sizeof(HandoffConnection));
+    if (!exported) {
+        return NULL;
+    }
+    int index = 0;
+    for (conn = loop->connections; conn; conn = conn->next) {
+        HandoffConnection *handed = &exported[index++];
+        handed->socket = conn->socket;
+        handed->game = conn->game;//referencia ostava spojeniu
+        handed->player_id = conn->player_id;
+        handed->pending = conn->in_buf;
+        handed->pending_len = conn->in_len;
+        if (conn->datagrams) {//nasledovnik posiela snapshoty na rovnaku UDP adresu
+            handed->datagram_address = conn->datagram_address;
+            handed->datagram_address_len = conn->datagram_address_len;
+        }
+        handed->codec = conn->codec;
+    }
+    *count = total;
+    return exported;
+}
+
+void abandon_connections(EventLoop *loop) {//zatvori deskriptory odovzdanych spojeni (klienti zostavaju pripojeni)
+    while (loop->connections) {
+        Connection *conn = loop->connections;
+        loop->connections = conn->next;
+        epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, conn->socket, NULL);
+        close_socket(conn->socket);//spojenie drzi nasledovnik
+        release_game(conn->game);//hrac ostava v hre (hra sa uz nehra)
+        destroy_outbound_queue(&conn->lobby_queue);//fronta bola pred odovzdanim vyprazdnena
+        free(conn->in_buf);
+        free(conn);
+    }
+}
+
+bool adopt_connection(EventLoop *loop, const HandoffConnection *handed) {//prevezme spojenie predchodcu
+    Connection *conn = add_connection(loop, handed->socket);
+    if (!conn) {
+        if (handed->player_id != -1) {
+            remove_player(handed->game, handed->player_id);
+        }
+        release_game(handed->game);
+        return false;
+    }
+    conn->game = handed->game;//referencia prechadza na spojenie
+    conn->player_id = handed->player_id;
+    if (conn->game) {//ramce idu cez frontu hry
+        detach_outbound_queue(&conn->lobby_queue);
+    }
+    conn->codec = handed->codec;
+    if (conn->player_id != -1) {
+        set_player_codec(conn->game, conn->player_id, conn->codec);
+    }
+    if (handed->pending_len > 0) {//nedokonceny ramec od klienta
+        conn->in_buf = malloc(handed->pending_len);
+        if (!conn->in_buf) {
+            close_connection(loop, conn);
+            return false;
+        }
+        memcpy(conn->in_buf, handed->pending, handed->pending_len);
+        conn->in_len = handed->pending_len;
+        conn->in_cap = handed->pending_len;
+    }
+    if (conn->player_id != -1 && handed->datagram_address_len > 0 && loop->datagram_socket >= 0) {//klient uz ma UDP kanal
+        conn->datagram_address = handed->datagram_address;
+        conn->datagram_address_len = handed->datagram_address_len;
+        conn->datagrams = true;
+        set_datagram_address(&conn->game->out_queues[conn->player_id], loop->datagram_socket,
+                             (struct sockaddr *)&conn->datagram_address, conn->datagram_address_len);
+    }
+    if (!flush_outbound_queue(connection_queue(conn))) {//EPOLLOUT uz mohol prist
+        close_connection(loop, conn);
+        return false;
+    }
+    return true;
+}
+
+void destroy_event_loop(EventLoop *loop) {//znici reaktor a zatvori vsetky spojenia
+    if (!loop) {
+        return;
+    }
+
+    while (loop->connections) {//zatvor vsetky otvorene spojenia
+        close_connection(loop, loop->connections);
+    }
+
+    close(loop->epoll_fd);//zatvor epoll instanciu
+    free(loop);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file event_loop.h
+ * @brief epoll based event loop for client connections
+ *
+ * Multiplexes the listening socket, the optional UDP socket and all client
+ * sockets on a single thread using edge-triggered epoll and non-blocking
+ * sockets. Complete frames are dispatched into the Game API (create, join,
+ * input, pause, resume, disconnect); a connection is routed to the game it
+ * joined by ID.
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include "game_registry.h"
+#include "handoff.h"
+#include <stdbool.h>
+
+/** Maximum number of events handled per epoll_wait call */
+#define MAX_EVENTS 64
+
+/** epoll_wait timeout in milliseconds (how often running flag is checked and finished games reaped) */
+#define EVENT_LOOP_TIMEOUT_MS 1000
+
+/**
+ * @brief Opaque event loop instance
+ */
+typedef struct EventLoop EventLoop;
+
+/**
+ * @brief Create event loop for listening socket
+ * @param server_socket Listening socket (switched to non-blocking)
+ * @param registry Games that clients create and join
+ * @return Pointer to created event loop, or NULL on failure
+ */
+EventLoop *create_event_loop(int server_socket, GameRegistry *registry);
+
+/**
+ * @brief Run event loop until server stops
+ * @param loop Event loop instance
+ * @param running Server running flag (checked after every wakeup)
+ *
+ * Accepts new clients, reads all available bytes from ready sockets,
+ * dispatches every complete frame and closes disconnected clients.
+ * Reaps finished games and also returns once the registry is idle or a
+ * successor process connected to the handoff socket (see take_successor).
+ */
+void run_event_loop(EventLoop *loop, volatile bool *running);
+
+/**
+ * @brief Accept successor processes on handoff socket
+ * @param loop Event loop instance
+ * @param socket Listening Unix socket (open_handoff_socket, owned by caller)
+ * @return true on success
+ */
+bool watch_handoff_socket(EventLoop *loop, int socket);
+
+/**
+ * @brief Accept UDP snapshot channels of players
+ * @param loop Event loop instance
+ * @param socket Non-blocking UDP socket (create_datagram_socket, owned by caller)
+ * @return true on success
+ *
+ * A player opens the channel with a MSG_UDP_HELLO datagram carrying game
+ * ID, player ID and token from MSG_JOINED; the server echoes it to the
+ * sender. Once the client confirms the echo with MSG_UDP_READY over TCP,
+ * its snapshots go over UDP. Everything else stays on TCP.
+ */
+bool watch_datagram_socket(EventLoop *loop, int socket);
+
+/**
+ * @brief Take successor that ended run_event_loop
+ * @param loop Event loop instance
+ * @return Connected successor (owned by caller), or -1 if none
+ */
+int take_successor(EventLoop *loop);
+
+/**
+ * @brief Prepare all connections for handoff
+ * @param loop Event loop instance (games suspended)
+ * @param count Output number of connections
+ * @return Connections (free the array only), NULL on allocation failure
+ *
+ * Drains the outbound queue of every player for up to HANDOFF_DRAIN_MS;
+ * players whose queue cannot be drained are disconnected. The returned
+ * sockets, games and pending bytes stay owned by the event loop.
+ */
+HandoffConnection *export_connections(EventLoop *loop, int *count);
+
+/**
+ * @brief Close descriptors of connections taken over by successor
+ * @param loop Event loop instance
+ *
+ * Players stay in their games and the clients stay connected.
+ */
+void abandon_connections(EventLoop *loop);
+
+/**
+ * @brief Add connection handed over by previous process
+ * @param loop Event loop instance
+ * @param handed Connection from receive_handoff (socket and game
+ *               reference pass to the event loop, also on failure)
+ * @return true on success, false if the connection was closed
+ */
+bool adopt_connection(EventLoop *loop, const HandoffConnection *handed);
+
+/**
+ * @brief Destroy event loop, close all client connections
+ * @param loop Event loop instance
+ *
+ * Listening socket is not closed (owned by caller).
+ */
+void destroy_event_loop(EventLoop *loop);
+
+#endif // EVENT_LOOP_H
@@ -7,7 +7,7 @@
 #include <time.h>
 #include <unistd.h>
 
-Game *create_game(const GameConfig *config) {//vytvori novu hru s danou konfiguaciou
+static Game *alloc_game(const GameConfig *config) {//alokuje hru a nastavi stav podla konfiguracie (bez mapy)
     Game *game = (Game *)malloc(sizeof(Game));//alokuj pamat pre hru
     if (!game) {
         return NULL;
@@ -16,16 +16,75 @@ Game *create_game(const GameConfig *config) {//vytvori novu hru s danou konfigua
     memset(game, 0, sizeof(Game));//vynuluj celu strukturu
     
     // Initialize game state
-    game->state.game_id = rand();//nahodne ID hry
+    game->state.game_id = 0;//ID prideli register hier
     game->state.player_count = 0;//zatial ziadni hraci
     game->state.width = config->width;//sirka mapy
     game->state.height = config->height;//vyska mapy
     game->state.mode = config->mode;//mod hry (standard/timed)
     game->state.time_limit = config->time_limit;//casovy limit
     game->state.elapsed_time = 0;//zatial neuplynul cas
+    game->state.time_ms = 0;//herny cas zacina na nule
     game->state.game_over = false;//hra nie je ukoncena
     game->state.food_count = 0;//zatial ziadne jedlo
     game->state.max_players = config->max_players;//max pocet hracov
+    game->seed = config->seed;//seed generatora hry
+    seed_rng(&game->rng, config->seed);//mapa aj jedlo su pre rovnaky seed rovnake
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    game->token_state = ((uint64_t)now.tv_sec << 32) ^ (uint64_t)now.tv_nsec ^ (uint64_t)(uintptr_t)game;//tokeny nezavisia od seedu hry
+    return game;
+}
+
+static Game *init_game(Game *game, const GameConfig *config) {//dokonci hru s nastavenou mapou (pri chybe ju uvolni)
+    // Map is static: hash it and encode MSG_MAP once for all joining clients
+    game->state.map_id = compute_map_id(game->state.obstacles, game->state.width, game->state.height);
+    game->map_frame = create_snapshot(map_message_size(game->state.width, game->state.height));//mapa musi prejst limitom ramca
+    if (!game->map_frame) {
+        fprintf(stderr, "Map %dx%d exceeds message size limit\n", game->state.width, game->state.height);
+        free_obstacles(game->state.obstacles);
+        free(game);
+        return NULL;
+    }
+    size_t map_size;
+    serialize_map(&game->state, game->map_frame->data + FRAME_HEADER_SIZE, &map_size);
+    
+    if (!init_occupancy_grid(&game->occupancy, game->state.width, game->state.height, game->state.obstacles)) {//mriezka obsadenosti a volnych buniek
+        release_snapshot(game->map_frame);
+        free_obstacles(game->state.obstacles);
+        free(game);
+        return NULL;
+    }
+    
+    pthread_mutex_init(&game->mutex, NULL);//inicializuj mutex pre thread-safe pristup
+    init_command_queue(&game->commands);//prazdna fronta prikazov hracov
+    atomic_init(&game->refcount, 1);//jedna referencia pre volajuceho
+    atomic_init(&game->finished, false);//tick vlakno este nebezi
+    atomic_init(&game->running, true);//hra bezi
+    atomic_init(&game->suspended, false);//tick vlakno nie je pozastavene
+    game->last_player_ms = 0;//herny cas posledneho pripojeneho hraca
+    game->config = *config;//uloz konfiguraciu
+    game->tick_rate = config->tick_rate > 0 ? config->tick_rate : DEFAULT_TICK_RATE;//tiky za sekundu
+    
+    for (int i = 0; i < MAX_PLAYERS; i++) {//inicializuj vsetkych hracov
+        game->client_sockets[i] = -1;//ziadny socket
+        game->client_connected[i] = false;//nepripojeny
+        game->resume_at_ms[i] = 0;//ziadny countdown
+        init_outbound_queue(&game->out_queues[i]);//prazdna odchadzajuca fronta
+        game->acked_tick[i] = -1;//ziadny potvrdeny snapshot
+    }
+    for (int i = 0; i < STATE_HISTORY_SIZE; i++) {//prazdna historia snapshotov
+        game->history[i].tick = -1;
+    }
+    game->max_dropped_frames = DEFAULT_MAX_DROPPED_FRAMES;//limit zahodenych snapshotov
+    
+    return game;//vrat vytvorenu hru
+}
+
+Game *create_game(const GameConfig *config) {//vytvori novu hru s danou konfiguaciou
+    Game *game = alloc_game(config);
+    if (!game) {
+        return NULL;
+    }
     
     // Load or generate map
     if (config->load_from_file && config->map_file[0] != '\0') {//ak sa ma nacitat mapa zo suboru
@@ -40,7 +99,7 @@ Game *create_game(const GameConfig *config) {//vytvori novu hru s danou konfigua
             bool success = false;
             
             for (int attempt = 0; attempt < max_attempts; attempt++) {//opakuj kym sa nevygeneruje platna mapa
-                generate_random_map(&game->state.obstacles, config->width, config->height, 0.10f);//generuj s 10% hustotou
+                generate_random_map(&game->state.obstacles, config->width, config->height, 0.10f, &game->rng);//generuj s 10% hustotou
                 
                 // Verify reachability
                 if (is_reachable(game->state.obstacles, config->width, config->height, center)) {//over ci su vsetky bunky dosiahnutelne
@@ -65,7 +124,7 @@ Game *create_game(const GameConfig *config) {//vytvori novu hru s danou konfigua
         bool success = false;
         
         for (int attempt = 0; attempt < max_attempts; attempt++) {//opakuj kym sa nevygeneruje platna mapa
-            generate_random_map(&game->state.obstacles, config->width, config->height, 0.10f);//generuj s 10% hustotou
+            generate_random_map(&game->state.obstacles, config->width, config->height, 0.10f, &game->rng);//generuj s 10% hustotou
             
             // Verify reachability
             if (is_reachable(game->state.obstacles, config->width, config->height, center)) {//over ci su vsetky bunky dosiahnutelne
@@ -87,19 +146,19 @@ Game *create_game(const GameConfig *config) {//vytvori novu hru s danou konfigua
         game->state.obstacles = (uint8_t *)calloc(config->width * config->height, sizeof(uint8_t));//prazdna mapa bez prekazok
     }
     
-    pthread_mutex_init(&game->mutex, NULL);//inicializuj mutex pre thread-safe pristup
-    game->running = true;//hra bezi
-    game->start_time = time(NULL);//cas spustenia hry
-    game->last_player_time = time(NULL);//cas posledneho pripojeneho hraca
-    game->config = *config;//uloz konfiguraciu
-    
-    for (int i = 0; i < MAX_PLAYERS; i++) {//inicializuj vsetkych hracov
-        game->client_sockets[i] = -1;//ziadny socket
-        game->client_connected[i] = false;//nepripojeny
-        game->pause_countdown[i] = 0;//ziadny countdown
+    return init_game(game, config);
+}
+
+Game *create_game_with_map(const GameConfig *config, uint8_t *obstacles, int width, int height) {//vytvori hru s ulozenou mapou
+    Game *game = alloc_game(config);
+    if (!game) {
+        free_obstacles(obstacles);
+        return NULL;
     }
-    
-    return game;//vrat vytvorenu hru
+    game->state.obstacles = obstacles;//mapa sa negeneruje
+    game->state.width = width;
+    game->state.height = height;
+    return init_game(game, config);
 }
 
 void destroy_game(Game *game) {//znici hru a uvolni vsetky zdroje
@@ -107,7 +166,8 @@ void destroy_game(Game *game) {//znici hru a uvolni vsetky zdroje
         return;
     }
     
-    game->running = false;//zastav hru
+    atomic_store(&game->running, false);//zastav hru
+    close_replay(game->replay);//hra sa nespustila (stop_replay ho uz zatvoril inak)
     
     pthread_mutex_lock(&game->mutex);//zamkni mutex
     
@@ -118,14 +178,102 @@ void destroy_game(Game *game) {//znici hru a uvolni vsetky zdroje
     pthread_mutex_unlock(&game->mutex);//odomkni mutex
     pthread_mutex_destroy(&game->mutex);//znic mutex
     
+    for (int i = 0; i < MAX_PLAYERS; i++) {//znic odchadzajuce fronty
+        destroy_outbound_queue(&game->out_queues[i]);
+    }
+    release_snapshot(game->map_frame);//uvolni zakodovanu mapu
+    free_message_buffer(&game->scratch);//uvolni pracovny buffer
+    free_message_buffer(&game->packed);
+    destroy_occupancy_grid(&game->occupancy);//uvolni mriezku obsadenosti
+    
     free(game);//uvolni pamat hry
 }
 
+Game *retain_game(Game *game) {//prida referenciu na hru
+    atomic_fetch_add(&game->refcount, 1);
+    return game;
+}
+
+void release_game(Game *game) {//uvolni referenciu, posledna hru znici
+    if (game && atomic_fetch_sub(&game->refcount, 1) == 1) {
+        destroy_game(game);
+    }
+}
+
+static void broadcast_roster(Game *game) {//posle mena hracov vsetkym klientom (mutex musi byt zamknuty)
+    uint8_t buffer[ROSTER_MESSAGE_MAX_SIZE];//roster je maly (mena max MAX_PLAYERS hracov)
+    size_t size = serialize_roster(&game->state, buffer, sizeof(buffer));
+    Snapshot *roster = size > 0 ? create_snapshot(size) : NULL;
+    if (!roster) {
+        return;
+    }
+    memcpy(roster->data + FRAME_HEADER_SIZE, buffer, size);
+    
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (game->client_connected[i]) {
+            enqueue_reliable(&game->out_queues[i], roster);//mena sa nesmu stratit
+        }
+    }
+    release_snapshot(roster);
+}
+
+static void send_joined(Game *game, int player_id) {//posle hracovi jeho slot a token (mutex musi byt zamknuty)
+    Message msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.type = MSG_JOINED;
+    msg.player_id = player_id;
+    msg.data.joined.game_id = game->state.game_id;
+    msg.data.joined.rejoin_token = game->rejoin_tokens[player_id];
+    msg.data.joined.version = PROTOCOL_VERSION;
+    
+    Snapshot *frame = create_snapshot(message_size(&msg));//kodovanie priamo do ramca
+    if (frame) {
+        size_t size;
+        serialize_message(&msg, frame->data + FRAME_HEADER_SIZE, &size);
+        enqueue_reliable(&game->out_queues[player_id], frame);//ide pred mapou a prvym snapshotom
+        release_snapshot(frame);
+    }
+}
+
+static void apply_commands(Game *game) {//vykona prikazy hracov z fronty (mutex musi byt zamknuty)
+    PlayerCommand command;
+    while (pop_command(&game->commands, &command)) {
+        int player_id = command.player_id;
+        if (!game->client_connected[player_id]) {//hrac medzicasom odisiel
+            continue;
+        }
+        if (game->replay) {//zaznam obsahuje len vykonane prikazy
+            record_command(game->replay, game->state.tick, &command);
+        }
+        switch (command.type) {
+            case COMMAND_DIRECTION:
+                change_direction(&game->state.snakes[player_id], command.direction);//zmen smer hada
+                break;
+            case COMMAND_PAUSE:
+                game->state.snakes[player_id].paused = true;//pozastav hada
+                game->resume_at_ms[player_id] = 0;//zrus countdown
+                break;
+            case COMMAND_RESUME:
+                game->resume_at_ms[player_id] = game->state.time_ms + RESUME_COUNTDOWN_MS;//3 sekundy herneho casu
+                break;
+        }
+    }
+}
+
+static void queue_command(Game *game, CommandType type, int player_id, Direction direction) {//zaradi prikaz hraca do dalsieho tiku (bez mutexu)
+    if (player_id < 0 || player_id >= MAX_PLAYERS) {//neplatne ID
+        return;
+    }
+    PlayerCommand command = { .type = type, .player_id = player_id, .direction = direction };
+    push_command(&game->commands, &command);//plna fronta - prikaz sa zahodi
+}
+
 int add_player(Game *game, int socket, const char *name) {//prida hraca do hry
     pthread_mutex_lock(&game->mutex);//zamkni mutex
+    apply_commands(game);//prikazy predchadzajuceho hraca v slote sa nesmu dostat k novemu
     
     // Check if game is full based on max_players setting
-    if (game->state.player_count >= game->state.max_players) {//ak je hra plna
+    if (game->state.game_over || game->state.player_count >= game->state.max_players) {//ak je hra plna alebo skoncila
         pthread_mutex_unlock(&game->mutex);
         return -1;//chyba
     }
@@ -156,31 +304,431 @@ int add_player(Game *game, int socket, const char *name) {//prida hraca do hry
     memset(&game->state.snakes[player_id], 0, sizeof(Snake));//vycisti slot hada
     
     init_snake(&game->state.snakes[player_id], player_id, start_x, start_y, name);//inicializuj hada
+    game->state.snakes[player_id].serial = ++game->next_serial;//novy spawn (klienti dostanu celeho hada)
+    game->acked_tick[player_id] = -1;//novy klient dostane keyframe
+    game->codecs[player_id] = CODEC_NONE;//kodek nastavi event loop po vstupe
     game->state.snakes[player_id].spawn_time = game->state.elapsed_time;//nastav cas spawnu
+    occupy_snake(&game->occupancy, &game->state.snakes[player_id]);//had zabera bunky
     game->client_sockets[player_id] = socket;//uloz socket
     game->client_connected[player_id] = true;//oznac ako pripojeny
-    game->pause_countdown[player_id] = 30;//3 sekundy countdown (10 ticks/sec)
+    attach_outbound_queue(&game->out_queues[player_id], socket, game->max_dropped_frames);//fronta snapshotov pre klienta
+    do {//token pre navrat do slotu po restarte servera
+        game->rejoin_tokens[player_id] = splitmix64(&game->token_state);
+    } while (game->rejoin_tokens[player_id] == 0);
+    game->rejoin_deadline_ms[player_id] = 0;
+    send_joined(game, player_id);
+    enqueue_reliable(&game->out_queues[player_id], game->map_frame);//mapa ide pred prvym snapshotom
+    game->resume_at_ms[player_id] = game->state.time_ms + RESUME_COUNTDOWN_MS;//3 sekundy countdown
     game->state.player_count++;//zvys pocet hracov
-    game->last_player_time = time(NULL);//aktualizuj cas posledneho hraca
+    game->last_player_ms = game->state.time_ms;//aktualizuj cas posledneho hraca
     
     // Generate food for new player
     generate_food(game);//vygeneruj jedlo
     
+    broadcast_roster(game);//vsetci klienti dostanu meno noveho hraca
+    
+    if (game->replay) {
+        record_join(game->replay, game->state.tick, player_id, name);
+    }
+    
     pthread_mutex_unlock(&game->mutex);//odomkni mutex
     
     return player_id;//vrat ID hraca
 }
 
+static void drop_player(Game *game, int player_id) {//odstrani hraca zo slotu (mutex musi byt zamknuty)
+    if (game->state.snakes[player_id].alive) {//zivy had uvolni bunky
+        vacate_snake(&game->occupancy, &game->state.snakes[player_id]);
+    }
+    game->state.snakes[player_id].alive = false;//had umrie
+    game->client_connected[player_id] = false;//odpoj hraca
+    game->rejoin_tokens[player_id] = 0;//slot sa uz neda ziskat spat
+    game->rejoin_deadline_ms[player_id] = 0;
+    detach_outbound_queue(&game->out_queues[player_id]);//uz mu neposielaj snapshoty
+    game->state.player_count--;//zniz pocet hracov
+    game->last_player_ms = game->state.time_ms;//aktualizuj cas posledneho hraca
+    if (game->replay) {
+        record_leave(game->replay, game->state.tick, player_id);
+    }
+}
+
+int rejoin_player(Game *game, int socket, uint64_t token) {//vrati hracovi slot po restarte servera
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    
+    int player_id = -1;
+    for (int i = 0; i < MAX_PLAYERS && token != 0; i++) {//slot caka na hraca s tymto tokenom
+        if (game->client_connected[i] && game->rejoin_deadline_ms[i] > 0 && game->rejoin_tokens[i] == token) {
+            player_id = i;
+            break;
+        }
+    }
+    if (player_id == -1 || game->state.game_over) {
+        pthread_mutex_unlock(&game->mutex);
+        return -1;//chyba
+    }
+    
+    game->rejoin_deadline_ms[player_id] = 0;//slot uz necaka
+    game->client_sockets[player_id] = socket;//uloz socket
+    game->acked_tick[player_id] = -1;//klient dostane keyframe
+    game->codecs[player_id] = CODEC_NONE;
+    attach_outbound_queue(&game->out_queues[player_id], socket, game->max_dropped_frames);
+    send_joined(game, player_id);
+    enqueue_reliable(&game->out_queues[player_id], game->map_frame);//mapa ide pred prvym snapshotom
+    game->resume_at_ms[player_id] = game->state.time_ms + RESUME_COUNTDOWN_MS;//had sa pohne po countdowne
+    game->last_player_ms = game->state.time_ms;
+    broadcast_roster(game);//mena hracov (aj pre vrateneho klienta)
+    
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    return player_id;
+}
+
+bool adopt_player(Game *game, int player_id, int socket) {//pripoji odovzdane spojenie k slotu hraca
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    bool ok = player_id >= 0 && player_id < MAX_PLAYERS && game->client_connected[player_id];
+    if (ok) {
+        game->client_sockets[player_id] = socket;//uloz socket
+        game->acked_tick[player_id] = -1;//historia snapshotov sa neprenasa - klient dostane keyframe
+        game->codecs[player_id] = CODEC_NONE;
+        attach_outbound_queue(&game->out_queues[player_id], socket, game->max_dropped_frames);
+    }
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    return ok;
+}
+
+void set_player_codec(Game *game, int player_id, Codec codec) {//kodek snapshotov hraca
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    if (player_id >= 0 && player_id < MAX_PLAYERS && game->client_connected[player_id]) {
+        game->codecs[player_id] = codec;
+    }
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+}
+
+bool check_player_token(Game *game, int player_id, uint64_t token) {//over token hraca (UDP hello)
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    bool ok = player_id >= 0 && player_id < MAX_PLAYERS && game->client_connected[player_id] && token != 0 &&
+              game->rejoin_tokens[player_id] == token;
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    return ok;
+}
+
 void remove_player(Game *game, int player_id) {//odstrani hraca z hry
     pthread_mutex_lock(&game->mutex);//zamkni mutex
     
     if (player_id >= 0 && player_id < MAX_PLAYERS && game->client_connected[player_id]) {//ak je hraci ID platne
-        game->state.snakes[player_id].alive = false;//had umrie
-        game->client_connected[player_id] = false;//odpoj hraca
-        game->state.player_count--;//zniz pocet hracov
-        game->last_player_time = time(NULL);//aktualizuj cas posledneho hraca
+        drop_player(game, player_id);
+    }
+    
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+}
+
+void stop_replay(Game *game) {//ukonci nahravanie hry
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    ReplayWriter *replay = game->replay;
+    if (replay) {
+        record_end(replay, game->state.tick, hash_game_state(&game->state));//hash na overenie prehravania
+        game->replay = NULL;//dalsie udalosti sa uz nezaznamenaju
+    }
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    close_replay(replay);//dopisanie suboru uz nedrzi hru
+}
+
+static void encode_keyframe(Game *game, ReplayBuffer *out) {//zakoduje cely stav simulacie (mutex musi byt zamknuty)
+    const GameState *state = &game->state;
+    replay_put_varint(out, (uint32_t)state->tick);
+    replay_put_u64(out, (uint64_t)state->time_ms);
+    replay_put_varint(out, (uint32_t)state->elapsed_time);
+    replay_put_u8(out, state->game_over ? 1 : 0);
+    replay_put_varint(out, (uint32_t)state->player_count);
+    replay_put_u64(out, (uint64_t)game->last_player_ms);
+    replay_put_varint(out, (uint32_t)game->next_serial);
+    for (int i = 0; i < 4; i++) {//generator - dalsie jedlo bude rovnake
+        replay_put_u64(out, game->rng.s[i]);
+    }
+    
+    for (int i = 0; i < MAX_PLAYERS; i++) {//vsetky sloty (aj mrtvi hadi, klienti ich vykresluju)
+        const Snake *snake = &state->snakes[i];
+        replay_put_u8(out, (uint8_t)((game->client_connected[i] ? 1 : 0) | (snake->alive ? 2 : 0) | (snake->paused ? 4 : 0)));
+        replay_put_u64(out, (uint64_t)game->resume_at_ms[i]);
+        replay_put_varint(out, (uint32_t)snake->length);
+        Position previous = { 0, 0 };
+        for (int j = 0; j < snake->length; j++) {//segmenty ako rozdiel voci predchadzajucemu (vacsinou +-1)
+            Position segment = snake_segment(snake, j);
+            replay_put_svarint(out, segment.x - previous.x);
+            replay_put_svarint(out, segment.y - previous.y);
+            previous = segment;
+        }
+        replay_put_u8(out, (uint8_t)snake->direction);
+        replay_put_u8(out, (uint8_t)snake->turn_count);
+        for (int j = 0; j < snake->turn_count; j++) {
+            replay_put_u8(out, (uint8_t)snake->turns[j]);
+        }
+        replay_put_varint(out, (uint32_t)snake->score);
+        replay_put_string(out, snake->name, sizeof(snake->name));
+        replay_put_varint(out, (uint32_t)snake->spawn_time);
+        replay_put_varint(out, (uint32_t)snake->serial);
+        replay_put_varint(out, (uint32_t)snake->steps);
+    }
+    
+    replay_put_varint(out, (uint32_t)state->food_count);
+    for (int i = 0; i < state->food_count; i++) {
+        replay_put_varint(out, (uint32_t)state->food[i].x);
+        replay_put_varint(out, (uint32_t)state->food[i].y);
+    }
+    
+    // Free-cell order decides where food spawns; it is mostly ascending, so store it as runs
+    const OccupancyGrid *grid = &game->occupancy;
+    replay_put_varint(out, (uint32_t)grid->free_count);
+    int previous = -1;
+    for (int i = 0; i < grid->free_count;) {
+        int run = 1;
+        while (i + run < grid->free_count && grid->free_cells[i + run] == grid->free_cells[i] + run) {
+            run++;
+        }
+        replay_put_svarint(out, grid->free_cells[i] - previous);
+        replay_put_varint(out, (uint32_t)run);
+        previous = grid->free_cells[i] + run - 1;
+        i += run;
+    }
+}
+
+static void record_game_keyframe(Game *game) {//zapise keyframe do zaznamu (mutex musi byt zamknuty)
+    ReplayBuffer *keyframe = begin_keyframe(game->replay);
+    encode_keyframe(game, keyframe);
+    record_keyframe(game->replay, game->state.tick, hash_game_state(&game->state));
+}
+
+typedef struct {//dekodovany keyframe (pred pouzitim sa cely overi)
+    GameState state;
+    int64_t last_player_ms;
+    int next_serial;
+    Rng rng;
+    bool connected[MAX_PLAYERS];
+    int64_t resume_at_ms[MAX_PLAYERS];
+    int *free_cells;
+    int free_count;
+} Keyframe;
+
+static bool in_map(const Game *game, Position pos) {//pozicia je na mape
+    return pos.x >= 0 && pos.x < game->state.width && pos.y >= 0 && pos.y < game->state.height;
+}
+
+static bool decode_keyframe(Game *game, ReplayReader *in, Keyframe *keyframe) {//precita a overi keyframe (bez zmeny hry)
+    GameState *state = &keyframe->state;
+    state->tick = (int)replay_get_varint(in);
+    state->time_ms = (int64_t)replay_get_u64(in);
+    state->elapsed_time = (int)replay_get_varint(in);
+    state->game_over = replay_get_u8(in) != 0;
+    state->player_count = (int)replay_get_varint(in);
+    keyframe->last_player_ms = (int64_t)replay_get_u64(in);
+    keyframe->next_serial = (int)replay_get_varint(in);
+    for (int i = 0; i < 4; i++) {
+        keyframe->rng.s[i] = replay_get_u64(in);
+    }
+    if (state->player_count > MAX_PLAYERS) {
+        return false;
+    }
+    
+    for (int i = 0; i < MAX_PLAYERS && !in->error; i++) {
+        Snake *snake = &state->snakes[i];
+        uint8_t flags = replay_get_u8(in);
+        keyframe->connected[i] = (flags & 1) != 0;
+        snake->alive = (flags & 2) != 0;
+        snake->paused = (flags & 4) != 0;
+        keyframe->resume_at_ms[i] = (int64_t)replay_get_u64(in);
+        snake->player_id = i;
+        snake->length = (int)replay_get_varint(in);
+        if (snake->length > MAX_SNAKE_LENGTH) {
+            return false;
+        }
+        Position previous = { 0, 0 };
+        for (int j = 0; j < snake->length; j++) {
+            previous.x += replay_get_svarint(in);
+            previous.y += replay_get_svarint(in);
+            if (snake->alive && !in_map(game, previous)) {//zivy had lezi na mape
+                return false;
+            }
+            snake->positions[j] = previous;//hlava na indexe 0
+        }
+        snake->direction = (Direction)replay_get_u8(in);
+        snake->turn_count = replay_get_u8(in);
+        if (snake->direction > DIR_NONE || snake->turn_count > TURN_QUEUE_SIZE) {
+            return false;
+        }
+        for (int j = 0; j < snake->turn_count; j++) {
+            snake->turns[j] = (Direction)replay_get_u8(in);
+            if (snake->turns[j] > DIR_NONE) {
+                return false;
+            }
+        }
+        snake->score = (int)replay_get_varint(in);
+        replay_get_string(in, snake->name, sizeof(snake->name));
+        snake->spawn_time = (int)replay_get_varint(in);
+        snake->serial = (int)replay_get_varint(in);
+        snake->steps = (int)replay_get_varint(in);
+        if (snake->alive && (snake->length == 0 || !keyframe->connected[i])) {//zivy had patri pripojenemu hracovi
+            return false;
+        }
+    }
+    
+    state->food_count = (int)replay_get_varint(in);
+    if (state->food_count > MAX_PLAYERS) {
+        return false;
+    }
+    for (int i = 0; i < state->food_count; i++) {
+        state->food[i].x = (int)replay_get_varint(in);
+        state->food[i].y = (int)replay_get_varint(in);
+        if (!in_map(game, state->food[i])) {
+            return false;
+        }
     }
     
+    uint32_t free_count = replay_get_varint(in);
+    if (in->error || free_count > (uint32_t)(game->state.width * game->state.height)) {
+        return false;
+    }
+    keyframe->free_cells = malloc((free_count ? free_count : 1) * sizeof(int));
+    if (!keyframe->free_cells) {
+        return false;
+    }
+    int previous = -1;
+    while (keyframe->free_count < (int)free_count && !in->error) {//behy po sebe iducich buniek
+        int start = previous + replay_get_svarint(in);
+        uint32_t run = replay_get_varint(in);
+        if (run == 0 || run > free_count - (uint32_t)keyframe->free_count) {
+            return false;
+        }
+        for (uint32_t j = 0; j < run; j++) {
+            keyframe->free_cells[keyframe->free_count++] = start + (int)j;
+        }
+        previous = start + (int)run - 1;
+    }
+    return !in->error;
+}
+
+bool restore_keyframe(Game *game, ReplayReader *payload) {//obnovi stav simulacie z keyframu zaznamu
+    Keyframe *keyframe = calloc(1, sizeof(Keyframe));
+    if (!keyframe) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    bool ok = decode_keyframe(game, payload, keyframe);
+    
+    OccupancyGrid grid;//mriezka noveho stavu, stara ostava pri chybe platna
+    if (ok) {
+        ok = init_occupancy_grid(&grid, game->state.width, game->state.height, game->state.obstacles);
+    }
+    if (ok) {
+        for (int i = 0; i < MAX_PLAYERS; i++) {//mriezka obsahuje zivych hadov a jedlo
+            if (keyframe->state.snakes[i].alive) {
+                occupy_snake(&grid, &keyframe->state.snakes[i]);
+            }
+        }
+        for (int i = 0; i < keyframe->state.food_count; i++) {
+            place_food(&grid, keyframe->state.food[i]);
+        }
+        ok = set_free_cell_order(&grid, keyframe->free_cells, keyframe->free_count);//rovnake poradie = rovnake jedlo
+        if (!ok) {
+            destroy_occupancy_grid(&grid);
+        }
+    }
+    
+    if (ok) {
+        PlayerCommand command;
+        while (pop_command(&game->commands, &command)) {//prikazy patria k povodnemu stavu
+        }
+        destroy_occupancy_grid(&game->occupancy);
+        game->occupancy = grid;
+        
+        GameState *state = &game->state;
+        const GameState *restored = &keyframe->state;
+        state->tick = restored->tick;
+        state->time_ms = restored->time_ms;
+        state->elapsed_time = restored->elapsed_time;
+        state->game_over = restored->game_over;
+        state->player_count = restored->player_count;
+        memcpy(state->snakes, restored->snakes, sizeof(state->snakes));
+        memcpy(state->food, restored->food, sizeof(state->food));
+        state->food_count = restored->food_count;
+        game->last_player_ms = keyframe->last_player_ms;
+        game->next_serial = keyframe->next_serial;
+        game->rng = keyframe->rng;
+        for (int i = 0; i < MAX_PLAYERS; i++) {
+            game->client_connected[i] = keyframe->connected[i];
+            game->client_sockets[i] = -1;//spojenia nie su sucastou stavu
+            game->resume_at_ms[i] = keyframe->resume_at_ms[i];
+            game->acked_tick[i] = -1;
+        }
+        for (int i = 0; i < STATE_HISTORY_SIZE; i++) {//baseline sa viazu na povodne ring buffery hadov
+            game->history[i].tick = -1;
+        }
+    }
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    
+    free(keyframe->free_cells);
+    free(keyframe);
+    return ok;
+}
+
+bool encode_checkpoint(Game *game, ReplayBuffer *out) {//zakoduje checkpoint beziacej hry
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    bool running = !game->state.game_over;
+    if (running) {
+        encode_keyframe(game, out);//cely stav simulacie
+        for (int i = 0; i < MAX_PLAYERS; i++) {//hraci sa po restarte vratia do svojich slotov
+            replay_put_u64(out, game->client_connected[i] ? game->rejoin_tokens[i] : 0);
+        }
+    }
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    return running;
+}
+
+bool restore_checkpoint(Game *game, ReplayReader *in, bool live) {//obnovi hru z checkpointu
+    if (!restore_keyframe(game, in)) {
+        return false;
+    }
+    
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        uint64_t token = replay_get_u64(in);
+        if (!game->client_connected[i]) {
+            continue;
+        }
+        game->rejoin_tokens[i] = token;
+        if (live) {//spojenie prevezme adopt_player, had ide dalej
+            continue;
+        }
+        game->rejoin_deadline_ms[i] = game->state.time_ms + REJOIN_TIMEOUT_MS;//slot caka na hraca
+        game->state.snakes[i].paused = true;//had stoji, kym sa hrac nevrati
+        game->resume_at_ms[i] = 0;
+    }
+    bool ok = !in->error;
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    return ok;
+}
+
+void get_game_summary(Game *game, GameSummary *summary) {//zhrnutie hry pre lobby
+    memset(summary, 0, sizeof(GameSummary));//bez nahodnych bajtov (porovnava sa cez memcmp)
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    summary->game_id = game->state.game_id;
+    summary->mode = game->state.mode;
+    summary->obstacles = game->config.world_type == WORLD_WITH_OBSTACLES;
+    summary->width = game->state.width;
+    summary->height = game->state.height;
+    summary->player_count = game->state.player_count;
+    summary->max_players = game->state.max_players;
+    summary->elapsed_time = game->state.elapsed_time;
+    summary->time_limit = game->state.time_limit;
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+}
+
+void disconnect_players(Game *game) {//odpoji vsetkych klientov (hra skoncila)
+    pthread_mutex_lock(&game->mutex);//zamkni mutex
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (game->client_connected[i]) {
+            shutdown_outbound_queue(&game->out_queues[i]);//event loop zatvori spojenie
+        }
+    }
     pthread_mutex_unlock(&game->mutex);//odomkni mutex
 }
 
@@ -195,31 +743,11 @@ void generate_food(Game *game) {//generuje jedlo na mape
     
     while (game->state.food_count < target_food) {//kym nemame dost jedla
         Position food_pos;//pozicia jedla
-        bool valid = false;
-        int attempts = 0;//pocet pokusov
-        
-        while (!valid && attempts < 100) {//skus najst platnu poziciu (max 100 pokusov)
-            food_pos.x = rand() % game->state.width;//nahodna x pozicia
-            food_pos.y = rand() % game->state.height;//nahodna y pozicia
-            
-            // Check if position is valid
-            valid = is_valid_position(game, food_pos);//over ci je pozicia platna (nie prekazka, nie had)
-            
-            // Check if food already exists here
-            for (int i = 0; i < game->state.food_count && valid; i++) {//over ci tam uz nie je jedlo
-                if (game->state.food[i].x == food_pos.x && game->state.food[i].y == food_pos.y) {
-                    valid = false;
-                }
-            }
-            
-            attempts++;
-        }
-        
-        if (valid) {//ak sa nasla platna pozicia
-            game->state.food[game->state.food_count++] = food_pos;//pridaj jedlo
-        } else {
-            break;//inak skonci
+        if (!random_free_cell(&game->occupancy, &game->rng, &food_pos)) {//ziadna volna bunka (mapa je plna)
+            break;
         }
+        place_food(&game->occupancy, food_pos);//bunka uz nie je volna
+        game->state.food[game->state.food_count++] = food_pos;//pridaj jedlo
     }
 }
 
@@ -235,24 +763,31 @@ bool is_valid_position(Game *game, Position pos) {//skontroluje ci je pozicia pl
     }
     
     // Check snakes
-    for (int i = 0; i < MAX_PLAYERS; i++) {//over vsetkych hadov
-        if (game->client_connected[i] && is_position_on_snake(&game->state.snakes[i], pos)) {//pozicia je na hadovi
-            return false;
-        }
+    if (is_snake_cell(&game->occupancy, pos)) {//pozicia je na hadovi
+        return false;
     }
     
     return true;//pozicia je platna
 }
 
+static void kill_snake(Game *game, int player_id) {//had umrie a prestane byt prekazkou
+    vacate_snake(&game->occupancy, &game->state.snakes[player_id]);
+    game->state.snakes[player_id].alive = false;
+}
+
 void update_game(Game *game) {//aktualizuje stav hry (jeden tick)
     pthread_mutex_lock(&game->mutex);//zamkni mutex
+    apply_commands(game);//vstupy prijate od posledneho tiku
+    
+    game->state.tick++;//dalsi tick simulacie
     
-    // Update elapsed time
-    game->state.elapsed_time = (int)(time(NULL) - game->start_time);//aktualizuj uplynuly cas
+    // Game time advances by exactly one period per tick (monotonic, independent of wall clock)
+    game->state.time_ms = (int64_t)game->state.tick * 1000 / game->tick_rate;//herny cas v ms
+    game->state.elapsed_time = (int)(game->state.time_ms / 1000);//uplynuly cas v sekundach
     
     // Check timed mode
     if (game->state.mode == MODE_TIMED && game->state.time_limit > 0) {//ak je casovany mod
-        if (game->state.elapsed_time >= game->state.time_limit) {//cas vyprsal
+        if (game->state.time_ms >= (int64_t)game->state.time_limit * 1000) {//cas vyprsal (presne na tiku limitu)
             game->state.game_over = true;//hra konci
             pthread_mutex_unlock(&game->mutex);
             return;
@@ -261,20 +796,25 @@ void update_game(Game *game) {//aktualizuje stav hry (jeden tick)
     
     // Check standard mode (10 seconds without players)
     if (game->state.mode == MODE_STANDARD && game->state.player_count == 0) {//standardny mod bez hracov
-        if (time(NULL) - game->last_player_time >= 10) {//10 sekund bez hracov
+        if (game->state.time_ms - game->last_player_ms >= EMPTY_GAME_TIMEOUT_MS) {//10 sekund bez hracov
             game->state.game_over = true;//hra konci
             pthread_mutex_unlock(&game->mutex);
             return;
         }
     }
     
-    // Update pause countdowns (only for resume countdown)
-    for (int i = 0; i < MAX_PLAYERS; i++) {//aktualizuj pause countdown pre kazdeho hraca
-        if (game->pause_countdown[i] > 0) {//ak bezi countdown
-            game->pause_countdown[i]--;//zniz o 1
-            if (game->pause_countdown[i] == 0) {//ak sa countdown skoncil
-                game->state.snakes[i].paused = false;//zrus pauzu
-            }
+    // Drop restored slots whose player did not come back
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (game->rejoin_deadline_ms[i] > 0 && game->state.time_ms >= game->rejoin_deadline_ms[i]) {
+            drop_player(game, i);
+        }
+    }
+    
+    // Update resume countdowns
+    for (int i = 0; i < MAX_PLAYERS; i++) {//skontroluj countdown kazdeho hraca
+        if (game->resume_at_ms[i] > 0 && game->state.time_ms >= game->resume_at_ms[i]) {//countdown sa skoncil
+            game->resume_at_ms[i] = 0;
+            game->state.snakes[i].paused = false;//zrus pauzu
         }
     }
     
@@ -283,8 +823,15 @@ void update_game(Game *game) {//aktualizuje stav hry (jeden tick)
                         is_obstacle(game->state.obstacles, 0, 0, game->state.width) == false);
     
     for (int i = 0; i < MAX_PLAYERS; i++) {//pohni vsetkymi hadmi
-        if (game->client_connected[i] && game->state.snakes[i].alive && !game->state.snakes[i].paused) {//ak je zivy a nie pozastaveny
-            move_snake(&game->state.snakes[i], game->state.width, game->state.height, wrap_around);//pohni hadom
+        Snake *snake = &game->state.snakes[i];
+        if (game->client_connected[i] && snake->alive && !snake->paused) {//ak je zivy a nie pozastaveny
+            Position old_head = snake_segment(snake, 0);
+            Position old_tail = snake_segment(snake, snake->length - 1);
+            int steps = snake->steps;
+            move_snake(snake, game->state.width, game->state.height, wrap_around);//pohni hadom
+            if (snake->steps != steps) {//had sa pohol - posun ho aj v mriezke
+                advance_snake(&game->occupancy, old_head, old_tail, snake_segment(snake, 0));
+            }
         }
     }
     
@@ -294,44 +841,40 @@ void update_game(Game *game) {//aktualizuje stav hry (jeden tick)
             continue;
         }
         
-        Position head = game->state.snakes[i].positions[0];//pozicia hlavy hada
+        Position head = snake_segment(&game->state.snakes[i], 0);//pozicia hlavy hada
         
         // Check wall collision (if not wrapping)
         if (!wrap_around) {
             if (head.x < 0 || head.x >= game->state.width ||//had vysel mimo hranice
                 head.y < 0 || head.y >= game->state.height) {
-                game->state.snakes[i].alive = false;//had umiera
+                kill_snake(game, i);//had umiera
                 continue;
             }
         }
         
         // Check obstacle collision
         if (game->state.obstacles && is_obstacle(game->state.obstacles, head.x, head.y, game->state.width)) {//narazil do prekazky
-            game->state.snakes[i].alive = false;//had umiera
+            kill_snake(game, i);//had umiera
             continue;
         }
         
-        // Check self collision
-        if (check_self_collision(&game->state.snakes[i])) {//narazil sam do seba
-            game->state.snakes[i].alive = false;//had umiera
+        // Check collision with any body (own or other live snake), heads may share a cell
+        if (is_body_cell(&game->occupancy, head)) {//narazil do tela
+            kill_snake(game, i);//had umiera
             continue;
         }
         
-        // Check collision with other snakes
-        for (int j = 0; j < MAX_PLAYERS; j++) {//over kolizie s inymi hadmi
-            if (i != j && game->client_connected[j]) {
-                if (check_collision_with_snake(&game->state.snakes[i], &game->state.snakes[j])) {//narazil do ineho hada
-                    game->state.snakes[i].alive = false;//had umiera
-                    break;
-                }
-            }
-        }
-        
         // Check food collision
         for (int f = 0; f < game->state.food_count; f++) {//over kolizie s jedlom
             if (head.x == game->state.food[f].x && head.y == game->state.food[f].y) {//zjedol jedlo
-                grow_snake(&game->state.snakes[i]);//zvacsi hada
+                Snake *snake = &game->state.snakes[i];
+                int length = snake->length;
+                grow_snake(snake);//zvacsi hada
+                if (snake->length != length) {//novy segment je duplikat chvosta
+                    occupy_segment(&game->occupancy, snake_segment(snake, snake->length - 1));
+                }
                 // Remove this food and shift array
+                remove_food(&game->occupancy, game->state.food[f]);//hlava hada drzi bunku obsadenu
                 for (int k = f; k < game->state.food_count - 1; k++) {//odstran jedlo z pola
                     game->state.food[k] = game->state.food[k + 1];
                 }
@@ -344,57 +887,159 @@ void update_game(Game *game) {//aktualizuje stav hry (jeden tick)
     // Generate food if needed
     generate_food(game);//vygeneruj nove jedlo ak treba
     
+    if (game->replay && game->state.tick % REPLAY_KEYFRAME_INTERVAL == 0) {//keyframe pre rychle pretacanie zaznamu
+        record_game_keyframe(game);
+    }
+    
     pthread_mutex_unlock(&game->mutex);//odomkni mutex
 }
 
+static Snapshot *encode_snapshot(Game *game, const StateBaseline *baseline, size_t capacity) {//zakoduje stav ako deltu alebo keyframe (mutex musi byt zamknuty)
+    uint8_t *scratch = game->scratch.data;
+    size_t size = 0;
+    if (baseline) {//delta voci potvrdenemu snapshotu
+        size = serialize_state_delta(baseline, &game->state, scratch, capacity);
+    }
+    if (size == 0) {//keyframe (alebo sa delta nezmestila)
+        serialize_game_state(&game->state, scratch, &size);
+    }
+    
+    Snapshot *snapshot = create_snapshot(size);
+    if (snapshot) {
+        memcpy(snapshot->data + FRAME_HEADER_SIZE, scratch, size);
+    }
+    return snapshot;
+}
+
+static Snapshot *pack_snapshot(Game *game, Snapshot *raw, Codec codec) {//skomprimuje snapshot kodekom klienta (nova referencia)
+    const uint8_t *payload = raw->data + FRAME_HEADER_SIZE;
+    size_t size = raw->size - FRAME_HEADER_SIZE;
+    if (codec != CODEC_NONE && reserve_message_buffer(&game->packed, size)) {
+        size_t packed_size = compress_message(codec, payload, size, game->packed.data, size - 1);//len ak usetri bajty
+        if (packed_size > 0) {
+            Snapshot *snapshot = create_snapshot(packed_size);
+            if (snapshot) {
+                memcpy(snapshot->data + FRAME_HEADER_SIZE, game->packed.data, packed_size);
+            }
+            return snapshot;
+        }
+    }
+    return retain_snapshot(raw);//bez kompresie sa zdiela nekomprimovany snapshot
+}
+
 void broadcast_game_state(Game *game) {//posle aktualny stav hry vsetkym pripojenym klientom
+    OutboundQueue *targets[MAX_PLAYERS];//fronty klientov, ktorym sa posle snapshot
+    Snapshot *raw[MAX_PLAYERS];//nekomprimovany snapshot pre kazdeho klienta
+    Codec codecs[MAX_PLAYERS];//kodek kazdeho klienta
+    int target_count = 0;
+    
+    Snapshot *encoded[MAX_PLAYERS];//snapshoty zakodovane v tomto tiku
+    int encoded_baseline[MAX_PLAYERS];//baseline kazdeho zakodovaneho snapshotu (-1 = keyframe)
+    int encoded_count = 0;
+    
     pthread_mutex_lock(&game->mutex);//zamkni mutex
     
-    Message msg;//vytvor spravu
-    msg.type = MSG_GAME_STATE;//typ spravy - stav hry
-    msg.player_id = -1;//ziadny konkretny hrac
-    msg.data.state = game->state;//skopiruj stav hry
+    // Record compact baseline (only this thread writes history); bodies stay in the snake ring buffers
+    int tick = game->state.tick;
+    capture_state_baseline(&game->state, &game->history[tick % STATE_HISTORY_SIZE]);
+    bool keyframe = (tick % KEYFRAME_INTERVAL) == 0;//periodicky keyframe pre vsetkych
+    bool final = game->state.game_over;
+    size_t capacity = game_state_message_size(&game->state);//delta nie je nikdy vacsia ako keyframe
     
-    uint8_t buffer[BUFFER_SIZE];//buffer pre serializaciu
-    size_t size;
-    serialize_message(&msg, buffer, &size);//serializuj spravu
+    // Encode live state once per distinct baseline (no copy of the state)
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (!game->client_connected[i]) {
+            continue;
+        }
+        int acked = game->acked_tick[i];
+        bool usable = !keyframe && acked >= 0 && acked <= tick && tick - acked < STATE_HISTORY_SIZE &&
+                      game->history[acked % STATE_HISTORY_SIZE].tick == acked;//baseline je este v historii
+        int baseline = usable ? acked : -1;
+        
+        Snapshot *snapshot = NULL;
+        for (int e = 0; e < encoded_count; e++) {//hladaj uz zakodovany snapshot s rovnakou baseline
+            if (encoded_baseline[e] == baseline) {
+                snapshot = encoded[e];
+                break;
+            }
+        }
+        if (!snapshot && reserve_message_buffer(&game->scratch, capacity)) {//pracovny buffer (znovupouzity kazdy tick)
+            snapshot = encode_snapshot(game, usable ? &game->history[acked % STATE_HISTORY_SIZE] : NULL, capacity);
+            if (snapshot) {
+                encoded[encoded_count] = snapshot;
+                encoded_baseline[encoded_count] = baseline;
+                encoded_count++;
+            }
+        }
+        if (!snapshot) {
+            continue;
+        }
+        targets[target_count] = &game->out_queues[i];
+        raw[target_count] = snapshot;
+        codecs[target_count] = game->codecs[i];
+        target_count++;
+    }
+    
+    pthread_mutex_unlock(&game->mutex);//odomkni mutex (kompresia a posielanie uz nedrzi hru)
+    
+    // Compress once per distinct snapshot and codec and share the result
+    Snapshot *packed[MAX_PLAYERS];//uz skomprimovane snapshoty
+    const Snapshot *packed_raw[MAX_PLAYERS];//zdroj kazdeho skomprimovaneho snapshotu
+    Codec packed_codec[MAX_PLAYERS];//kodek kazdeho skomprimovaneho snapshotu
+    int packed_count = 0;
     
-    for (int i = 0; i < MAX_PLAYERS; i++) {//posli vsetkym pripojenym klientom
-        if (game->client_connected[i] && game->client_sockets[i] >= 0) {
-            send_data(game->client_sockets[i], buffer, size);//posli data
+    for (int i = 0; i < target_count; i++) {//zarad snapshot do fronty kazdeho klienta
+        Snapshot *snapshot = NULL;
+        for (int p = 0; p < packed_count; p++) {
+            if (packed_raw[p] == raw[i] && packed_codec[p] == codecs[i]) {
+                snapshot = packed[p];
+                break;
+            }
+        }
+        if (!snapshot) {
+            snapshot = pack_snapshot(game, raw[i], codecs[i]);
+            if (!snapshot) {
+                continue;
+            }
+            packed[packed_count] = snapshot;
+            packed_raw[packed_count] = raw[i];
+            packed_codec[packed_count] = codecs[i];
+            packed_count++;
+        }
+        if (final) {//finalny stav ide cez TCP (UDP by ho mohol stratit)
+            enqueue_reliable(targets[i], snapshot);
+        } else {
+            enqueue_snapshot(targets[i], snapshot);
         }
     }
     
-    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    for (int p = 0; p < packed_count; p++) {//fronty drzia vlastne referencie
+        release_snapshot(packed[p]);
+    }
+    for (int e = 0; e < encoded_count; e++) {
+        release_snapshot(encoded[e]);
+    }
 }
 
-void handle_player_input(Game *game, int player_id, Direction direction) {//spracuje vstup od hraca (zmena smeru)
+void acknowledge_state(Game *game, int player_id, int tick) {//zaznamena snapshot potvrdeny klientom
     pthread_mutex_lock(&game->mutex);//zamkni mutex
     
-    if (player_id >= 0 && player_id < MAX_PLAYERS && game->client_connected[player_id]) {//ak je hrac platny
-        change_direction(&game->state.snakes[player_id], direction);//zmen smer hada
+    if (player_id >= 0 && player_id < MAX_PLAYERS && game->client_connected[player_id] &&
+        tick > game->acked_tick[player_id] && tick <= game->state.tick) {//novsi platny tick
+        game->acked_tick[player_id] = tick;
     }
     
     pthread_mutex_unlock(&game->mutex);//odomkni mutex
 }
 
+void handle_player_input(Game *game, int player_id, Direction direction) {//spracuje vstup od hraca (zmena smeru)
+    queue_command(game, COMMAND_DIRECTION, player_id, direction);
+}
+
 void pause_player(Game *game, int player_id) {//pozastavi hada hraca
-    pthread_mutex_lock(&game->mutex);//zamkni mutex
-    
-    if (player_id >= 0 && player_id < MAX_PLAYERS && game->client_connected[player_id]) {//ak je hrac platny
-        game->state.snakes[player_id].paused = true;//pozastav hada
-        game->pause_countdown[player_id] = 0;//vynuluj countdown
-    }
-    
-    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    queue_command(game, COMMAND_PAUSE, player_id, DIR_UP);
 }
 
 void resume_player(Game *game, int player_id) {//obnovi pohyb hada hraca
-    pthread_mutex_lock(&game->mutex);//zamkni mutex
-    
-    if (player_id >= 0 && player_id < MAX_PLAYERS && game->client_connected[player_id]) {//ak je hrac platny
-        game->pause_countdown[player_id] = 30;//nastav 3 sekundovy countdown (10 ticks/sec)
-    }
-    
-    pthread_mutex_unlock(&game->mutex);//odomkni mutex
+    queue_command(game, COMMAND_RESUME, player_id, DIR_UP);
 }
@@ -11,11 +11,33 @@
 
 #include "protocol.h"
 #include "snake.h"
+#include "outbound.h"
+#include "occupancy.h"
+#include "network.h"
+#include "lobby.h"
+#include "tick_scheduler.h"
+#include "command_queue.h"
+#include "rng.h"
+#include "replay_log.h"
+#include "compress.h"
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 
-/** Game update frequency (ticks per second) */
-#define TICK_RATE 10
+/** Default game update frequency (ticks per second) */
+#define DEFAULT_TICK_RATE 10
+
+/** Highest allowed tick rate */
+#define MAX_TICK_RATE 100
+
+/** Countdown after join or resume before snake starts moving (game time, ms) */
+#define RESUME_COUNTDOWN_MS 3000
+
+/** Standard mode ends after this much game time without players (ms) */
+#define EMPTY_GAME_TIMEOUT_MS 10000
+
+/** Restored slot waits this much game time for its player to rejoin (ms) */
+#define REJOIN_TIMEOUT_MS 30000
 
 /**
  * @brief Main game structure
@@ -27,37 +49,133 @@ typedef struct {
     GameState state;                        /**< Current game state */
     GameConfig config;                      /**< Game configuration */
     pthread_mutex_t mutex;                  /**< Mutex for thread-safe access */
-    bool running;                           /**< Is game loop running */
-    time_t start_time;                      /**< Game start timestamp */
-    time_t last_player_time;                /**< Last time a player was connected */
+    atomic_bool running;                    /**< Is game loop running */
+    int64_t last_player_ms;                 /**< Game time when a player was last connected */
     int client_sockets[MAX_PLAYERS];        /**< Client socket descriptors */
     bool client_connected[MAX_PLAYERS];     /**< Client connection status */
-    pthread_t client_threads[MAX_PLAYERS];  /**< Client handler threads */
-    int pause_countdown[MAX_PLAYERS];       /**< Countdown after resume/join (ticks) */
+    int64_t resume_at_ms[MAX_PLAYERS];      /**< Game time the resume countdown ends (0 = none) */
+    OutboundQueue out_queues[MAX_PLAYERS];  /**< Per-client outbound snapshot queues */
+    int max_dropped_frames;                 /**< Slow client drop limit (0 = keep newest only) */
+    StateBaseline history[STATE_HISTORY_SIZE]; /**< Recent broadcast snapshots without bodies (delta baselines) */
+    int acked_tick[MAX_PLAYERS];            /**< Last snapshot tick acknowledged by client (-1 = none) */
+    int next_serial;                        /**< Spawn serial for next snake */
+    Snapshot *map_frame;                    /**< Encoded MSG_MAP, queued once per joining client */
+    MessageBuffer scratch;                  /**< Snapshot encoding buffer (tick thread only) */
+    MessageBuffer packed;                   /**< Compressed snapshot buffer (tick thread only) */
+    Codec codecs[MAX_PLAYERS];              /**< Snapshot codec of client (negotiated at join) */
+    OccupancyGrid occupancy;                /**< Cells covered by live connected snakes */
+    atomic_int refcount;                    /**< Holders (registry + connections in game) */
+    pthread_t thread;                       /**< Tick thread */
+    atomic_bool finished;                   /**< Tick thread has ended (game can be reaped) */
+    Lobby *lobby;                           /**< Lobby index the game publishes its summary to */
+    int tick_rate;                          /**< Ticks per second */
+    TickScheduler scheduler;                /**< Tick deadlines and timing counters (tick thread only) */
+    uint64_t seed;                          /**< Seed of rng (reproduces map and food) */
+    Rng rng;                                /**< Map and food generator (under mutex) */
+    ReplayWriter *replay;                   /**< Replay being recorded (NULL = none, under mutex) */
+    CommandQueue commands;                  /**< Player commands waiting for the next tick (drained under mutex) */
+    uint64_t rejoin_tokens[MAX_PLAYERS];    /**< Token that takes the slot back after a restart (0 = none) */
+    int64_t rejoin_deadline_ms[MAX_PLAYERS]; /**< Game time a restored slot waits for its player until (0 = not waiting) */
+    uint64_t token_state;                   /**< splitmix64 state of rejoin tokens (independent of rng) */
+    atomic_bool suspended;                  /**< Tick thread stopped for handoff, players stay connected */
+    bool thread_started;                    /**< Tick thread was created and not joined yet (registry mutex) */
 } Game;
 
 /**
  * @brief Create new game instance
  * @param config Game configuration
- * @return Pointer to created game, or NULL on failure
+ * @return Pointer to created game with refcount 1, or NULL on failure
+ *
+ * Game ID is assigned by the registry. The game's generator is seeded with
+ * config->seed, so equal seeds give equal maps and food.
  */
 Game *create_game(const GameConfig *config);
 
+/**
+ * @brief Create game on saved map (checkpoint restore)
+ * @param config Game configuration
+ * @param obstacles Obstacle bitmap (width * height), owned by the game
+ * @param width Map width
+ * @param height Map height
+ * @return Pointer to created game with refcount 1, or NULL on failure
+ *         (obstacles are freed)
+ */
+Game *create_game_with_map(const GameConfig *config, uint8_t *obstacles, int width, int height);
+
 /**
  * @brief Destroy game and free resources
  * @param game Game instance to destroy
  */
 void destroy_game(Game *game);
 
+/**
+ * @brief Take additional reference to game
+ * @param game Game instance
+ * @return The same game
+ */
+Game *retain_game(Game *game);
+
+/**
+ * @brief Drop reference to game, destroy it with the last one
+ * @param game Game instance (may be NULL)
+ */
+void release_game(Game *game);
+
 /**
  * @brief Add player to game
  * @param game Game instance
  * @param socket Client socket descriptor
  * @param name Player name
- * @return Player ID (0-7) on success, -1 on failure
+ * @return Player ID (0-7) on success, -1 if game is full or over
  */
 int add_player(Game *game, int socket, const char *name);
 
+/**
+ * @brief Give player back the slot kept for them after a restart
+ * @param game Game instance
+ * @param socket Client socket descriptor
+ * @param token Rejoin token received in MSG_JOINED
+ * @return Player ID on success, -1 if no waiting slot has this token
+ *
+ * The snake continues where the checkpoint left it after the resume
+ * countdown.
+ */
+int rejoin_player(Game *game, int socket, uint64_t token);
+
+/**
+ * @brief Attach connection handed over by previous server process to slot
+ * @param game Game restored with restore_checkpoint(..., true), not yet started
+ * @param player_id Player slot of the connection
+ * @param socket Client socket descriptor
+ * @return true on success, false if slot has no player
+ *
+ * The client keeps its slot and snake without noticing the restart; it
+ * receives a keyframe with the next snapshot.
+ */
+bool adopt_player(Game *game, int player_id, int socket);
+
+/**
+ * @brief Check that token belongs to connected player
+ * @param game Game instance
+ * @param player_id Player slot
+ * @param token Token from MSG_JOINED
+ * @return true if the player is connected and has this token
+ *
+ * Authenticates MSG_UDP_HELLO datagrams, which arrive outside the
+ * player's TCP connection.
+ */
+bool check_player_token(Game *game, int player_id, uint64_t token);
+
+/**
+ * @brief Set codec of player's snapshots
+ * @param game Game instance
+ * @param player_id Player slot
+ * @param codec Codec negotiated with client (choose_codec)
+ *
+ * Joining, rejoining and adopted players start with CODEC_NONE.
+ */
+void set_player_codec(Game *game, int player_id, Codec codec);
+
 /**
  * @brief Remove player from game
  * @param game Game instance
@@ -65,12 +183,77 @@ int add_player(Game *game, int socket, const char *name);
  */
 void remove_player(Game *game, int player_id);
 
+/**
+ * @brief Finish replay recording of game
+ * @param game Game instance
+ *
+ * Records the final state hash and closes the replay file. Events after
+ * this call are not recorded. Does nothing if the game is not recorded.
+ */
+void stop_replay(Game *game);
+
+/**
+ * @brief Restore simulation state from replay keyframe
+ * @param game Game created from the replay's configuration
+ * @param payload Keyframe payload (see open_keyframe)
+ * @return true on success, false if payload is corrupt (game is unchanged)
+ *
+ * Restores snakes, food, timers, generator and the occupancy grid including
+ * its free-cell order, so the game continues exactly as the recorded one.
+ * Queued commands are discarded; connections are not part of the state
+ * (restored players have no socket).
+ */
+bool restore_keyframe(Game *game, ReplayReader *payload);
+
+/**
+ * @brief Encode checkpoint of running game
+ * @param game Game instance
+ * @param out Buffer to append to
+ * @return true on success, false if the game is over (nothing appended)
+ *
+ * Keyframe of the simulation state followed by the rejoin tokens of
+ * all slots.
+ */
+bool encode_checkpoint(Game *game, ReplayBuffer *out);
+
+/**
+ * @brief Restore game from checkpoint
+ * @param game Game created from the checkpoint's configuration and map
+ * @param in Checkpoint written by encode_checkpoint
+ * @param live Connections are handed over too (handoff)
+ * @return true on success, false if checkpoint is corrupt (discard game)
+ *
+ * Players of the checkpoint keep their slots without connection. After a
+ * crash their snakes stay paused until they rejoin (rejoin_player) or
+ * REJOIN_TIMEOUT_MS of game time passes and they are removed. With live
+ * the snakes keep their state; the caller attaches every handed over
+ * connection with adopt_player and removes the remaining players.
+ */
+bool restore_checkpoint(Game *game, ReplayReader *in, bool live);
+
+/**
+ * @brief Get lobby summary of game
+ * @param game Game instance
+ * @param summary Output summary
+ */
+void get_game_summary(Game *game, GameSummary *summary);
+
+/**
+ * @brief Shut down sockets of all connected players
+ * @param game Game instance
+ *
+ * Called when the game has ended; the event loop then closes
+ * the connections and removes the players.
+ */
+void disconnect_players(Game *game);
+
 /**
  * @brief Update game state for one tick
  * @param game Game instance
  * 
- * Moves snakes, checks collisions, generates food, updates timers,
- * handles pause countdowns, and checks game over conditions.
+ * Applies queued player commands, moves snakes, checks collisions,
+ * generates food, updates timers, handles pause countdowns, and checks
+ * game over conditions.
  */
 void update_game(Game *game);
 
@@ -78,7 +261,9 @@ void update_game(Game *game);
  * @brief Generate food in valid positions
  * @param game Game instance
  * 
- * Generates one food item per active snake at random valid positions.
+ * Generates one food item per active snake, each drawn uniformly from
+ * the free-cell set of the occupancy grid. Food is only missing when
+ * no free cell is left.
  */
 void generate_food(Game *game);
 
@@ -94,15 +279,31 @@ bool is_valid_position(Game *game, Position pos);
  * @brief Broadcast current game state to all connected clients
  * @param game Game instance
  * 
- * Thread-safe broadcast using mutex protection.
+ * Under the mutex records a compact baseline of the state in snapshot
+ * history and encodes the live state once per distinct client baseline:
+ * a delta against the last acknowledged snapshot, or a full keyframe for
+ * new clients, stale baselines and every KEYFRAME_INTERVAL ticks. Outside
+ * the mutex compresses each snapshot once per codec when that saves bytes.
+ * Never blocks on a slow client.
  */
 void broadcast_game_state(Game *game);
 
+/**
+ * @brief Record snapshot acknowledged by client
+ * @param game Game instance
+ * @param player_id Player ID
+ * @param tick Acknowledged snapshot tick
+ */
+void acknowledge_state(Game *game, int player_id, int tick);
+
 /**
  * @brief Handle player input (direction change)
  * @param game Game instance
  * @param player_id Player ID
  * @param direction New direction
+ *
+ * Queued without taking the game mutex, applied at the start of the next
+ * tick. Commands of a player who leaves before then are discarded.
  */
 void handle_player_input(Game *game, int player_id, Direction direction);
 
@@ -111,7 +312,8 @@ void handle_player_input(Game *game, int player_id, Direction direction);
  * @param game Game instance
  * @param player_id Player ID to pause
  * 
- * Sets paused flag and resets countdown.
+ * Sets paused flag and resets countdown at the start of the next tick
+ * (queued like handle_player_input).
  */
 void pause_player(Game *game, int player_id);
 
@@ -120,7 +322,8 @@ void pause_player(Game *game, int player_id);
  * @param game Game instance
  * @param player_id Player ID to resume
  * 
- * Starts 3-second countdown (30 ticks) before snake starts moving.
+ * Starts RESUME_COUNTDOWN_MS countdown of game time before snake starts
+ * moving. Queued like handle_player_input.
  */
 void resume_player(Game *game, int player_id);
 
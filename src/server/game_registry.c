@@ -0,0 +1,326 @@
+#include "game_registry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void print_tick_stats(const Game *game) {//vypise casovanie tikov hry
+    const TickStats *stats = &game->scheduler.stats;
+    double avg_jitter = stats->wakeups ? (double)stats->total_jitter_ns / stats->wakeups / 1e6 : 0.0;
+    printf("Game %d (seed %llu): %llu ticks at %d/s, %llu caught up, %llu skipped, %llu overruns, "
+           "jitter avg %.2f ms max %.2f ms, max work %.2f ms\n",
+           game->state.game_id, (unsigned long long)game->seed, (unsigned long long)stats->ticks, game->tick_rate,
+           (unsigned long long)stats->caught_up, (unsigned long long)stats->skipped,
+           (unsigned long long)stats->overruns, avg_jitter, stats->max_jitter_ns / 1e6,
+           stats->max_work_ns / 1e6);
+}
+
+static void *game_thread(void *arg) {//tick slucka jednej hry (bezi v samostatnom vlakne)
+    Game *game = arg;
+    GameSummary published;//naposledy zverejnene zhrnutie v lobby
+    get_game_summary(game, &published);
+
+    while (atomic_load(&game->running) && !game->state.game_over) {//kym hra bezi a nie je game over
+        int due = wait_for_tick(&game->scheduler);//spi do absolutneho terminu dalsieho tiku
+        if (atomic_load(&game->suspended)) {//handoff pocas spanku - stav ostava po poslednom tiku
+            break;
+        }
+        for (int i = 0; i < due && atomic_load(&game->running) && !game->state.game_over; i++) {//oneskorene tiky dobehni za sebou
+            update_game(game);//aktualizuj stav hry (jeden tick)
+        }
+        broadcast_game_state(game);//posli stav vsetkym klientom (raz za davku)
+
+        GameSummary summary;
+        get_game_summary(game, &summary);
+        if (memcmp(&summary, &published, sizeof(GameSummary)) != 0) {//pocet hracov alebo cas sa zmenil
+            publish_game(game->lobby, &summary);
+            published = summary;
+        }
+
+        finish_tick(&game->scheduler);//zaznamenaj dlzku prace (overrun)
+    }
+    unpublish_game(game->lobby, game->state.game_id);//do hry sa uz neda vstupit
+    if (atomic_load(&game->suspended) && !game->state.game_over) {//handoff - hraci ostavaju pripojeni, hra pokracuje v novom procese
+        return NULL;
+    }
+    stop_replay(game);//zaznam konci finalnym stavom simulacie
+    print_tick_stats(game);
+
+    // Game over - send final state
+    if (game->state.game_over) {//ak je hra ukoncena
+        printf("Game %d over!\n", game->state.game_id);
+        broadcast_game_state(game);//posli finalny stav
+
+        // Wait a bit for clients to receive final state
+        for (int i = 0; i < 20 && atomic_load(&game->running); i++) {//2 sekundy (prerusi ich zastavenie servera)
+            usleep(100000);
+        }
+    }
+
+    disconnect_players(game);//odpoj klientov, hra uz nebezi
+    atomic_store(&game->finished, true);//register moze hru odstranit
+    return NULL;
+}
+
+static int find_index(const GameRegistry *registry, int game_id) {//binarne vyhladanie hry podla ID (mutex musi byt zamknuty)
+    int low = 0;
+    int high = registry->count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int id = registry->games[mid]->state.game_id;
+        if (id == game_id) {
+            return mid;
+        }
+        if (id < game_id) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return -1;
+}
+
+static bool is_joinable(Game *game) {//hra bezi a este neskoncila
+    return !atomic_load(&game->finished) && !game->state.game_over;
+}
+
+static void join_game_thread(Game *game) {//pocka na tick vlakno, ak bezi a este nebolo pripojene (mutex registra musi byt zamknuty)
+    if (game->thread_started) {
+        pthread_join(game->thread, NULL);
+        game->thread_started = false;
+    }
+}
+
+void init_game_registry(GameRegistry *registry, int max_dropped_frames, bool exit_when_idle, uint64_t seed) {//inicializuje prazdny register
+    pthread_mutex_init(&registry->mutex, NULL);
+    registry->games = NULL;
+    registry->count = 0;
+    registry->capacity = 0;
+    registry->next_game_id = FIRST_GAME_ID;
+    registry->max_dropped_frames = max_dropped_frames;
+    registry->default_tick_rate = DEFAULT_TICK_RATE;
+    registry->max_catch_up = DEFAULT_MAX_CATCH_UP_TICKS;
+    registry->exit_when_idle = exit_when_idle;
+    registry->seed_state = seed;
+    registry->replay_dir = NULL;
+    init_lobby(&registry->lobby);
+}
+
+void destroy_game_registry(GameRegistry *registry) {//zastavi vsetky hry a uvolni register
+    pthread_mutex_lock(&registry->mutex);
+    for (int i = 0; i < registry->count; i++) {//zastav vsetky tick vlakna
+        atomic_store(&registry->games[i]->running, false);
+    }
+    for (int i = 0; i < registry->count; i++) {//pockaj na ne a uvolni referenciu registra
+        join_game_thread(registry->games[i]);//pozastavena hra uz vlakno nema
+        release_game(registry->games[i]);
+    }
+    free(registry->games);
+    registry->games = NULL;
+    registry->count = 0;
+    registry->capacity = 0;
+    pthread_mutex_unlock(&registry->mutex);
+    pthread_mutex_destroy(&registry->mutex);
+    destroy_lobby(&registry->lobby);
+}
+
+static bool start_game_thread(Game *game, int max_catch_up) {//zverejni hru v lobby a spusti tick vlakno
+    GameSummary summary;
+    get_game_summary(game, &summary);
+    if (!publish_game(game->lobby, &summary)) {//hra musi byt v lobby skor nez ju tick vlakno aktualizuje
+        return false;
+    }
+    init_tick_scheduler(&game->scheduler, game->tick_rate, max_catch_up);//prvy tik o jednu periodu
+    if (pthread_create(&game->thread, NULL, game_thread, game) != 0) {//spusti tick vlakno
+        unpublish_game(game->lobby, game->state.game_id);
+        return false;
+    }
+    game->thread_started = true;
+    return true;
+}
+
+static bool register_game(GameRegistry *registry, Game *game, bool record) {//zaradi hru do registra a spusti tick vlakno (pri chybe ju uvolni)
+    pthread_mutex_lock(&registry->mutex);
+
+    if (registry->count >= MAX_GAMES) {//server je plny
+        pthread_mutex_unlock(&registry->mutex);
+        release_game(game);
+        return false;
+    }
+    int index = registry->count;//nova hra ma najvyssie ID, obnovena sa zaradi podla ID
+    if (game->state.game_id < 0) {
+        game->state.game_id = registry->next_game_id;
+    } else {
+        index = 0;
+        while (index < registry->count && registry->games[index]->state.game_id < game->state.game_id) {
+            index++;
+        }
+        if (index < registry->count && registry->games[index]->state.game_id == game->state.game_id) {//ID uz existuje
+            pthread_mutex_unlock(&registry->mutex);
+            release_game(game);
+            return false;
+        }
+    }
+    if (registry->count == registry->capacity) {//zvacsi pole hier
+        int new_capacity = registry->capacity ? registry->capacity * 2 : 16;
+        Game **new_games = realloc(registry->games, new_capacity * sizeof(Game *));
+        if (!new_games) {
+            pthread_mutex_unlock(&registry->mutex);
+            release_game(game);
+            return false;
+        }
+        registry->games = new_games;
+        registry->capacity = new_capacity;
+    }
+
+    game->lobby = &registry->lobby;
+    if (registry->replay_dir && record) {//nahravaj hru od prveho tiku
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/game-%d.replay", registry->replay_dir, game->state.game_id);
+        game->replay = open_replay(path, &game->config, game->state.map_id);
+        if (!game->replay) {//hra bezi aj bez zaznamu
+            fprintf(stderr, "Cannot record replay to %s\n", path);
+        }
+    }
+    if (!start_game_thread(game, registry->max_catch_up)) {
+        pthread_mutex_unlock(&registry->mutex);
+        release_game(game);
+        return false;
+    }
+
+    memmove(&registry->games[index + 1], &registry->games[index], (registry->count - index) * sizeof(Game *));
+    registry->games[index] = game;//pole ostava zoradene podla ID
+    registry->count++;
+    if (registry->next_game_id <= game->state.game_id) {//nove hry dostanu vyssie ID
+        registry->next_game_id = game->state.game_id + 1;
+    }
+    pthread_mutex_unlock(&registry->mutex);
+    return true;
+}
+
+int start_game(GameRegistry *registry, const GameConfig *config) {//vytvori hru a spusti jej tick vlakno
+    GameConfig game_config = *config;
+    if (game_config.tick_rate <= 0) {//hra si nevyziadala rychlost
+        game_config.tick_rate = registry->default_tick_rate;
+    }
+    if (game_config.seed == 0) {//hra si nevyziadala seed - odvod ho zo seedu servera
+        pthread_mutex_lock(&registry->mutex);
+        game_config.seed = splitmix64(&registry->seed_state);
+        pthread_mutex_unlock(&registry->mutex);
+    }
+    
+    Game *game = create_game(&game_config);//mapa sa generuje mimo mutexu registra (referencia patri registru)
+    if (!game) {
+        return -1;
+    }
+    game->max_dropped_frames = registry->max_dropped_frames;//politika pre pomalych klientov
+
+    game->state.game_id = -1;//ID prideli register
+    return register_game(registry, game, true) ? game->state.game_id : -1;
+}
+
+bool restore_game(GameRegistry *registry, Game *game) {//zaregistruje obnovenu hru pod jej povodnym ID
+    game->max_dropped_frames = registry->max_dropped_frames;//politika pre pomalych klientov
+    return register_game(registry, game, false);//zaznam by nezacinal od prveho tiku
+}
+
+int acquire_running_games(GameRegistry *registry, Game **games, int max) {//beziace hry s novou referenciou
+    int count = 0;
+    pthread_mutex_lock(&registry->mutex);
+    for (int i = 0; i < registry->count && count < max; i++) {
+        if (!atomic_load(&registry->games[i]->finished)) {
+            games[count++] = retain_game(registry->games[i]);
+        }
+    }
+    pthread_mutex_unlock(&registry->mutex);
+    return count;
+}
+
+Game *acquire_game(GameRegistry *registry, int game_id) {//najde hru, do ktorej sa da vstupit
+    Game *game = NULL;
+    pthread_mutex_lock(&registry->mutex);
+
+    if (game_id == ANY_GAME_ID) {//najstarsia beziaca hra
+        for (int i = 0; i < registry->count && !game; i++) {
+            if (is_joinable(registry->games[i])) {
+                game = registry->games[i];
+            }
+        }
+    } else {
+        int index = find_index(registry, game_id);
+        if (index >= 0 && is_joinable(registry->games[index])) {
+            game = registry->games[index];
+        }
+    }
+
+    if (game) {
+        retain_game(game);//spojenie drzi vlastnu referenciu
+    }
+    pthread_mutex_unlock(&registry->mutex);
+    return game;
+}
+
+void reap_finished_games(GameRegistry *registry) {//odstrani hry, ktorych tick vlakno skoncilo
+    pthread_mutex_lock(&registry->mutex);
+    int kept = 0;
+    for (int i = 0; i < registry->count; i++) {
+        Game *game = registry->games[i];
+        if (atomic_load(&game->finished)) {//vlakno skoncilo, join necaka
+            join_game_thread(game);
+            release_game(game);//hru drzia uz len jej spojenia
+        } else {
+            registry->games[kept++] = game;//zachovaj poradie podla ID
+        }
+    }
+    registry->count = kept;
+    pthread_mutex_unlock(&registry->mutex);
+}
+
+void suspend_games(GameRegistry *registry) {//zastavi tick vlakna bez odpojenia hracov (handoff)
+    pthread_mutex_lock(&registry->mutex);
+    for (int i = 0; i < registry->count; i++) {
+        Game *game = registry->games[i];
+        if (!atomic_load(&game->finished)) {
+            atomic_store(&game->suspended, true);
+            atomic_store(&game->running, false);//vlakno skonci po aktualnom tiku
+        }
+    }
+    int kept = 0;
+    for (int i = 0; i < registry->count; i++) {
+        Game *game = registry->games[i];
+        join_game_thread(game);//stav hry sa uz nemeni (hra bez vlakna sa preskoci)
+        if (atomic_load(&game->suspended) && !game->state.game_over) {
+            registry->games[kept++] = game;
+        } else {//skoncena hra sa neodovzdava
+            atomic_store(&game->suspended, false);
+            release_game(game);
+        }
+    }
+    registry->count = kept;
+    pthread_mutex_unlock(&registry->mutex);
+}
+
+void resume_games(GameRegistry *registry) {//znovu spusti pozastavene hry (handoff zlyhal)
+    pthread_mutex_lock(&registry->mutex);
+    for (int i = 0; i < registry->count; i++) {
+        Game *game = registry->games[i];
+        if (!atomic_load(&game->suspended)) {
+            continue;
+        }
+        atomic_store(&game->suspended, false);//pred startom vlakna, inak by hned skoncilo (pri chybe ho register odstrani)
+        atomic_store(&game->running, true);
+        if (!start_game_thread(game, registry->max_catch_up)) {//vlakno nevzniklo - hra konci bez neho
+            fprintf(stderr, "Cannot resume game %d\n", game->state.game_id);
+            disconnect_players(game);
+            atomic_store(&game->finished, true);
+        }
+    }
+    pthread_mutex_unlock(&registry->mutex);
+}
+
+bool is_registry_idle(GameRegistry *registry) {//ma sa server ukoncit?
+    pthread_mutex_lock(&registry->mutex);
+    bool idle = registry->exit_when_idle && registry->next_game_id > FIRST_GAME_ID && registry->count == 0;
+    pthread_mutex_unlock(&registry->mutex);
+    return idle;
+}
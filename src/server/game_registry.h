@@ -0,0 +1,140 @@
+/**
+ * @file game_registry.h
+ * @brief Registry of all games hosted by one server process
+ *
+ * Every game runs its own tick thread and is looked up by ID when a client
+ * joins. Games are reference counted: the registry holds one reference until
+ * the tick thread has ended and the game is reaped, every connection that
+ * joined the game holds another one, so a finished game stays valid until its
+ * last client connection is closed. Running games publish their summary to
+ * the lobby index until they are over.
+ */
+
+#ifndef GAME_REGISTRY_H
+#define GAME_REGISTRY_H
+
+#include "game_logic.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+/** Maximum number of games hosted at once */
+#define MAX_GAMES 1024
+
+/** ID of the first created game */
+#define FIRST_GAME_ID 1
+
+/**
+ * @brief Registry of running games
+ *
+ * Games are kept sorted by ID (IDs only grow), so lookup is a binary search.
+ */
+typedef struct {
+    pthread_mutex_t mutex;      /**< Protects game list */
+    Game **games;               /**< Registered games sorted by ID */
+    int count;                  /**< Number of registered games */
+    int capacity;               /**< Allocated size of games */
+    int next_game_id;           /**< ID for next created game */
+    int max_dropped_frames;     /**< Slow client drop limit applied to new games */
+    int default_tick_rate;      /**< Tick rate of games that do not request one */
+    int max_catch_up;           /**< Missed ticks a late game runs back to back (0 = skip) */
+    uint64_t seed_state;        /**< splitmix64 state deriving seeds of new games */
+    const char *replay_dir;     /**< Directory for replay files (NULL = no recording) */
+    bool exit_when_idle;        /**< Server stops once the last game has ended */
+    Lobby lobby;                /**< Summaries of joinable games (MSG_LIST_GAMES) */
+} GameRegistry;
+
+/**
+ * @brief Initialize empty registry
+ * @param registry Registry to initialize
+ * @param max_dropped_frames Slow client drop limit for new games (0 = never)
+ * @param exit_when_idle Stop server after the last game has ended
+ * @param seed Server seed; games that do not request a seed get successive
+ *             seeds derived from it, in creation order
+ *
+ * Tick rate and catch-up limit start at DEFAULT_TICK_RATE and
+ * DEFAULT_MAX_CATCH_UP_TICKS, replays are not recorded until replay_dir
+ * is set (each game is then recorded to replay_dir/game-<id>.replay).
+ */
+void init_game_registry(GameRegistry *registry, int max_dropped_frames, bool exit_when_idle, uint64_t seed);
+
+/**
+ * @brief Stop all games, wait for their tick threads and release them
+ * @param registry Registry
+ */
+void destroy_game_registry(GameRegistry *registry);
+
+/**
+ * @brief Create game, register it and start its tick thread
+ * @param registry Registry
+ * @param config Game configuration
+ * @return ID of created game, or -1 on failure (registry full, invalid map)
+ */
+int start_game(GameRegistry *registry, const GameConfig *config);
+
+/**
+ * @brief Register restored game under its saved ID and start its tick thread
+ * @param registry Registry
+ * @param game Game with game_id set (reference passes to registry)
+ * @return true on success, false if ID is taken or registry is full
+ *         (game is released)
+ *
+ * Restored games are not recorded to replays.
+ */
+bool restore_game(GameRegistry *registry, Game *game);
+
+/**
+ * @brief Look up game that can be joined
+ * @param registry Registry
+ * @param game_id Game ID, or ANY_GAME_ID for the oldest running game
+ * @return Game with a new reference (release with release_game), NULL if
+ *         no such game is running
+ */
+Game *acquire_game(GameRegistry *registry, int game_id);
+
+/**
+ * @brief Take references to all games whose tick thread is running
+ * @param registry Registry
+ * @param games Output games sorted by ID (release each with release_game)
+ * @param max Size of games
+ * @return Number of games
+ */
+int acquire_running_games(GameRegistry *registry, Game **games, int max);
+
+/**
+ * @brief Unregister games whose tick thread has ended
+ * @param registry Registry
+ *
+ * Joins finished tick threads and drops the registry reference; games
+ * stay alive while connections still hold them.
+ */
+void reap_finished_games(GameRegistry *registry);
+
+/**
+ * @brief Stop tick threads of all games without disconnecting players
+ * @param registry Registry
+ *
+ * Waits until every game has finished its current tick; the remaining
+ * games are marked suspended and their state no longer changes, so they
+ * can be handed over to another process. Games that ended meanwhile are
+ * unregistered.
+ */
+void suspend_games(GameRegistry *registry);
+
+/**
+ * @brief Restart tick threads of suspended games
+ * @param registry Registry
+ *
+ * Used when the handoff did not succeed; the games continue from the
+ * tick they stopped at.
+ */
+void resume_games(GameRegistry *registry);
+
+/**
+ * @brief Check whether server should stop
+ * @param registry Registry
+ * @return true if exit_when_idle is set, at least one game was started
+ *         and none is left
+ */
+bool is_registry_idle(GameRegistry *registry);
+
+#endif // GAME_REGISTRY_H
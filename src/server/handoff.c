@@ -0,0 +1,431 @@
+#include "handoff.h"
+#include "checkpoint.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static bool make_address(struct sockaddr_un *address, const char *path) {//adresa Unix socketu
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path)) {//cesta sa nezmesti
+        return false;
+    }
+    strcpy(address->sun_path, path);
+    return true;
+}
+
+static void set_timeout(int socket, int timeout_ms) {//blokujuce operacie cakaju najviac timeout_ms
+    struct timeval timeout = { .tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000 };
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+static bool write_all(int socket, const uint8_t *data, size_t size) {//posle vsetky bajty
+    while (size > 0) {
+        ssize_t n = send(socket, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool read_all(int socket, uint8_t *data, size_t size) {//prijme presne size bajtov
+    while (size > 0) {
+        ssize_t n = recv(socket, data, size, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool send_fds(int socket, const int *fds, int count) {//posle deskriptory po davkach (SCM_RIGHTS)
+    for (int sent = 0; sent < count; sent += HANDOFF_FDS_PER_MESSAGE) {
+        int batch = count - sent < HANDOFF_FDS_PER_MESSAGE ? count - sent : HANDOFF_FDS_PER_MESSAGE;
+        union {
+            struct cmsghdr header;
+            char space[CMSG_SPACE(sizeof(int) * HANDOFF_FDS_PER_MESSAGE)];
+        } control;
+        memset(&control, 0, sizeof(control));
+        uint8_t byte = 0;//kazda davka nesie jeden bajt dat
+        struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.space;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * batch);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * batch);
+        memcpy(CMSG_DATA(cmsg), fds + sent, sizeof(int) * batch);
+        if (sendmsg(socket, &msg, MSG_NOSIGNAL) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool receive_fds(int socket, int *fds, int count) {//prijme deskriptory poslane cez send_fds
+    int received = 0;
+    while (received < count) {
+        int batch = count - received < HANDOFF_FDS_PER_MESSAGE ? count - received : HANDOFF_FDS_PER_MESSAGE;
+        union {
+            struct cmsghdr header;
+            char space[CMSG_SPACE(sizeof(int) * HANDOFF_FDS_PER_MESSAGE)];
+        } control;
+        uint8_t byte;
+        struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.space;
+        msg.msg_controllen = sizeof(control.space);
+        if (recvmsg(socket, &msg, MSG_CMSG_CLOEXEC) != 1) {
+            break;
+        }
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        if (!cmsg || cmsg->cmsg_type != SCM_RIGHTS || (msg.msg_flags & MSG_CTRUNC) ||
+            cmsg->cmsg_len != CMSG_LEN(sizeof(int) * batch)) {//davka nesedi s prudom
+            if (cmsg && cmsg->cmsg_type == SCM_RIGHTS) {//prijate deskriptory nesmu uniknut
+                int extra = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+                int *data = (int *)CMSG_DATA(cmsg);
+                for (int i = 0; i < extra; i++) {
+                    close(data[i]);
+                }
+            }
+            break;
+        }
+        memcpy(fds + received, CMSG_DATA(cmsg), sizeof(int) * batch);
+        received += batch;
+    }
+    if (received == count) {
+        return true;
+    }
+    for (int i = 0; i < received; i++) {
+        close(fds[i]);
+    }
+    return false;
+}
+
+static void put_bytes(ReplayBuffer *out, const uint8_t *data, size_t size) {//prida bajty do prudu
+    for (size_t i = 0; i < size; i++) {
+        replay_put_u8(out, data[i]);
+    }
+}
+
+static void put_request(ReplayBuffer *out) {//magic a verzia
+    for (int i = 0; i < 4; i++) {
+        replay_put_u8(out, (uint8_t)HANDOFF_MAGIC[i]);
+    }
+    replay_put_u8(out, HANDOFF_VERSION);
+}
+
+static bool get_request(ReplayReader *in) {//over magic a verziu
+    char magic[4];
+    for (int i = 0; i < 4; i++) {
+        magic[i] = (char)replay_get_u8(in);
+    }
+    return memcmp(magic, HANDOFF_MAGIC, 4) == 0 && replay_get_u8(in) == HANDOFF_VERSION && !in->error;
+}
+
+int open_handoff_socket(const char *path) {//pocuva na Unix sockete pre nasledovnika
+    struct sockaddr_un address;
+    if (!make_address(&address, path)) {
+        return -1;
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        return -1;
+    }
+    unlink(path);//socket predchadzajuceho procesu
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(listener, 1) < 0) {
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+int request_handoff(const char *path) {//pripoji sa k beziacemu serveru a poziada o odovzdanie
+    struct sockaddr_un address;
+    if (!make_address(&address, path)) {
+        return -1;
+    }
+    int predecessor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (predecessor < 0) {
+        return -1;
+    }
+    if (connect(predecessor, (struct sockaddr *)&address, sizeof(address)) < 0) {//ziadny server nebezi
+        close(predecessor);
+        return -1;
+    }
+    set_timeout(predecessor, HANDOFF_TIMEOUT_MS);
+
+    ReplayBuffer request = { NULL, 0, 0, false };
+    put_request(&request);
+    bool ok = !request.failed && write_all(predecessor, request.data, request.size);
+    free_replay_buffer(&request);
+    if (!ok) {
+        close(predecessor);
+        return -1;
+    }
+    return predecessor;
+}
+
+bool accept_handoff_request(int successor) {//over poziadavku nasledovnika
+    set_timeout(successor, HANDOFF_TIMEOUT_MS);//blokujuci socket (event loop stoji)
+    uint8_t request[5];
+    if (!read_all(successor, request, sizeof(request))) {
+        return false;
+    }
+    ReplayReader in;
+    memset(&in, 0, sizeof(in));
+    in.data = request;
+    in.size = sizeof(request);
+    return get_request(&in);
+}
+
+bool send_handoff(int successor, int server_socket, int datagram_socket, GameRegistry *registry,
+                  const HandoffConnection *connections, int count) {//odovzda hry a spojenia nasledovnikovi
+    Game **games = malloc(MAX_GAMES * sizeof(Game *));
+    int *fds = malloc((count + 2) * sizeof(int));
+    ReplayBuffer out = { NULL, 0, 0, false };
+    ReplayBuffer game_buffer = { NULL, 0, 0, false };
+    if (!games || !fds) {
+        free(games);
+        free(fds);
+        return false;
+    }
+
+    pthread_mutex_lock(&registry->mutex);
+    int next_game_id = registry->next_game_id;
+    uint64_t seed_state = registry->seed_state;
+    pthread_mutex_unlock(&registry->mutex);
+    int game_count = acquire_running_games(registry, games, MAX_GAMES);//pozastavene hry
+
+    replay_put_u32(&out, 0);//dlzka prudu (doplni sa)
+    put_request(&out);
+    replay_put_varint(&out, (uint32_t)next_game_id);
+    replay_put_u64(&out, seed_state);
+    replay_put_u8(&out, datagram_socket >= 0);
+    replay_put_varint(&out, (uint32_t)game_count);
+    for (int i = 0; i < game_count; i++) {
+        if (!encode_game_checkpoint(&game_buffer, games[i])) {//skoncene hry suspend_games odstranil
+            game_buffer.failed = true;
+        }
+        replay_put_varint(&out, (uint32_t)game_buffer.size);
+        put_bytes(&out, game_buffer.data, game_buffer.size);
+        out.failed |= game_buffer.failed;
+        release_game(games[i]);
+    }
+    replay_put_varint(&out, (uint32_t)count);
+    int fd_count = 0;
+    fds[fd_count++] = server_socket;
+    if (datagram_socket >= 0) {
+        fds[fd_count++] = datagram_socket;
+    }
+    for (int i = 0; i < count; i++) {
+        replay_put_varint(&out, connections[i].game ? (uint32_t)connections[i].game->state.game_id : 0);
+        replay_put_varint(&out, (uint32_t)(connections[i].player_id + 1));
+        replay_put_varint(&out, (uint32_t)connections[i].pending_len);
+        put_bytes(&out, connections[i].pending, connections[i].pending_len);
+        replay_put_varint(&out, (uint32_t)connections[i].datagram_address_len);
+        put_bytes(&out, (const uint8_t *)&connections[i].datagram_address, connections[i].datagram_address_len);
+        replay_put_varint(&out, (uint32_t)connections[i].codec);
+        fds[fd_count++] = connections[i].socket;
+    }
+
+    bool ok = !out.failed;
+    if (ok) {
+        uint32_t length = (uint32_t)(out.size - 4);
+        for (int i = 0; i < 4; i++) {//dlzka little-endian na zaciatok
+            out.data[i] = (uint8_t)(length >> (8 * i));
+        }
+        uint8_t confirmation = 0;
+        ok = write_all(successor, out.data, out.size) && send_fds(successor, fds, fd_count) &&
+             read_all(successor, &confirmation, 1) && confirmation == 'K';//nasledovnik prevzal hry
+    }
+
+    free_replay_buffer(&game_buffer);
+    free_replay_buffer(&out);
+    free(fds);
+    free(games);
+    return ok;
+}
+
+static Game *find_game(Game **games, int count, int game_id) {//hra z prudu podla ID
+    for (int i = 0; i < count; i++) {
+        if (games[i] && games[i]->state.game_id == game_id) {
+            return games[i];
+        }
+    }
+    return NULL;
+}
+
+bool receive_handoff(int predecessor, GameRegistry *registry, int *server_socket, int *datagram_socket,
+                     HandoffConnection **connections, int *count) {//prevezme hry a spojenia predchodcu
+    uint8_t header[4];
+    if (!read_all(predecessor, header, sizeof(header))) {
+        return false;
+    }
+    uint32_t length = (uint32_t)header[0] | (uint32_t)header[1] << 8 | (uint32_t)header[2] << 16 |
+                      (uint32_t)header[3] << 24;
+    uint8_t *data = malloc(length ? length : 1);
+    if (!data || !read_all(predecessor, data, length)) {
+        free(data);
+        return false;
+    }
+
+    ReplayReader in;
+    memset(&in, 0, sizeof(in));
+    in.data = data;
+    in.size = length;
+    bool ok = get_request(&in);
+    int next_game_id = (int)replay_get_varint(&in);
+    uint64_t seed_state = replay_get_u64(&in);
+    int socket_count = replay_get_u8(&in) ? 2 : 1;//pocuvajuci a UDP socket
+    int game_count = (int)replay_get_varint(&in);
+    if (!ok || in.error || game_count > MAX_GAMES) {
+        free(data);
+        return false;
+    }
+
+    Game **games = calloc(game_count ? game_count : 1, sizeof(Game *));
+    for (int i = 0; games && i < game_count && !in.error; i++) {
+        size_t size = replay_get_varint(&in);
+        if (size > in.size - in.offset) {
+            in.error = true;
+            break;
+        }
+        games[i] = decode_game_checkpoint(in.data + in.offset, size, true);//hraci ostavaju v slotoch
+        if (!games[i]) {
+            in.error = true;
+        }
+        in.offset += size;
+    }
+    int connection_count = in.error ? 0 : (int)replay_get_varint(&in);
+    if (in.error || (size_t)connection_count > in.size - in.offset) {//kazde spojenie ma aspon 3 bajty
+        in.error = true;
+        connection_count = 0;
+    }
+    HandoffConnection *handed = calloc(connection_count ? connection_count : 1, sizeof(HandoffConnection));
+    int fd_count = socket_count + connection_count;
+    int *fds = malloc(fd_count * sizeof(int));
+    ok = games && handed && fds && !in.error;
+    bool have_fds = ok && receive_fds(predecessor, fds, fd_count);//deskriptory patria tomuto procesu az po prijati
+    ok = have_fds;
+
+    if (ok) {
+        *server_socket = fds[0];
+        *datagram_socket = socket_count == 2 ? fds[1] : -1;
+        for (int i = 0; i < connection_count; i++) {
+            HandoffConnection *conn = &handed[i];
+            int game_id = (int)replay_get_varint(&in);
+            conn->socket = fds[socket_count + i];
+            conn->player_id = (int)replay_get_varint(&in) - 1;
+            conn->pending_len = replay_get_varint(&in);
+            if (in.error || conn->pending_len > in.size - in.offset) {
+                in.error = true;
+                conn->pending_len = 0;
+                continue;
+            }
+            if (conn->pending_len > 0) {
+                conn->pending = malloc(conn->pending_len);
+                if (conn->pending) {
+                    memcpy(conn->pending, in.data + in.offset, conn->pending_len);
+                } else {
+                    conn->pending_len = 0;
+                }
+            }
+            in.offset += conn->pending_len;
+            size_t address_len = replay_get_varint(&in);
+            if (in.error || address_len > sizeof(conn->datagram_address) || address_len > in.size - in.offset) {
+                in.error = true;
+                continue;
+            }
+            memcpy(&conn->datagram_address, in.data + in.offset, address_len);
+            conn->datagram_address_len = (socklen_t)address_len;
+            in.offset += address_len;
+            uint32_t codec = replay_get_varint(&in);
+            conn->codec = (codec <= CODEC_LZ) ? (Codec)codec : CODEC_NONE;//neznamy kodek - posiela sa nekomprimovane
+
+            Game *game = game_id ? find_game(games, game_count, game_id) : NULL;
+            if (game && adopt_player(game, conn->player_id, conn->socket)) {
+                conn->game = retain_game(game);//spojenie drzi referenciu ako v event loope
+            } else {
+                conn->player_id = -1;//spojenie mimo hry (lobby)
+            }
+        }
+        ok = !in.error;
+    }
+
+    if (!ok) {//predchodca bezi dalej, nic sa neprevzalo
+        for (int i = 0; handed && i < connection_count; i++) {
+            release_game(handed[i].game);
+        }
+        for (int i = 0; have_fds && i < fd_count; i++) {//kopie deskriptorov (predchodca ma svoje)
+            close(fds[i]);
+        }
+        free_handoff_connections(handed, connection_count);
+        for (int i = 0; games && i < game_count; i++) {
+            release_game(games[i]);
+        }
+        free(games);
+        free(fds);
+        free(data);
+        return false;
+    }
+
+    pthread_mutex_lock(&registry->mutex);
+    registry->next_game_id = next_game_id;
+    registry->seed_state = seed_state;
+    pthread_mutex_unlock(&registry->mutex);
+    for (int i = 0; i < game_count; i++) {
+        Game *game = games[i];
+        for (int id = 0; id < MAX_PLAYERS; id++) {//hrac, ktoreho spojenie sa neodovzdalo
+            if (game->client_connected[id] && game->client_sockets[id] < 0) {
+                remove_player(game, id);
+            }
+        }
+        int game_id = game->state.game_id;
+        if (!restore_game(registry, game)) {//spojenia hru drzia, skonci s nimi
+            fprintf(stderr, "Cannot restore game %d\n", game_id);
+        }
+    }
+
+    uint8_t confirmation = 'K';
+    write_all(predecessor, &confirmation, 1);//predchodca skonci
+    *connections = handed;
+    *count = connection_count;
+    free(games);
+    free(fds);
+    free(data);
+    return true;
+}
+
+void free_handoff_connections(HandoffConnection *connections, int count) {//uvolni pole spojeni
+    if (!connections) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        free(connections[i].pending);
+    }
+    free(connections);
+}
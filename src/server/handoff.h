@@ -0,0 +1,118 @@
+/**
+ * @file handoff.h
+ * @brief Handing running games and connections to a new server process
+ *
+ * A server started with a handoff path listens on a Unix socket there.
+ * A newer server binary started with the same path connects to it and
+ * takes over: the old process suspends all games after their current
+ * tick, drains the clients' outbound queues, and sends the listening
+ * socket and every client socket (SCM_RIGHTS) together with a checkpoint
+ * of each game. The new process restores the games, attaches the
+ * connections to their slots and confirms; the old process then exits
+ * without closing any connection. Clients only see a keyframe.
+ *
+ * Stream layout: u32 length followed by "SNKH", version, varint next game
+ * ID, u64 seed state, u8 UDP socket flag, varint game count, per game
+ * varint size and checkpoint (encode_game_checkpoint), varint connection
+ * count, per connection varint game ID (0 = not in game), varint player
+ * ID + 1, varint size and bytes of the unfinished inbound frame and varint
+ * size and bytes of the UDP address (0 = TCP only) and varint snapshot
+ * codec. The listening socket,
+ * the UDP socket (if flagged) and the connection sockets follow in this
+ * order.
+ */
+
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include "game_registry.h"
+#include <sys/socket.h>
+
+/** Stream magic (also sent as takeover request) */
+#define HANDOFF_MAGIC "SNKH"
+
+/** Format version */
+#define HANDOFF_VERSION 3
+
+/** Longest wait for a client to receive its queued frames before handoff (ms) */
+#define HANDOFF_DRAIN_MS 200
+
+/** Longest wait for the other process during handoff (ms) */
+#define HANDOFF_TIMEOUT_MS 5000
+
+/** Descriptors sent in one message (kernel limit is 253) */
+#define HANDOFF_FDS_PER_MESSAGE 200
+
+/**
+ * @brief Client connection passed between processes
+ */
+typedef struct {
+    int socket;             /**< Client socket */
+    Game *game;             /**< Game of connection with own reference (NULL = not in game) */
+    int player_id;          /**< Player slot (-1 = not in game) */
+    uint8_t *pending;       /**< Received bytes of unfinished frame */
+    size_t pending_len;     /**< Number of pending bytes */
+    struct sockaddr_storage datagram_address;   /**< UDP address of snapshots */
+    socklen_t datagram_address_len;             /**< Size of UDP address (0 = TCP only) */
+    Codec codec;            /**< Snapshot codec negotiated at join */
+} HandoffConnection;
+
+/**
+ * @brief Listen for successor process on Unix socket
+ * @param path Socket path (a stale socket file is replaced)
+ * @return Listening socket, or -1 on failure
+ */
+int open_handoff_socket(const char *path);
+
+/**
+ * @brief Ask server listening on path to hand over
+ * @param path Socket path
+ * @return Connected socket, or -1 if no server listens there
+ */
+int request_handoff(const char *path);
+
+/**
+ * @brief Check takeover request of successor that connected
+ * @param successor Accepted connection of successor
+ * @return true if request is valid
+ */
+bool accept_handoff_request(int successor);
+
+/**
+ * @brief Send suspended games and connections to successor
+ * @param successor Connection of successor
+ * @param server_socket Listening socket
+ * @param datagram_socket UDP socket (-1 = none)
+ * @param registry Registry with suspended games (see suspend_games)
+ * @param connections Connections to hand over (outbound queues drained)
+ * @param count Number of connections
+ * @return true once successor confirmed; false if it failed (nothing was
+ *         taken over, resume_games continues the games)
+ */
+bool send_handoff(int successor, int server_socket, int datagram_socket, GameRegistry *registry,
+                  const HandoffConnection *connections, int count);
+
+/**
+ * @brief Receive and start games and connections of previous process
+ * @param predecessor Socket from request_handoff
+ * @param registry Empty registry
+ * @param server_socket Output listening socket
+ * @param datagram_socket Output UDP socket (-1 = none)
+ * @param connections Output connections (free with free_handoff_connections)
+ * @param count Output number of connections
+ * @return true on success (predecessor was told to exit), false if the
+ *         handoff failed (predecessor keeps running)
+ *
+ * Games are registered under their IDs and their tick threads started.
+ */
+bool receive_handoff(int predecessor, GameRegistry *registry, int *server_socket, int *datagram_socket,
+                     HandoffConnection **connections, int *count);
+
+/**
+ * @brief Free connections from receive_handoff
+ * @param connections Connections (sockets and game references are not released)
+ * @param count Number of connections
+ */
+void free_handoff_connections(HandoffConnection *connections, int count);
+
+#endif // HANDOFF_H
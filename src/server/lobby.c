@@ -0,0 +1,92 @@
+#include "lobby.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int lower_bound(const Lobby *lobby, int game_id) {//index prvej hry s ID >= game_id (mutex musi byt zamknuty)
+    int low = 0;
+    int high = lobby->count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (lobby->entries[mid].game_id < game_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+void init_lobby(Lobby *lobby) {//inicializuje prazdny zoznam hier
+    pthread_mutex_init(&lobby->mutex, NULL);
+    lobby->entries = NULL;
+    lobby->count = 0;
+    lobby->capacity = 0;
+}
+
+void destroy_lobby(Lobby *lobby) {//uvolni zoznam hier
+    free(lobby->entries);
+    lobby->entries = NULL;
+    lobby->count = 0;
+    lobby->capacity = 0;
+    pthread_mutex_destroy(&lobby->mutex);
+}
+
+bool publish_game(Lobby *lobby, const GameSummary *summary) {//prida alebo aktualizuje zaznam hry
+    pthread_mutex_lock(&lobby->mutex);
+    int index = lower_bound(lobby, summary->game_id);
+    
+    if (index < lobby->count && lobby->entries[index].game_id == summary->game_id) {//hra uz je v zozname
+        lobby->entries[index] = *summary;
+        pthread_mutex_unlock(&lobby->mutex);
+        return true;
+    }
+    
+    if (lobby->count == lobby->capacity) {//zvacsi pole zaznamov
+        int new_capacity = lobby->capacity ? lobby->capacity * 2 : 16;
+        GameSummary *new_entries = realloc(lobby->entries, new_capacity * sizeof(GameSummary));
+        if (!new_entries) {
+            pthread_mutex_unlock(&lobby->mutex);
+            return false;
+        }
+        lobby->entries = new_entries;
+        lobby->capacity = new_capacity;
+    }
+    
+    memmove(&lobby->entries[index + 1], &lobby->entries[index],
+            (lobby->count - index) * sizeof(GameSummary));//nove hry maju najvacsie ID, posun je spravidla prazdny
+    lobby->entries[index] = *summary;
+    lobby->count++;
+    pthread_mutex_unlock(&lobby->mutex);
+    return true;
+}
+
+void unpublish_game(Lobby *lobby, int game_id) {//odstrani hru zo zoznamu
+    pthread_mutex_lock(&lobby->mutex);
+    int index = lower_bound(lobby, game_id);
+    if (index < lobby->count && lobby->entries[index].game_id == game_id) {
+        memmove(&lobby->entries[index], &lobby->entries[index + 1],
+                (lobby->count - index - 1) * sizeof(GameSummary));
+        lobby->count--;
+    }
+    pthread_mutex_unlock(&lobby->mutex);
+}
+
+int list_games(Lobby *lobby, int after_game_id, GameSummary *page, int max_count, int *total) {//skopiruje stranku zoznamu
+    pthread_mutex_lock(&lobby->mutex);
+    int index = lower_bound(lobby, after_game_id);
+    if (index < lobby->count && lobby->entries[index].game_id == after_game_id) {//prva hra za kurzorom
+        index++;
+    }
+    int count = lobby->count - index;
+    if (count > max_count) {
+        count = max_count;
+    }
+    if (count > 0) {
+        memcpy(page, &lobby->entries[index], count * sizeof(GameSummary));
+    } else {
+        count = 0;
+    }
+    *total = lobby->count;
+    pthread_mutex_unlock(&lobby->mutex);
+    return count;
+}
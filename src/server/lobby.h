@@ -0,0 +1,65 @@
+/**
+ * @file lobby.h
+ * @brief Lobby index of running games
+ *
+ * Compact array of game summaries sorted by game ID. Each game publishes its
+ * own summary whenever player count or elapsed time changes, so list queries
+ * only copy a page out of the index and never touch the games themselves.
+ */
+
+#ifndef LOBBY_H
+#define LOBBY_H
+
+#include "protocol.h"
+#include <pthread.h>
+#include <stdbool.h>
+
+/**
+ * @brief Index of listed games
+ */
+typedef struct {
+    pthread_mutex_t mutex;      /**< Protects index (tick threads vs event loop) */
+    GameSummary *entries;       /**< Summaries sorted by game ID */
+    int count;                  /**< Number of listed games */
+    int capacity;               /**< Allocated size of entries */
+} Lobby;
+
+/**
+ * @brief Initialize empty lobby
+ * @param lobby Lobby to initialize
+ */
+void init_lobby(Lobby *lobby);
+
+/**
+ * @brief Free lobby memory
+ * @param lobby Lobby to destroy
+ */
+void destroy_lobby(Lobby *lobby);
+
+/**
+ * @brief Insert or update summary of game
+ * @param lobby Lobby
+ * @param summary Game summary (keyed by game_id)
+ * @return true on success, false on allocation failure
+ */
+bool publish_game(Lobby *lobby, const GameSummary *summary);
+
+/**
+ * @brief Remove game from lobby (game over)
+ * @param lobby Lobby
+ * @param game_id Game ID
+ */
+void unpublish_game(Lobby *lobby, int game_id);
+
+/**
+ * @brief Copy one page of listed games
+ * @param lobby Lobby
+ * @param after_game_id Page starts with first game with greater ID
+ * @param page Output summaries
+ * @param max_count Page capacity
+ * @param total Output number of listed games
+ * @return Number of games copied to page
+ */
+int list_games(Lobby *lobby, int after_game_id, GameSummary *page, int max_count, int *total);
+
+#endif // LOBBY_H
@@ -2,7 +2,6 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 bool load_map_from_file(const char *filename, uint8_t **obstacles, int *width, int *height) {//nacita mapu zo suboru
     FILE *file = fopen(filename, "r");//otvor subor na citanie
@@ -39,14 +38,12 @@ bool load_map_from_file(const char *filename, uint8_t **obstacles, int *width, i
     return true;//nacitanie uspesne
 }
 
-void generate_random_map(uint8_t **obstacles, int width, int height, float obstacle_density) {//vygeneruje nahodnu mapu s prekazkami
+void generate_random_map(uint8_t **obstacles, int width, int height, float obstacle_density, Rng *rng) {//vygeneruje nahodnu mapu s prekazkami
     *obstacles = (uint8_t *)calloc(width * height, sizeof(uint8_t));//alokuj pamat pre bitmapu prekazok
     if (!*obstacles) {//ak sa nepodarilo alokovat
         return;
     }
     
-    srand(time(NULL));//inicializuj generator nahodnych cisel
-    
     Position center = {width / 2, height / 2};//stred mapy
     
     // Define safe spawn zone radius (min 10 units from center)
@@ -65,7 +62,7 @@ void generate_random_map(uint8_t **obstacles, int width, int height, float obsta
             
             // Only place obstacles outside safe radius
             if (dist_sq > safe_radius * safe_radius) {//ak je mimo bezpecnej zony
-                if ((float)rand() / RAND_MAX < obstacle_density) {//s pravdepodobnostou podla hustoty
+                if (rng_unit(rng) < obstacle_density) {//s pravdepodobnostou podla hustoty
                     set_obstacle(*obstacles, x, y, width);//nastav prekazku
                 }
             }
@@ -10,6 +10,7 @@
 #define MAP_H
 
 #include "protocol.h"
+#include "rng.h"
 #include <stdbool.h>
 
 /**
@@ -30,11 +31,12 @@ bool load_map_from_file(const char *filename, uint8_t **obstacles, int *width, i
  * @param width Map width
  * @param height Map height
  * @param obstacle_density Obstacle density (0.0-1.0, e.g., 0.10 = 10%)
+ * @param rng Game's random generator (retries continue its sequence)
  * 
  * Generates obstacles only outside safe radius from center.
  * Safe radius = width/4 or height/4 (minimum 10).
  */
-void generate_random_map(uint8_t **obstacles, int width, int height, float obstacle_density);
+void generate_random_map(uint8_t **obstacles, int width, int height, float obstacle_density, Rng *rng);
 
 /**
  * @brief Check if position has obstacle
@@ -0,0 +1,177 @@
+#include "occupancy.h"
+#include <stdlib.h>
+
+static int cell_index(const OccupancyGrid *grid, Position pos) {//index bunky, -1 mimo mapy
+    if (pos.x < 0 || pos.x >= grid->width || pos.y < 0 || pos.y >= grid->height) {
+        return -1;
+    }
+    return pos.y * grid->width + pos.x;
+}
+
+static void update_free(OccupancyGrid *grid, int index) {//zaradi/vyradi bunku z mnoziny volnych podla jej stavu
+    const OccupancyCell *cell = &grid->cells[index];
+    bool free = cell->segments == 0 && cell->flags == 0;//bez hada, prekazky a jedla
+    int slot = grid->free_slot[index];
+    
+    if (free && slot < 0) {//pridaj na koniec
+        grid->free_slot[index] = grid->free_count;
+        grid->free_cells[grid->free_count++] = index;
+    } else if (!free && slot >= 0) {//presun poslednu bunku na uvolnene miesto
+        int last = grid->free_cells[--grid->free_count];
+        grid->free_cells[slot] = last;
+        grid->free_slot[last] = slot;
+        grid->free_slot[index] = -1;
+    }
+}
+
+static void add_cell(OccupancyGrid *grid, Position pos, bool head) {//prida segment na bunku
+    int index = cell_index(grid, pos);
+    if (index < 0) {
+        return;
+    }
+    OccupancyCell *cell = &grid->cells[index];
+    cell->segments++;
+    if (head) {
+        cell->heads++;
+    }
+    if (cell->segments == 1) {//bunka prestala byt volna
+        update_free(grid, index);
+    }
+}
+
+static void remove_cell(OccupancyGrid *grid, Position pos, bool head) {//odoberie segment z bunky
+    int index = cell_index(grid, pos);
+    if (index < 0) {
+        return;
+    }
+    OccupancyCell *cell = &grid->cells[index];
+    cell->segments--;
+    if (head) {
+        cell->heads--;
+    }
+    if (cell->segments == 0) {//bunka moze byt opat volna
+        update_free(grid, index);
+    }
+}
+
+bool init_occupancy_grid(OccupancyGrid *grid, int width, int height, const uint8_t *obstacles) {//alokuje mriezku, volne su vsetky bunky bez prekazok
+    size_t count = (size_t)width * height;
+    grid->width = width;
+    grid->height = height;
+    grid->cells = calloc(count, sizeof(OccupancyCell));
+    grid->free_cells = malloc(count * sizeof(int));
+    grid->free_slot = malloc(count * sizeof(int));
+    grid->free_count = 0;
+    if (!grid->cells || !grid->free_cells || !grid->free_slot) {
+        destroy_occupancy_grid(grid);
+        return false;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        grid->free_slot[i] = -1;
+        if (obstacles && obstacles[i]) {
+            grid->cells[i].flags = CELL_OBSTACLE;
+        }
+        update_free(grid, (int)i);
+    }
+    return true;
+}
+
+void destroy_occupancy_grid(OccupancyGrid *grid) {//uvolni mriezku
+    free(grid->cells);
+    free(grid->free_cells);
+    free(grid->free_slot);
+    grid->cells = NULL;
+    grid->free_cells = NULL;
+    grid->free_slot = NULL;
+    grid->free_count = 0;
+}
+
+void occupy_snake(OccupancyGrid *grid, const Snake *snake) {//zapise vsetky segmenty hada
+    for (int i = 0; i < snake->length; i++) {
+        add_cell(grid, snake_segment(snake, i), i == 0);
+    }
+}
+
+void vacate_snake(OccupancyGrid *grid, const Snake *snake) {//odstrani vsetky segmenty hada
+    for (int i = 0; i < snake->length; i++) {
+        remove_cell(grid, snake_segment(snake, i), i == 0);
+    }
+}
+
+void advance_snake(OccupancyGrid *grid, Position old_head, Position old_tail, Position new_head) {//posun hada o jeden krok
+    int index = cell_index(grid, old_head);
+    if (index >= 0) {//stara hlava je teraz telo
+        grid->cells[index].heads--;
+    }
+    remove_cell(grid, old_tail, false);//chvost sa stiahol
+    add_cell(grid, new_head, true);//nova hlava
+}
+
+void occupy_segment(OccupancyGrid *grid, Position pos) {//prida segment tela (rast)
+    add_cell(grid, pos, false);
+}
+
+void place_food(OccupancyGrid *grid, Position pos) {//oznaci jedlo na bunke
+    int index = cell_index(grid, pos);
+    if (index >= 0) {
+        grid->cells[index].flags |= CELL_FOOD;
+        update_free(grid, index);
+    }
+}
+
+void remove_food(OccupancyGrid *grid, Position pos) {//odstrani jedlo z bunky
+    int index = cell_index(grid, pos);
+    if (index >= 0) {
+        grid->cells[index].flags &= (uint8_t)~CELL_FOOD;
+        update_free(grid, index);
+    }
+}
+
+bool random_free_cell(const OccupancyGrid *grid, Rng *rng, Position *pos) {//nahodna volna bunka (rovnomerne)
+    if (grid->free_count == 0) {//plna mapa
+        return false;
+    }
+    int index = grid->free_cells[rng_below(rng, (uint32_t)grid->free_count)];
+    pos->x = index % grid->width;
+    pos->y = index / grid->width;
+    return true;
+}
+
+bool set_free_cell_order(OccupancyGrid *grid, const int *cells, int count) {//nastavi poradie volnych buniek (obnova z keyframu)
+    if (count != grid->free_count) {
+        return false;
+    }
+    int cell_count = grid->width * grid->height;
+    int valid = 0;
+    while (valid < count) {//kazda volna bunka prave raz
+        int index = cells[valid];
+        if (index < 0 || index >= cell_count || grid->free_slot[index] < 0) {//nie je volna alebo sa opakuje
+            break;
+        }
+        grid->free_slot[index] = -1;//docasne oznac ako spracovanu
+        valid++;
+    }
+    if (valid < count) {//vrat povodne poradie
+        for (int i = 0; i < grid->free_count; i++) {
+            grid->free_slot[grid->free_cells[i]] = i;
+        }
+        return false;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        grid->free_cells[i] = cells[i];
+        grid->free_slot[cells[i]] = i;
+    }
+    return true;
+}
+
+bool is_body_cell(const OccupancyGrid *grid, Position pos) {//je na bunke telo (nie len hlavy)?
+    int index = cell_index(grid, pos);
+    return index >= 0 && grid->cells[index].segments > grid->cells[index].heads;
+}
+
+bool is_snake_cell(const OccupancyGrid *grid, Position pos) {//lezi na bunke nejaky had?
+    int index = cell_index(grid, pos);
+    return index >= 0 && grid->cells[index].segments > 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * @file occupancy.h
+ * @brief Per-cell occupancy grid of live snakes and free-cell index
+ *
+ * Every cell counts the segments of live, connected snakes lying on it and
+ * how many of them are heads, and remembers obstacles and food. The grid is
+ * updated incrementally as heads advance, tails retract, snakes grow, spawn
+ * or die and food is placed or eaten, so collision checks are single
+ * lookups. Cells without snake, obstacle and food are kept in a dense set,
+ * so a random free cell is found in constant time.
+ * Positions outside the map are never stored.
+ */
+
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include "protocol.h"
+#include "rng.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Cell flags */
+#define CELL_OBSTACLE 0x01  /**< Static obstacle */
+#define CELL_FOOD     0x02  /**< Food lies on cell */
+
+/**
+ * @brief Occupancy of one map cell
+ *
+ * Counts instead of a single owner: heads of different snakes may share
+ * a cell and a growing snake stacks duplicate tail segments.
+ */
+typedef struct {
+    uint16_t segments;  /**< Segments on cell (heads included) */
+    uint8_t heads;      /**< Heads on cell */
+    uint8_t flags;      /**< CELL_OBSTACLE, CELL_FOOD */
+} OccupancyCell;
+
+/**
+ * @brief Occupancy grid (width * height cells) with free-cell set
+ */
+typedef struct {
+    int width;              /**< Map width */
+    int height;             /**< Map height */
+    OccupancyCell *cells;   /**< Cells in row-major order */
+    int *free_cells;        /**< Dense array of free cell indices */
+    int *free_slot;         /**< Cell index -> position in free_cells (-1 = not free) */
+    int free_count;         /**< Number of free cells */
+} OccupancyGrid;
+
+/**
+ * @brief Allocate grid with all non-obstacle cells free
+ * @param grid Grid to initialize
+ * @param width Map width
+ * @param height Map height
+ * @param obstacles Obstacle bitmap (width * height, may be NULL)
+ * @return true on success, false on allocation failure
+ */
+bool init_occupancy_grid(OccupancyGrid *grid, int width, int height, const uint8_t *obstacles);
+
+/**
+ * @brief Free grid memory
+ * @param grid Grid to destroy
+ */
+void destroy_occupancy_grid(OccupancyGrid *grid);
+
+/**
+ * @brief Add all segments of snake (spawn)
+ * @param grid Grid
+ * @param snake Snake, segment 0 is the head
+ */
+void occupy_snake(OccupancyGrid *grid, const Snake *snake);
+
+/**
+ * @brief Remove all segments of snake (death, disconnect)
+ * @param grid Grid
+ * @param snake Snake in the same state as when its cells were last updated
+ */
+void vacate_snake(OccupancyGrid *grid, const Snake *snake);
+
+/**
+ * @brief Move snake by one step: retract tail and advance head
+ * @param grid Grid
+ * @param old_head Head position before the move
+ * @param old_tail Last segment before the move
+ * @param new_head Head position after the move
+ */
+void advance_snake(OccupancyGrid *grid, Position old_head, Position old_tail, Position new_head);
+
+/**
+ * @brief Add one body segment (snake grew by duplicating its tail)
+ * @param grid Grid
+ * @param pos Segment position
+ */
+void occupy_segment(OccupancyGrid *grid, Position pos);
+
+/**
+ * @brief Mark food on cell
+ * @param grid Grid
+ * @param pos Food position
+ */
+void place_food(OccupancyGrid *grid, Position pos);
+
+/**
+ * @brief Remove food from cell (eaten)
+ * @param grid Grid
+ * @param pos Food position
+ */
+void remove_food(OccupancyGrid *grid, Position pos);
+
+/**
+ * @brief Pick uniformly random free cell
+ * @param grid Grid
+ * @param rng Random generator
+ * @param pos Output position
+ * @return true if a free cell exists, false if board is full
+ */
+bool random_free_cell(const OccupancyGrid *grid, Rng *rng, Position *pos);
+
+/**
+ * @brief Replace order of free-cell set
+ * @param grid Grid whose cells already match the restored state
+ * @param cells Free cell indices in the wanted order
+ * @param count Number of indices
+ * @return true on success, false if cells are not exactly the free cells
+ *         (grid is unchanged)
+ *
+ * random_free_cell depends on the order, which follows from the history
+ * of updates; a game restored from a replay keyframe sets the recorded
+ * order so it draws the same food as the recorded game.
+ */
+bool set_free_cell_order(OccupancyGrid *grid, const int *cells, int count);
+
+/**
+ * @brief Check whether cell holds a body segment (anything but heads)
+ * @param grid Grid
+ * @param pos Position (outside map = false)
+ * @return true if a head on this cell collides
+ */
+bool is_body_cell(const OccupancyGrid *grid, Position pos);
+
+/**
+ * @brief Check whether any snake lies on cell
+ * @param grid Grid
+ * @param pos Position (outside map = false)
+ * @return true if a segment of a live snake is on cell
+ */
+bool is_snake_cell(const OccupancyGrid *grid, Position pos);
+
+#endif // OCCUPANCY_H
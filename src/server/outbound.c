@@ -0,0 +1,243 @@
+#include "outbound.h"
+#include "network.h"
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+Snapshot *create_snapshot(size_t payload_size) {//alokuje snapshot pre spravu danej velkosti
+    if (payload_size > MAX_MESSAGE_SIZE) {//klienti by taky ramec odmietli
+        return NULL;
+    }
+    
+    Snapshot *snapshot = malloc(sizeof(Snapshot) + FRAME_HEADER_SIZE + payload_size);
+    if (!snapshot) {
+        return NULL;
+    }
+
+    atomic_init(&snapshot->refcount, 1);//jedna referencia pre volajuceho
+    snapshot->size = FRAME_HEADER_SIZE + payload_size;//velkost celeho ramca
+    write_frame_header(snapshot->data, payload_size);//hlavicka ramca (velkost spravy)
+    return snapshot;
+}
+
+Snapshot *retain_snapshot(Snapshot *snapshot) {//prida referenciu na snapshot
+    atomic_fetch_add(&snapshot->refcount, 1);
+    return snapshot;
+}
+
+void release_snapshot(Snapshot *snapshot) {//uvolni referenciu, posledna uvolni pamat
+    if (snapshot && atomic_fetch_sub(&snapshot->refcount, 1) == 1) {
+        free(snapshot);
+    }
+}
+
+static void pop_frame(OutboundQueue *queue) {//odstrani najstarsi snapshot z fronty
+    release_snapshot(queue->frames[queue->head]);
+    queue->frames[queue->head] = NULL;
+    queue->reliable[queue->head] = false;
+    queue->head = (queue->head + 1) % OUTBOUND_QUEUE_CAPACITY;
+    queue->count--;
+    queue->sent = 0;
+}
+
+static void clear_frames(OutboundQueue *queue) {//uvolni vsetky snapshoty vo fronte
+    while (queue->count > 0) {
+        pop_frame(queue);
+    }
+    queue->head = 0;
+}
+
+static bool flush_locked(OutboundQueue *queue) {//posiela snapshoty kym sa da (mutex musi byt zamknuty)
+    while (queue->count > 0) {//kym je co posielat
+        Snapshot *frame = queue->frames[queue->head];
+        ssize_t n = send_available(queue->socket, frame->data + queue->sent, frame->size - queue->sent);//neblokujuci send
+        if (n < 0) {//chyba socketu
+            return false;
+        }
+        queue->sent += n;
+        if (queue->sent < frame->size) {//socket je plny, dokonci sa pri EPOLLOUT
+            return true;
+        }
+        pop_frame(queue);//snapshot cely odoslany
+    }
+
+    queue->dropped = 0;//klient stiha, vynuluj pocitadlo zahodenych snapshotov
+    return true;
+}
+
+void init_outbound_queue(OutboundQueue *queue) {//inicializuje prazdnu odpojenu frontu
+    pthread_mutex_init(&queue->mutex, NULL);
+    queue->socket = -1;
+    for (int i = 0; i < OUTBOUND_QUEUE_CAPACITY; i++) {
+        queue->frames[i] = NULL;
+        queue->reliable[i] = false;
+    }
+    queue->head = 0;
+    queue->count = 0;
+    queue->sent = 0;
+    queue->dropped = 0;
+    queue->max_dropped = DEFAULT_MAX_DROPPED_FRAMES;
+    queue->datagram_socket = -1;
+    queue->datagram_address_len = 0;
+}
+
+void destroy_outbound_queue(OutboundQueue *queue) {//znici frontu
+    pthread_mutex_lock(&queue->mutex);
+    clear_frames(queue);
+    pthread_mutex_unlock(&queue->mutex);
+    pthread_mutex_destroy(&queue->mutex);
+}
+
+void attach_outbound_queue(OutboundQueue *queue, int socket, int max_dropped) {//pripoji frontu ku klientskemu socketu
+    pthread_mutex_lock(&queue->mutex);
+    clear_frames(queue);
+    queue->socket = socket;
+    queue->dropped = 0;
+    queue->max_dropped = max_dropped;
+    queue->datagram_socket = -1;//nove spojenie si UDP otvori znova
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void set_datagram_address(OutboundQueue *queue, int socket, const struct sockaddr *address, socklen_t address_len) {//snapshoty pojdu cez UDP
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->socket >= 0 && address_len <= sizeof(queue->datagram_address)) {//len pripojena fronta
+        queue->datagram_socket = socket;
+        memcpy(&queue->datagram_address, address, address_len);
+        queue->datagram_address_len = address_len;
+    }
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void detach_outbound_queue(OutboundQueue *queue) {//odpoji frontu od socketu
+    pthread_mutex_lock(&queue->mutex);
+    clear_frames(queue);
+    queue->socket = -1;
+    queue->datagram_socket = -1;
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+static void disconnect_locked(OutboundQueue *queue) {//odpoji pomaleho alebo chybneho klienta (mutex musi byt zamknuty)
+    clear_frames(queue);
+    shutdown(queue->socket, SHUT_RDWR);//event loop uvidi odpojenie a zatvori spojenie
+    queue->socket = -1;
+    queue->datagram_socket = -1;
+}
+
+static void drop_stale_locked(OutboundQueue *queue) {//zahodi nezacate snapshoty, spolahlive ramce ponecha v poradi
+    int kept = 0;
+    for (int i = 0; i < queue->count; i++) {
+        int index = (queue->head + i) % OUTBOUND_QUEUE_CAPACITY;
+        Snapshot *frame = queue->frames[index];
+        bool reliable = queue->reliable[index];
+        queue->frames[index] = NULL;
+        queue->reliable[index] = false;
+
+        if (reliable || (i == 0 && queue->sent > 0)) {//rozposlany ramec sa musi dokoncit
+            int target = (queue->head + kept) % OUTBOUND_QUEUE_CAPACITY;
+            queue->frames[target] = frame;
+            queue->reliable[target] = reliable;
+            kept++;
+        } else {
+            release_snapshot(frame);
+            queue->dropped++;//klient nestihol prijat snapshot
+        }
+    }
+    queue->count = kept;
+}
+
+static void push_locked(OutboundQueue *queue, Snapshot *snapshot, bool reliable) {//prida ramec na koniec fronty a skusi poslat (mutex musi byt zamknuty)
+    if (queue->count == OUTBOUND_QUEUE_CAPACITY) {//fronta plna spolahlivych ramcov
+        disconnect_locked(queue);
+        return;
+    }
+
+    int tail = (queue->head + queue->count) % OUTBOUND_QUEUE_CAPACITY;
+    queue->frames[tail] = retain_snapshot(snapshot);//fronta drzi vlastnu referenciu
+    queue->reliable[tail] = reliable;
+    queue->count++;
+
+    if (!flush_locked(queue)) {//chyba socketu
+        disconnect_locked(queue);
+    }
+}
+
+void enqueue_snapshot(OutboundQueue *queue, Snapshot *snapshot) {//zaradi snapshot do fronty a skusi ho hned poslat
+    pthread_mutex_lock(&queue->mutex);
+
+    if (queue->socket < 0) {//fronta nie je pripojena
+        pthread_mutex_unlock(&queue->mutex);
+        return;
+    }
+
+    // Slow consumer: drop stale snapshots that were not started yet (keep the newest)
+    drop_stale_locked(queue);
+
+    // Reliable frames (roster, map) must reach the client before newer snapshots - UDP only once TCP is idle
+    size_t payload_size = snapshot->size - FRAME_HEADER_SIZE;
+    if (queue->datagram_socket >= 0 && payload_size <= DATAGRAM_MAX_PAYLOAD && flush_locked(queue) &&
+        queue->count == 0) {//UDP: stratu riesi dalsi snapshot
+        sendto(queue->datagram_socket, snapshot->data + FRAME_HEADER_SIZE, payload_size, 0,
+               (const struct sockaddr *)&queue->datagram_address, queue->datagram_address_len);//plny socket ho zahodi
+        queue->dropped = 0;//UDP klient TCP frontu nezahlcuje
+        pthread_mutex_unlock(&queue->mutex);
+        return;
+    }
+
+    if (queue->max_dropped > 0 && queue->dropped >= queue->max_dropped) {//klient je prilis pomaly
+        disconnect_locked(queue);
+        pthread_mutex_unlock(&queue->mutex);
+        return;
+    }
+
+    push_locked(queue, snapshot, false);
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void enqueue_reliable(OutboundQueue *queue, Snapshot *snapshot) {//zaradi ramec, ktory sa nesmie zahodit
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->socket >= 0) {//fronta je pripojena
+        push_locked(queue, snapshot, true);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+void shutdown_outbound_queue(OutboundQueue *queue) {//odpoji klienta (koniec hry)
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->socket >= 0) {
+        disconnect_locked(queue);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+bool flush_outbound_queue(OutboundQueue *queue) {//dokonci posielanie po EPOLLOUT
+    pthread_mutex_lock(&queue->mutex);
+    bool ok = queue->socket < 0 || flush_locked(queue);
+    pthread_mutex_unlock(&queue->mutex);
+    return ok;
+}
+
+bool drain_outbound_queue(OutboundQueue *queue, int timeout_ms) {//posle vsetky ramce, na socket caka najviac timeout_ms
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (true) {
+        pthread_mutex_lock(&queue->mutex);
+        int socket = queue->socket;
+        bool ok = socket < 0 || flush_locked(queue);
+        bool empty = queue->count == 0;
+        pthread_mutex_unlock(&queue->mutex);
+        if (!ok || empty || socket < 0) {
+            return ok && empty;
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int waited = (int)((now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000);
+        if (waited >= timeout_ms) {//klient neprijima
+            return false;
+        }
+        struct pollfd fd = { .fd = socket, .events = POLLOUT };
+        poll(&fd, 1, timeout_ms - waited);//cakaj kym sa socket uvolni
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ * @file outbound.h
+ * @brief Shared encoded snapshots and per-client outbound queues
+ *
+ * Every tick the game state is serialized once into an immutable,
+ * reference-counted Snapshot. Each client owns a bounded OutboundQueue of
+ * snapshot references that is drained with non-blocking sends outside the
+ * game mutex, so one slow client cannot stall the tick or other players.
+ * A client that opened a UDP channel gets snapshots that fit into one
+ * datagram over UDP instead, so a lost packet delays only that snapshot.
+ */
+
+#ifndef OUTBOUND_H
+#define OUTBOUND_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+/** Maximum frames queued per client (including the one being sent) */
+#define OUTBOUND_QUEUE_CAPACITY 8
+
+/** Default number of consecutive dropped snapshots before disconnect (0 = never) */
+#define DEFAULT_MAX_DROPPED_FRAMES 50
+
+/**
+ * @brief Immutable encoded frame shared by all clients
+ *
+ * Data already contains the frame length prefix, so it can be written
+ * to sockets as is.
+ */
+typedef struct {
+    atomic_int refcount;    /**< Number of holders (tick + queues) */
+    size_t size;            /**< Frame size in bytes (header + payload) */
+    uint8_t data[];         /**< Framed message */
+} Snapshot;
+
+/**
+ * @brief Bounded per-client queue of snapshots waiting to be sent
+ *
+ * Slow consumer policy: when a new snapshot arrives, every queued snapshot
+ * that was not started yet is stale and is dropped (only the newest is kept).
+ * After max_dropped consecutive drops the client is disconnected.
+ * Reliable frames (map, control messages) are never dropped; a client whose
+ * queue fills up with them is disconnected.
+ */
+typedef struct {
+    pthread_mutex_t mutex;                          /**< Protects queue (tick vs event loop) */
+    int socket;                                     /**< Client socket (-1 if detached) */
+    Snapshot *frames[OUTBOUND_QUEUE_CAPACITY];      /**< Ring of queued snapshots */
+    bool reliable[OUTBOUND_QUEUE_CAPACITY];         /**< Frame must not be dropped */
+    int head;                                       /**< Index of oldest queued snapshot */
+    int count;                                      /**< Number of queued snapshots */
+    size_t sent;                                    /**< Bytes of oldest snapshot already sent */
+    int dropped;                                    /**< Consecutive dropped snapshots */
+    int max_dropped;                                /**< Drop limit before disconnect (0 = never) */
+    int datagram_socket;                            /**< UDP socket for snapshots (-1 = TCP only) */
+    struct sockaddr_storage datagram_address;       /**< UDP address of client */
+    socklen_t datagram_address_len;                 /**< Size of datagram_address */
+} OutboundQueue;
+
+/**
+ * @brief Allocate snapshot for payload of given size
+ * @param payload_size Size of serialized message
+ * @return Snapshot with refcount 1 and written frame header, NULL on failure
+ *         or when payload exceeds MAX_MESSAGE_SIZE
+ *
+ * Caller serializes message into data + FRAME_HEADER_SIZE.
+ */
+Snapshot *create_snapshot(size_t payload_size);
+
+/**
+ * @brief Take additional reference to snapshot
+ * @param snapshot Snapshot
+ * @return The same snapshot
+ */
+Snapshot *retain_snapshot(Snapshot *snapshot);
+
+/**
+ * @brief Drop reference to snapshot, free it with the last one
+ * @param snapshot Snapshot (may be NULL)
+ */
+void release_snapshot(Snapshot *snapshot);
+
+/**
+ * @brief Initialize empty detached queue
+ * @param queue Queue to initialize
+ */
+void init_outbound_queue(OutboundQueue *queue);
+
+/**
+ * @brief Destroy queue and release queued snapshots
+ * @param queue Queue to destroy
+ */
+void destroy_outbound_queue(OutboundQueue *queue);
+
+/**
+ * @brief Attach queue to client socket
+ * @param queue Queue
+ * @param socket Non-blocking client socket
+ * @param max_dropped Consecutive drops before disconnect (0 = never)
+ */
+void attach_outbound_queue(OutboundQueue *queue, int socket, int max_dropped);
+
+/**
+ * @brief Send snapshots of queue as datagrams
+ * @param queue Attached queue
+ * @param socket Server UDP socket (-1 = back to TCP only)
+ * @param address UDP address of client
+ * @param address_len Size of address
+ *
+ * Snapshots larger than DATAGRAM_MAX_PAYLOAD and reliable frames still
+ * go over TCP. Attaching or detaching the queue switches back to TCP.
+ */
+void set_datagram_address(OutboundQueue *queue, int socket, const struct sockaddr *address, socklen_t address_len);
+
+/**
+ * @brief Detach queue from socket and release queued snapshots
+ * @param queue Queue
+ */
+void detach_outbound_queue(OutboundQueue *queue);
+
+/**
+ * @brief Queue snapshot for sending and try to send it right away
+ * @param queue Queue
+ * @param snapshot Snapshot (queue takes its own reference)
+ *
+ * Never blocks. Applies slow consumer policy; a client over the drop limit
+ * is shut down and the event loop then closes the connection. With a UDP
+ * channel the snapshot is sent as one datagram (a full UDP socket drops it)
+ * and queued snapshots that were not started are dropped as stale; while a
+ * reliable frame still waits on TCP the snapshot is queued behind it instead.
+ */
+void enqueue_snapshot(OutboundQueue *queue, Snapshot *snapshot);
+
+/**
+ * @brief Queue frame that must be delivered and try to send it right away
+ * @param queue Queue
+ * @param snapshot Frame (queue takes its own reference)
+ *
+ * Never blocks. Frame keeps its order relative to snapshots queued before
+ * and after it and is exempt from slow consumer policy.
+ */
+void enqueue_reliable(OutboundQueue *queue, Snapshot *snapshot);
+
+/**
+ * @brief Shut down client socket and release queued frames
+ * @param queue Queue
+ *
+ * Used when the game ends; the event loop then closes the connection.
+ */
+void shutdown_outbound_queue(OutboundQueue *queue);
+
+/**
+ * @brief Send queued snapshots until queue is empty or socket is full
+ * @param queue Queue
+ * @return false on socket error, true otherwise
+ *
+ * Called by the event loop when socket becomes writable.
+ */
+bool flush_outbound_queue(OutboundQueue *queue);
+
+/**
+ * @brief Send all queued frames, waiting for the socket if needed
+ * @param queue Queue (no frames may be queued concurrently)
+ * @param timeout_ms Longest wait for the client
+ * @return true if the queue is empty, false on socket error or timeout
+ *
+ * Used before the socket is handed to another process, so the client
+ * never receives a partial frame.
+ */
+bool drain_outbound_queue(OutboundQueue *queue, int timeout_ms);
+
+#endif // OUTBOUND_H
@@ -0,0 +1,659 @@
+#include "replay_log.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RECORD_PREFIX_MAX_SIZE 16   // typ, tick a dlzka payloadu
+#define TRAILER_SIZE 16             // offset indexu, pocet, magic
+
+static bool reserve_buffer(ReplayBuffer *buffer, size_t needed) {//zvacsi buffer aspon na needed bajtov
+    if (needed <= buffer->capacity) {
+        return true;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity * 2 : 256;
+    while (capacity < needed) {
+        capacity *= 2;
+    }
+    uint8_t *data = realloc(buffer->data, capacity);
+    if (!data) {
+        buffer->failed = true;
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+void free_replay_buffer(ReplayBuffer *buffer) {//uvolni buffer
+    free(buffer->data);
+    memset(buffer, 0, sizeof(ReplayBuffer));
+}
+
+void replay_put_u8(ReplayBuffer *buffer, uint8_t value) {//zapise jeden bajt
+    if (reserve_buffer(buffer, buffer->size + 1)) {
+        buffer->data[buffer->size++] = value;
+    }
+}
+
+void replay_put_varint(ReplayBuffer *buffer, uint32_t value) {//zapise cislo ako varint (7 bitov na bajt)
+    while (value >= 0x80) {
+        replay_put_u8(buffer, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    replay_put_u8(buffer, (uint8_t)value);
+}
+
+void replay_put_svarint(ReplayBuffer *buffer, int32_t value) {//zapise znamienkove cislo (zigzag varint)
+    replay_put_varint(buffer, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+void replay_put_u32(ReplayBuffer *buffer, uint32_t value) {//zapise 32-bit cislo (little-endian)
+    for (int i = 0; i < 4; i++) {
+        replay_put_u8(buffer, (uint8_t)(value >> (8 * i)));
+    }
+}
+
+void replay_put_u64(ReplayBuffer *buffer, uint64_t value) {//zapise 64-bit cislo (little-endian)
+    for (int i = 0; i < 8; i++) {
+        replay_put_u8(buffer, (uint8_t)(value >> (8 * i)));
+    }
+}
+
+void replay_put_string(ReplayBuffer *buffer, const char *text, size_t max) {//zapise retazec (dlzka + bajty)
+    size_t length = strnlen(text, max);
+    replay_put_varint(buffer, (uint32_t)length);
+    for (size_t i = 0; i < length; i++) {
+        replay_put_u8(buffer, (uint8_t)text[i]);
+    }
+}
+
+void replay_put_config(ReplayBuffer *buffer, const GameConfig *config) {//zapise konfiguraciu hry
+    replay_put_u8(buffer, (uint8_t)config->mode);
+    replay_put_u8(buffer, (uint8_t)config->world_type);
+    replay_put_varint(buffer, (uint32_t)config->width);
+    replay_put_varint(buffer, (uint32_t)config->height);
+    replay_put_varint(buffer, (uint32_t)config->time_limit);
+    replay_put_varint(buffer, (uint32_t)config->max_players);
+    replay_put_varint(buffer, (uint32_t)config->tick_rate);
+    replay_put_u8(buffer, config->load_from_file ? 1 : 0);
+    replay_put_string(buffer, config->map_file, sizeof(config->map_file));
+    replay_put_u64(buffer, config->seed);
+}
+
+uint8_t replay_get_u8(ReplayReader *reader) {//precita jeden bajt
+    if (reader->offset >= reader->size) {
+        reader->error = true;
+        return 0;
+    }
+    return reader->data[reader->offset++];
+}
+
+uint32_t replay_get_varint(ReplayReader *reader) {//precita varint
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte = replay_get_u8(reader);
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    reader->error = true;//prilis dlhy varint
+    return 0;
+}
+
+int32_t replay_get_svarint(ReplayReader *reader) {//precita znamienkove cislo (zigzag varint)
+    uint32_t value = replay_get_varint(reader);
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+uint32_t replay_get_u32(ReplayReader *reader) {//precita 32-bit cislo (little-endian)
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)replay_get_u8(reader) << (8 * i);
+    }
+    return value;
+}
+
+uint64_t replay_get_u64(ReplayReader *reader) {//precita 64-bit cislo (little-endian)
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)replay_get_u8(reader) << (8 * i);
+    }
+    return value;
+}
+
+void replay_get_string(ReplayReader *reader, char *text, size_t max) {//precita retazec, oreze ho na max - 1 znakov
+    uint32_t length = replay_get_varint(reader);
+    if (reader->error || length > reader->size - reader->offset) {
+        reader->error = true;
+        text[0] = '\0';
+        return;
+    }
+    size_t copied = length < max - 1 ? length : max - 1;
+    memcpy(text, reader->data + reader->offset, copied);
+    text[copied] = '\0';
+    reader->offset += length;
+}
+
+void replay_get_config(ReplayReader *reader, GameConfig *config) {//precita konfiguraciu hry
+    memset(config, 0, sizeof(GameConfig));
+    config->mode = (GameMode)replay_get_u8(reader);
+    config->world_type = (WorldType)replay_get_u8(reader);
+    config->width = (int)replay_get_varint(reader);
+    config->height = (int)replay_get_varint(reader);
+    config->time_limit = (int)replay_get_varint(reader);
+    config->max_players = (int)replay_get_varint(reader);
+    config->tick_rate = (int)replay_get_varint(reader);
+    config->load_from_file = replay_get_u8(reader) != 0;
+    replay_get_string(reader, config->map_file, sizeof(config->map_file));
+    config->seed = replay_get_u64(reader);
+}
+
+static void *writer_thread(void *arg) {//zapisuje nazbierane zaznamy na disk mimo tick vlakna
+    ReplayWriter *writer = arg;
+    uint8_t *spare = NULL;//druhy buffer (vymiena sa s aktivnym)
+    size_t spare_capacity = 0;
+
+    pthread_mutex_lock(&writer->mutex);
+    for (;;) {
+        if (writer->size == 0 && !writer->closing) {//nic na zapis - pockaj na zaznamy alebo interval
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += REPLAY_FLUSH_INTERVAL_MS / 1000;
+            deadline.tv_nsec += (REPLAY_FLUSH_INTERVAL_MS % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&writer->cond, &writer->mutex, &deadline);
+            continue;
+        }
+        if (writer->size == 0) {//zatvara sa a vsetko je zapisane
+            break;
+        }
+
+        // Swap buffers so producers keep appending while this one is written
+        uint8_t *data = writer->buffer;
+        size_t size = writer->size;
+        size_t capacity = writer->capacity;
+        writer->buffer = spare;
+        writer->capacity = spare_capacity;
+        writer->size = 0;
+        spare = data;
+        spare_capacity = capacity;
+        pthread_mutex_unlock(&writer->mutex);
+
+        bool ok = fwrite(data, 1, size, writer->file) == size;
+
+        pthread_mutex_lock(&writer->mutex);
+        if (!ok) {//disk je plny alebo subor zmizol - dalej nenahravaj
+            writer->failed = true;
+        }
+    }
+    pthread_mutex_unlock(&writer->mutex);
+    free(spare);
+    return NULL;
+}
+
+static size_t encode_varint(uint8_t *out, uint32_t value) {//varint do pola, vrati pocet bajtov
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[size++] = (uint8_t)value;
+    return size;
+}
+
+static bool append_locked(ReplayWriter *writer, const uint8_t *data, size_t size) {//prida bajty do bufferu (mutex musi byt zamknuty)
+    size_t needed = writer->size + size;
+    if (needed > writer->capacity) {//zvacsi buffer
+        size_t new_capacity = writer->capacity ? writer->capacity * 2 : REPLAY_FLUSH_BYTES * 2;
+        while (new_capacity < needed) {
+            new_capacity *= 2;
+        }
+        uint8_t *new_buffer = realloc(writer->buffer, new_capacity);
+        if (!new_buffer) {
+            writer->failed = true;
+            return false;
+        }
+        writer->buffer = new_buffer;
+        writer->capacity = new_capacity;
+    }
+    memcpy(writer->buffer + writer->size, data, size);
+    writer->size += size;
+    writer->length += size;
+    return true;
+}
+
+static void append_record(ReplayWriter *writer, ReplayRecordType type, int tick, const uint8_t *payload, size_t size) {//prida zaznam do bufferu
+    uint8_t prefix[RECORD_PREFIX_MAX_SIZE];
+    size_t prefix_size = 0;
+
+    pthread_mutex_lock(&writer->mutex);
+    if (writer->failed) {
+        pthread_mutex_unlock(&writer->mutex);
+        return;
+    }
+
+    uint64_t offset = writer->length;//offset zaznamu v subore (pre index)
+    prefix[prefix_size++] = (uint8_t)type;
+    if (type == REPLAY_KEYFRAME) {//absolutny tick - pri skoku sa nepozna predchadzajuci zaznam
+        prefix_size += encode_varint(prefix + prefix_size, (uint32_t)tick);
+        prefix_size += encode_varint(prefix + prefix_size, (uint32_t)size);
+    } else {//tiky rastu, delta je male cislo
+        prefix_size += encode_varint(prefix + prefix_size, (uint32_t)(tick - writer->last_tick));
+    }
+    writer->last_tick = tick;
+
+    if (append_locked(writer, prefix, prefix_size) && append_locked(writer, payload, size) &&
+        type == REPLAY_KEYFRAME) {//zaindexuj keyframe
+        if (writer->index_count == writer->index_capacity) {
+            int capacity = writer->index_capacity ? writer->index_capacity * 2 : 64;
+            ReplayKeyframeEntry *index = realloc(writer->index, capacity * sizeof(ReplayKeyframeEntry));
+            if (!index) {
+                writer->failed = true;
+                pthread_mutex_unlock(&writer->mutex);
+                return;
+            }
+            writer->index = index;
+            writer->index_capacity = capacity;
+        }
+        writer->index[writer->index_count].tick = tick;
+        writer->index[writer->index_count].offset = offset;
+        writer->index_count++;
+    }
+
+    if (writer->size >= REPLAY_FLUSH_BYTES || type == REPLAY_END) {//dost dat alebo koniec - zobud zapisovac
+        pthread_cond_signal(&writer->cond);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+}
+
+ReplayWriter *open_replay(const char *path, const GameConfig *config, uint32_t map_id) {//vytvori subor zaznamu a spusti zapisovac
+    ReplayWriter *writer = calloc(1, sizeof(ReplayWriter));
+    if (!writer) {
+        return NULL;
+    }
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        free(writer);
+        return NULL;
+    }
+
+    ReplayBuffer header = { 0 };//hlavicka sa zapise hned (este bez vlakna)
+    for (int i = 0; i < 4; i++) {
+        replay_put_u8(&header, (uint8_t)REPLAY_MAGIC[i]);
+    }
+    replay_put_u8(&header, REPLAY_VERSION);
+    replay_put_config(&header, config);
+    replay_put_u32(&header, map_id);
+    bool ok = !header.failed && fwrite(header.data, 1, header.size, writer->file) == header.size;
+    writer->length = header.size;
+    free_replay_buffer(&header);
+    if (!ok) {
+        fclose(writer->file);
+        free(writer);
+        return NULL;
+    }
+
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+    if (pthread_create(&writer->thread, NULL, writer_thread, writer) != 0) {
+        pthread_mutex_destroy(&writer->mutex);
+        pthread_cond_destroy(&writer->cond);
+        fclose(writer->file);
+        free(writer);
+        return NULL;
+    }
+    return writer;
+}
+
+void record_join(ReplayWriter *writer, int tick, int player_id, const char *name) {//zaznamena pripojenie hraca
+    uint8_t payload[1 + 5 + MAX_NAME_LENGTH];
+    size_t size = 0;
+    size_t length = strnlen(name, MAX_NAME_LENGTH);
+    payload[size++] = (uint8_t)player_id;
+    size += encode_varint(payload + size, (uint32_t)length);
+    memcpy(payload + size, name, length);
+    size += length;
+    append_record(writer, REPLAY_JOIN, tick, payload, size);
+}
+
+void record_leave(ReplayWriter *writer, int tick, int player_id) {//zaznamena odchod hraca
+    uint8_t payload[1] = { (uint8_t)player_id };
+    append_record(writer, REPLAY_LEAVE, tick, payload, sizeof(payload));
+}
+
+void record_command(ReplayWriter *writer, int tick, const PlayerCommand *command) {//zaznamena vykonany prikaz hraca
+    uint8_t payload[3] = { (uint8_t)command->type, (uint8_t)command->player_id, (uint8_t)command->direction };
+    append_record(writer, REPLAY_COMMAND, tick, payload, sizeof(payload));
+}
+
+void record_end(ReplayWriter *writer, int tick, uint32_t state_hash) {//zaznamena koniec hry
+    uint8_t payload[4];
+    for (int i = 0; i < 4; i++) {
+        payload[i] = (uint8_t)(state_hash >> (8 * i));
+    }
+    append_record(writer, REPLAY_END, tick, payload, sizeof(payload));
+}
+
+ReplayBuffer *begin_keyframe(ReplayWriter *writer) {//prazdny buffer pre dalsi keyframe (znovu pouzity)
+    writer->keyframe.size = 0;
+    writer->keyframe.failed = false;
+    replay_put_u32(&writer->keyframe, 0);//miesto pre hash stavu
+    return &writer->keyframe;
+}
+
+void record_keyframe(ReplayWriter *writer, int tick, uint32_t state_hash) {//zapise keyframe a prida ho do indexu
+    ReplayBuffer *keyframe = &writer->keyframe;
+    if (keyframe->failed) {//nedokonceny keyframe nezapisuj
+        return;
+    }
+    for (int i = 0; i < 4; i++) {//hash na zaciatku payloadu
+        keyframe->data[i] = (uint8_t)(state_hash >> (8 * i));
+    }
+    append_record(writer, REPLAY_KEYFRAME, tick, keyframe->data, keyframe->size);
+}
+
+void close_replay(ReplayWriter *writer) {//dopise zaznamy a index a zatvori subor
+    if (!writer) {
+        return;
+    }
+    pthread_mutex_lock(&writer->mutex);
+    writer->closing = true;
+    pthread_cond_signal(&writer->cond);
+    pthread_mutex_unlock(&writer->mutex);
+    pthread_join(writer->thread, NULL);//zapisovac skonci az po zapisani vsetkeho
+
+    if (!writer->failed) {//index keyframov a trailer na konci suboru
+        ReplayBuffer index = { 0 };
+        for (int i = 0; i < writer->index_count; i++) {
+            replay_put_varint(&index, (uint32_t)writer->index[i].tick);
+            replay_put_u64(&index, writer->index[i].offset);
+        }
+        replay_put_u64(&index, writer->length);
+        replay_put_u32(&index, (uint32_t)writer->index_count);
+        for (int i = 0; i < 4; i++) {
+            replay_put_u8(&index, (uint8_t)REPLAY_INDEX_MAGIC[i]);
+        }
+        if (!index.failed) {
+            fwrite(index.data, 1, index.size, writer->file);
+        }
+        free_replay_buffer(&index);
+    }
+
+    fclose(writer->file);
+    pthread_mutex_destroy(&writer->mutex);
+    pthread_cond_destroy(&writer->cond);
+    free(writer->buffer);
+    free_replay_buffer(&writer->keyframe);
+    free(writer->index);
+    free(writer);
+}
+
+static uint32_t hash_bytes(uint32_t hash, const void *data, size_t size) {//FNV-1a
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t hash_int(uint32_t hash, int64_t value) {//hashuje cislo nezavisle od paddingu struktur
+    return hash_bytes(hash, &value, sizeof(value));
+}
+
+uint32_t hash_game_state(const GameState *state) {//hash stavu simulacie (overenie prehravania)
+    uint32_t hash = 2166136261u;
+    hash = hash_int(hash, state->tick);
+    hash = hash_int(hash, state->time_ms);
+    hash = hash_int(hash, state->player_count);
+    hash = hash_int(hash, state->game_over);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        const Snake *snake = &state->snakes[i];
+        hash = hash_int(hash, snake->alive);
+        if (!snake->alive) {
+            continue;
+        }
+        hash = hash_int(hash, snake->length);
+        hash = hash_int(hash, snake->direction);
+        hash = hash_int(hash, snake->score);
+        hash = hash_int(hash, snake->paused);
+        for (int j = 0; j < snake->length; j++) {
+            Position segment = snake_segment(snake, j);
+            hash = hash_int(hash, segment.x);
+            hash = hash_int(hash, segment.y);
+        }
+    }
+    hash = hash_int(hash, state->food_count);
+    for (int i = 0; i < state->food_count; i++) {
+        hash = hash_int(hash, state->food[i].x);
+        hash = hash_int(hash, state->food[i].y);
+    }
+    return hash;
+}
+
+static bool add_keyframe_entry(ReplayReader *reader, int *capacity, int tick, uint64_t offset) {//prida polozku indexu
+    if (reader->keyframe_count == *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 64;
+        ReplayKeyframeEntry *keyframes = realloc(reader->keyframes, new_capacity * sizeof(ReplayKeyframeEntry));
+        if (!keyframes) {
+            return false;
+        }
+        reader->keyframes = keyframes;
+        *capacity = new_capacity;
+    }
+    reader->keyframes[reader->keyframe_count].tick = tick;
+    reader->keyframes[reader->keyframe_count].offset = offset;
+    reader->keyframe_count++;
+    return true;
+}
+
+static bool load_index(ReplayReader *reader) {//nacita index z konca suboru, false ak subor nema platny index
+    size_t size = reader->mapped_size;
+    if (size < reader->records_offset + TRAILER_SIZE ||
+        memcmp(reader->data + size - 4, REPLAY_INDEX_MAGIC, 4) != 0) {//subor nebol zatvoreny (alebo verzia 1)
+        return false;
+    }
+
+    ReplayReader trailer = *reader;
+    trailer.offset = size - TRAILER_SIZE;
+    trailer.size = size;
+    uint64_t index_offset = replay_get_u64(&trailer);
+    uint32_t count = replay_get_u32(&trailer);
+    if (index_offset < reader->records_offset || index_offset > size - TRAILER_SIZE) {
+        return false;
+    }
+
+    ReplayReader index = *reader;
+    index.offset = (size_t)index_offset;
+    index.size = size - TRAILER_SIZE;
+    int capacity = 0;
+    for (uint32_t i = 0; i < count && !index.error; i++) {
+        int tick = (int)replay_get_varint(&index);
+        uint64_t offset = replay_get_u64(&index);
+        if (offset < reader->records_offset || offset >= index_offset ||
+            !add_keyframe_entry(reader, &capacity, tick, offset)) {
+            index.error = true;
+        }
+    }
+    if (index.error) {//poskodeny index - radsej preskenuj zaznamy
+        free(reader->keyframes);
+        reader->keyframes = NULL;
+        reader->keyframe_count = 0;
+        return false;
+    }
+    reader->size = (size_t)index_offset;//zaznamy koncia pred indexom
+    return true;
+}
+
+static void scan_index(ReplayReader *reader) {//postavi index prechodom zaznamov (subor bez indexu)
+    int capacity = 0;
+    ReplayRecord record;
+    size_t start = reader->offset;
+    while (next_replay_record(reader, &record)) {
+        if (record.type == REPLAY_KEYFRAME && !add_keyframe_entry(reader, &capacity, record.tick, start)) {
+            break;
+        }
+        start = reader->offset;
+    }
+    if (reader->error) {//posledny zaznam je nedopisany (server spadol) - citaj len cele zaznamy
+        reader->size = start;
+        reader->error = false;
+    }
+    rewind_replay(reader);
+}
+
+bool open_replay_reader(ReplayReader *reader, const char *path) {//namapuje subor zaznamu, nacita hlavicku a index
+    memset(reader, 0, sizeof(ReplayReader));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);//mapovanie ostava platne
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    reader->data = data;
+    reader->size = (size_t)st.st_size;
+    reader->mapped_size = (size_t)st.st_size;
+
+    char magic[4];
+    for (int i = 0; i < 4; i++) {
+        magic[i] = (char)replay_get_u8(reader);
+    }
+    uint8_t version = replay_get_u8(reader);
+    if (memcmp(magic, REPLAY_MAGIC, 4) != 0 || version < 1 || version > REPLAY_VERSION) {//iny subor alebo novsia verzia
+        close_replay_reader(reader);
+        return false;
+    }
+
+    replay_get_config(reader, &reader->config);
+    reader->map_id = replay_get_u32(reader);
+    if (reader->error) {
+        close_replay_reader(reader);
+        return false;
+    }
+    reader->records_offset = reader->offset;
+
+    if (!load_index(reader)) {
+        scan_index(reader);
+    }
+    return true;
+}
+
+bool next_replay_record(ReplayReader *reader, ReplayRecord *record) {//precita dalsi zaznam
+    if (reader->error || reader->offset >= reader->size) {//koniec zaznamov
+        return false;
+    }
+    memset(record, 0, sizeof(ReplayRecord));
+    record->type = (ReplayRecordType)replay_get_u8(reader);
+    if (record->type == REPLAY_KEYFRAME) {//keyframe ma absolutny tick
+        reader->tick = (int)replay_get_varint(reader);
+    } else {
+        reader->tick += (int)replay_get_varint(reader);
+    }
+    record->tick = reader->tick;
+
+    switch (record->type) {
+        case REPLAY_JOIN:
+            record->player_id = replay_get_u8(reader);
+            replay_get_string(reader, record->name, sizeof(record->name));
+            break;
+        case REPLAY_LEAVE:
+            record->player_id = replay_get_u8(reader);
+            break;
+        case REPLAY_COMMAND:
+            record->command.type = (CommandType)replay_get_u8(reader);
+            record->command.player_id = replay_get_u8(reader);
+            record->command.direction = (Direction)replay_get_u8(reader);
+            record->player_id = record->command.player_id;
+            break;
+        case REPLAY_END:
+            record->state_hash = replay_get_u32(reader);
+            break;
+        case REPLAY_KEYFRAME: {//payload sa len preskoci, dekoduje ho hra (open_keyframe)
+            uint32_t size = replay_get_varint(reader);
+            if (reader->error || size < 4 || size > reader->size - reader->offset) {
+                reader->error = true;
+                break;
+            }
+            record->payload_offset = reader->offset;
+            record->payload_size = size;
+            record->state_hash = replay_get_u32(reader);
+            reader->offset = record->payload_offset + size;
+            break;
+        }
+        default:
+            reader->error = true;//neznamy typ zaznamu
+            break;
+    }
+    if (record->player_id >= MAX_PLAYERS) {
+        reader->error = true;
+    }
+    return !reader->error;
+}
+
+bool seek_replay(ReplayReader *reader, int tick, ReplayRecord *keyframe) {//skoci na najblizsi keyframe pred tickom
+    int low = 0;
+    int high = reader->keyframe_count - 1;
+    int found = -1;
+    while (low <= high) {//posledny keyframe s tickom <= tick
+        int mid = (low + high) / 2;
+        if (reader->keyframes[mid].tick <= tick) {
+            found = mid;
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    if (found < 0) {
+        return false;
+    }
+
+    size_t saved_offset = reader->offset;
+    int saved_tick = reader->tick;
+    reader->offset = (size_t)reader->keyframes[found].offset;
+    if (!next_replay_record(reader, keyframe) || keyframe->type != REPLAY_KEYFRAME) {//index ukazuje mimo keyframe
+        reader->error = false;
+        reader->offset = saved_offset;
+        reader->tick = saved_tick;
+        return false;
+    }
+    return true;
+}
+
+void rewind_replay(ReplayReader *reader) {//spat na prvy zaznam
+    reader->offset = reader->records_offset;
+    reader->tick = 0;
+    reader->error = false;
+}
+
+void open_keyframe(const ReplayReader *reader, const ReplayRecord *record, ReplayReader *payload) {//pohlad na payload keyframu
+    memset(payload, 0, sizeof(ReplayReader));
+    payload->config = reader->config;
+    payload->map_id = reader->map_id;
+    payload->data = reader->data;
+    payload->offset = record->payload_offset + 4;//za hashom stavu
+    payload->size = record->payload_offset + record->payload_size;
+}
+
+void close_replay_reader(ReplayReader *reader) {//odmapuje subor a uvolni index
+    if (reader->mapped_size > 0) {
+        munmap((void *)reader->data, reader->mapped_size);
+    }
+    free(reader->keyframes);
+    memset(reader, 0, sizeof(ReplayReader));
+}
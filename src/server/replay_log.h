@@ -0,0 +1,373 @@
+/**
+ * @file replay_log.h
+ * @brief Binary replay log of one game (recording, reading and seeking)
+ *
+ * A replay holds everything the simulation depends on: the resolved game
+ * configuration (seed and tick rate included) and every event that changes
+ * the game between ticks, in the order the game applied them: joins,
+ * leaves and applied player commands. Re-running create_game and
+ * update_game with these events reproduces the game tick for tick; the
+ * closing record stores a hash of the final state to verify that.
+ *
+ * Every REPLAY_KEYFRAME_INTERVAL ticks the game also stores a keyframe,
+ * its complete simulation state, and a closed replay ends with an index
+ * of all keyframes. A reader maps the file and seeks to any tick by
+ * restoring the nearest earlier keyframe and re-simulating at most
+ * REPLAY_KEYFRAME_INTERVAL ticks. Files without index (server crashed)
+ * are indexed by one scan when opened.
+ *
+ * File layout: header ("SNKR", version, config, map ID), then records of
+ * type byte, varint tick delta to the previous record and payload
+ * (keyframes store the absolute tick and a varint payload size instead, so
+ * a reader can start at any of them), then the optional index (varint
+ * tick and u64 offset per keyframe) with a fixed trailer (u64 index
+ * offset, u32 count, "SNKI"). Integers wider than a byte are little-endian.
+ * Records are appended to a memory buffer under a short lock and written
+ * to disk by a per-replay writer thread, so the tick never waits on I/O.
+ */
+
+#ifndef REPLAY_LOG_H
+#define REPLAY_LOG_H
+
+#include "protocol.h"
+#include "command_queue.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/** File magic */
+#define REPLAY_MAGIC "SNKR"
+
+/** Index trailer magic */
+#define REPLAY_INDEX_MAGIC "SNKI"
+
+/** Format version (1 = without keyframes) */
+#define REPLAY_VERSION 2
+
+/** Ticks between keyframes (upper bound of re-simulation when seeking) */
+#define REPLAY_KEYFRAME_INTERVAL 100
+
+/** Pending bytes that wake the writer thread early */
+#define REPLAY_FLUSH_BYTES 4096
+
+/** Longest time a record waits in memory before it is written (ms) */
+#define REPLAY_FLUSH_INTERVAL_MS 1000
+
+/**
+ * @brief Replay record types
+ */
+typedef enum {
+    REPLAY_JOIN = 1,    /**< Player joined (slot, name) */
+    REPLAY_LEAVE,       /**< Player left (slot) */
+    REPLAY_COMMAND,     /**< Player command applied by the game */
+    REPLAY_END,         /**< Recording ended (final state hash) */
+    REPLAY_KEYFRAME     /**< Complete simulation state after tick */
+} ReplayRecordType;
+
+/**
+ * @brief One replay record
+ *
+ * tick is the number of ticks the game had completed when the event was
+ * applied, i.e. the event happened before tick + 1.
+ */
+typedef struct {
+    ReplayRecordType type;          /**< Record type */
+    int tick;                       /**< Completed ticks at the event */
+    int player_id;                  /**< Player slot (JOIN, LEAVE) */
+    char name[MAX_NAME_LENGTH];     /**< Player name (JOIN) */
+    PlayerCommand command;          /**< Applied command (COMMAND) */
+    uint32_t state_hash;            /**< hash_game_state of state (END, KEYFRAME) */
+    size_t payload_offset;          /**< File offset of keyframe payload (KEYFRAME) */
+    size_t payload_size;            /**< Size of keyframe payload incl. hash (KEYFRAME) */
+} ReplayRecord;
+
+/**
+ * @brief Keyframe index entry
+ */
+typedef struct {
+    int tick;           /**< Tick of keyframe */
+    uint64_t offset;    /**< File offset of keyframe record */
+} ReplayKeyframeEntry;
+
+/**
+ * @brief Growable encoding buffer (keyframe payloads)
+ */
+typedef struct {
+    uint8_t *data;      /**< Encoded bytes */
+    size_t size;        /**< Bytes used */
+    size_t capacity;    /**< Allocated size */
+    bool failed;        /**< Allocation failed, contents are incomplete */
+} ReplayBuffer;
+
+/**
+ * @brief Replay being recorded
+ *
+ * Producers append under mutex (callers already serialize a game's
+ * records through the game mutex); the writer thread swaps the buffer
+ * out and writes it without holding the lock.
+ */
+typedef struct {
+    pthread_mutex_t mutex;          /**< Protects buffer, index and flags */
+    pthread_cond_t cond;            /**< Wakes writer thread */
+    FILE *file;                     /**< Output file (writer thread only) */
+    uint8_t *buffer;                /**< Encoded records not yet written */
+    size_t size;                    /**< Bytes in buffer */
+    size_t capacity;                /**< Allocated size of buffer */
+    uint64_t length;                /**< File length once everything appended is written */
+    int last_tick;                  /**< Tick of previous record (delta base) */
+    ReplayBuffer keyframe;          /**< Keyframe being encoded (producer only) */
+    ReplayKeyframeEntry *index;     /**< Keyframes appended so far */
+    int index_count;                /**< Number of index entries */
+    int index_capacity;             /**< Allocated size of index */
+    bool closing;                   /**< Writer should flush and exit */
+    bool failed;                    /**< Allocation or write error, recording stopped */
+    pthread_t thread;               /**< Writer thread */
+} ReplayWriter;
+
+/**
+ * @brief Replay mapped for reading
+ *
+ * Also used as a view of a single keyframe payload (see open_keyframe).
+ */
+typedef struct {
+    GameConfig config;              /**< Recorded game configuration */
+    uint32_t map_id;                /**< Map the recorded game ran on */
+    const uint8_t *data;            /**< Mapped file */
+    size_t size;                    /**< End of readable data (records end before index) */
+    size_t mapped_size;             /**< Size of mapping (0 for views) */
+    size_t records_offset;          /**< Offset of first record */
+    size_t offset;                  /**< Read position of next record */
+    int tick;                       /**< Tick of last read record */
+    ReplayKeyframeEntry *keyframes; /**< Keyframe index sorted by tick */
+    int keyframe_count;             /**< Number of keyframes */
+    bool error;                     /**< File is truncated or corrupt */
+} ReplayReader;
+
+/**
+ * @brief Free buffer memory and reset it to empty
+ * @param buffer Buffer
+ */
+void free_replay_buffer(ReplayBuffer *buffer);
+
+/**
+ * @brief Append byte to buffer
+ * @param buffer Buffer
+ * @param value Byte
+ */
+void replay_put_u8(ReplayBuffer *buffer, uint8_t value);
+
+/**
+ * @brief Append unsigned varint (7 bits per byte)
+ * @param buffer Buffer
+ * @param value Value
+ */
+void replay_put_varint(ReplayBuffer *buffer, uint32_t value);
+
+/**
+ * @brief Append signed varint (zigzag)
+ * @param buffer Buffer
+ * @param value Value
+ */
+void replay_put_svarint(ReplayBuffer *buffer, int32_t value);
+
+/**
+ * @brief Append 32-bit little-endian integer
+ * @param buffer Buffer
+ * @param value Value
+ */
+void replay_put_u32(ReplayBuffer *buffer, uint32_t value);
+
+/**
+ * @brief Append 64-bit little-endian integer
+ * @param buffer Buffer
+ * @param value Value
+ */
+void replay_put_u64(ReplayBuffer *buffer, uint64_t value);
+
+/**
+ * @brief Append length-prefixed string
+ * @param buffer Buffer
+ * @param text String
+ * @param max Size of the string's array (longer strings are cut)
+ */
+void replay_put_string(ReplayBuffer *buffer, const char *text, size_t max);
+
+/**
+ * @brief Append game configuration (replay header, checkpoints)
+ * @param buffer Buffer
+ * @param config Configuration
+ */
+void replay_put_config(ReplayBuffer *buffer, const GameConfig *config);
+
+/**
+ * @brief Read byte (sets reader->error past the end)
+ * @param reader Reader
+ * @return Byte, 0 on error
+ */
+uint8_t replay_get_u8(ReplayReader *reader);
+
+/**
+ * @brief Read unsigned varint
+ * @param reader Reader
+ * @return Value, 0 on error
+ */
+uint32_t replay_get_varint(ReplayReader *reader);
+
+/**
+ * @brief Read signed varint (zigzag)
+ * @param reader Reader
+ * @return Value, 0 on error
+ */
+int32_t replay_get_svarint(ReplayReader *reader);
+
+/**
+ * @brief Read 32-bit little-endian integer
+ * @param reader Reader
+ * @return Value, 0 on error
+ */
+uint32_t replay_get_u32(ReplayReader *reader);
+
+/**
+ * @brief Read 64-bit little-endian integer
+ * @param reader Reader
+ * @return Value, 0 on error
+ */
+uint64_t replay_get_u64(ReplayReader *reader);
+
+/**
+ * @brief Read length-prefixed string
+ * @param reader Reader
+ * @param text Output string (always terminated)
+ * @param max Size of text
+ */
+void replay_get_string(ReplayReader *reader, char *text, size_t max);
+
+/**
+ * @brief Read game configuration written by replay_put_config
+ * @param reader Reader
+ * @param config Output configuration
+ */
+void replay_get_config(ReplayReader *reader, GameConfig *config);
+
+/**
+ * @brief Create replay file and start its writer thread
+ * @param path Output file path
+ * @param config Resolved game configuration (seed and tick rate set)
+ * @param map_id Map ID of the game (checked on playback)
+ * @return Writer, or NULL if the file cannot be created
+ */
+ReplayWriter *open_replay(const char *path, const GameConfig *config, uint32_t map_id);
+
+/**
+ * @brief Record player join
+ * @param writer Replay
+ * @param tick Completed ticks
+ * @param player_id Assigned slot
+ * @param name Player name
+ */
+void record_join(ReplayWriter *writer, int tick, int player_id, const char *name);
+
+/**
+ * @brief Record player leave
+ * @param writer Replay
+ * @param tick Completed ticks
+ * @param player_id Slot
+ */
+void record_leave(ReplayWriter *writer, int tick, int player_id);
+
+/**
+ * @brief Record applied player command
+ * @param writer Replay
+ * @param tick Completed ticks
+ * @param command Command
+ */
+void record_command(ReplayWriter *writer, int tick, const PlayerCommand *command);
+
+/**
+ * @brief Record end of game
+ * @param writer Replay
+ * @param tick Completed ticks
+ * @param state_hash hash_game_state of final state
+ */
+void record_end(ReplayWriter *writer, int tick, uint32_t state_hash);
+
+/**
+ * @brief Start encoding keyframe
+ * @param writer Replay
+ * @return Empty buffer for the keyframe payload, owned by writer
+ */
+ReplayBuffer *begin_keyframe(ReplayWriter *writer);
+
+/**
+ * @brief Append keyframe encoded since begin_keyframe and index it
+ * @param writer Replay
+ * @param tick Completed ticks
+ * @param state_hash hash_game_state of state
+ */
+void record_keyframe(ReplayWriter *writer, int tick, uint32_t state_hash);
+
+/**
+ * @brief Write pending records and index, stop writer thread, close file
+ * @param writer Replay (may be NULL)
+ */
+void close_replay(ReplayWriter *writer);
+
+/**
+ * @brief Hash of simulation state (FNV-1a)
+ * @param state Game state
+ * @return Hash of tick, time, snakes and food
+ */
+uint32_t hash_game_state(const GameState *state);
+
+/**
+ * @brief Map replay file, parse its header and load keyframe index
+ * @param reader Reader to initialize
+ * @param path File path
+ * @return true on success, false if file is missing or not a replay
+ *
+ * Without index the records are scanned once; a partially written last
+ * record (server crashed) is then cut off instead of reported as corrupt.
+ */
+bool open_replay_reader(ReplayReader *reader, const char *path);
+
+/**
+ * @brief Read next record
+ * @param reader Reader
+ * @param record Output record (keyframe payloads are skipped, see open_keyframe)
+ * @return true if a record was read, false at end of records or on error
+ *         (reader->error is set for corrupt files)
+ */
+bool next_replay_record(ReplayReader *reader, ReplayRecord *record);
+
+/**
+ * @brief Position reader at nearest keyframe at or before tick
+ * @param reader Reader
+ * @param tick Target tick
+ * @param keyframe Output keyframe record; the next record read follows it
+ * @return true if found, false if tick is before the first keyframe
+ *         (reader is unchanged, re-simulate from the start instead)
+ */
+bool seek_replay(ReplayReader *reader, int tick, ReplayRecord *keyframe);
+
+/**
+ * @brief Position reader at first record (game start)
+ * @param reader Reader
+ */
+void rewind_replay(ReplayReader *reader);
+
+/**
+ * @brief Create view of keyframe payload for decoding
+ * @param reader Reader the record was read from
+ * @param record Keyframe record
+ * @param payload Output view; read it with replay_get_* and check error
+ */
+void open_keyframe(const ReplayReader *reader, const ReplayRecord *record, ReplayReader *payload);
+
+/**
+ * @brief Unmap file and free index
+ * @param reader Reader
+ */
+void close_replay_reader(ReplayReader *reader);
+
+#endif // REPLAY_LOG_H
@@ -0,0 +1,49 @@
+#include "rng.h"
+
+static uint64_t rotl(uint64_t x, int k) {//rotacia dolava
+    return (x << k) | (x >> (64 - k));
+}
+
+uint64_t splitmix64(uint64_t *state) {//dalsia hodnota splitmix64 (rozptyl seedu)
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void seed_rng(Rng *rng, uint64_t seed) {//naplni stav zo seedu (nikdy nie same nuly)
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&seed);
+    }
+}
+
+uint64_t rng_next(Rng *rng) {//xoshiro256**
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+uint32_t rng_below(Rng *rng, uint32_t bound) {//rovnomerne cislo z [0, bound) (Lemireho metoda)
+    uint64_t product = (rng_next(rng) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+    if (low < bound) {//mozno v skreslenej oblasti
+        uint32_t threshold = -bound % bound;
+        while (low < threshold) {//zamietni a skus znova
+            product = (rng_next(rng) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+    return (uint32_t)(product >> 32);
+}
+
+double rng_unit(Rng *rng) {//rovnomerne cislo z [0, 1) (53 bitov)
+    return (rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file rng.h
+ * @brief Per-game pseudo-random number generator (xoshiro256**)
+ *
+ * Every game owns its generator, so games never contend on or correlate
+ * through the global rand() state, and a game started with the same seed
+ * generates the same map and food sequence. Seeds are expanded with
+ * splitmix64, which also derives the seeds of successive games from one
+ * server seed.
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * @brief Generator state
+ */
+typedef struct {
+    uint64_t s[4];  /**< xoshiro256** state (never all zero) */
+} Rng;
+
+/**
+ * @brief Next output of splitmix64 sequence
+ * @param state Sequence state, advanced by the call
+ * @return Well-mixed 64-bit value
+ */
+uint64_t splitmix64(uint64_t *state);
+
+/**
+ * @brief Seed generator
+ * @param rng Generator
+ * @param seed Any 64-bit seed (0 included)
+ */
+void seed_rng(Rng *rng, uint64_t seed);
+
+/**
+ * @brief Next 64 random bits
+ * @param rng Generator
+ * @return Random value
+ */
+uint64_t rng_next(Rng *rng);
+
+/**
+ * @brief Uniform random integer below bound (without modulo bias)
+ * @param rng Generator
+ * @param bound Exclusive upper bound (> 0)
+ * @return Value in [0, bound)
+ */
+uint32_t rng_below(Rng *rng, uint32_t bound);
+
+/**
+ * @brief Uniform random double
+ * @param rng Generator
+ * @return Value in [0, 1)
+ */
+double rng_unit(Rng *rng);
+
+#endif // RNG_H
@@ -2,16 +2,17 @@
 #include "protocol.h"
 #include "network.h"
 #include "game_logic.h"
+#include "game_registry.h"
+#include "event_loop.h"
+#include "checkpoint.h"
+#include "handoff.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
 #include <signal.h>
 #include <time.h>
-#include <sys/select.h>
-#include <sys/time.h>
 
-static Game *game = NULL;//globalna hra
 static volatile bool server_running = true;//server bezi
 
 void signal_handler(int sig) {//spracovanie signalov (Ctrl+C)
@@ -19,109 +20,34 @@ void signal_handler(int sig) {//spracovanie signalov (Ctrl+C)
     server_running = false;//zastav server
 }
 
-void *client_handler(void *arg) {//vlakno pre obsluhu jedneho klienta
-    int client_socket = *(int *)arg;//socket klienta
-    free(arg);//uvolni argument
-    
-    uint8_t buffer[BUFFER_SIZE];//buffer pre prijem dat
-    int player_id = -1;//ID hraca (este nepridelene)
-    
-    while (server_running && game->running) {//kym bezi server a hra
-        ssize_t received = receive_data(client_socket, buffer, BUFFER_SIZE);//prijmi data od klienta
-        if (received <= 0) {//chyba alebo odpojenie
-            break;
-        }
-        
-        Message msg;
-        if (!deserialize_message(buffer, received, &msg)) {//deserializuj spravu
-            continue;//neplatna sprava, ignoruj
-        }
-        
-        switch (msg.type) {//spracuj spravu podla typu
-            case MSG_JOIN_GAME://klient sa chce pripojit do hry
-                if (player_id == -1) {//ak este nema pridelene ID
-                    player_id = add_player(game, client_socket, msg.data.join_info.name);//pridaj hraca
-                    if (player_id == -1) {//ak sa nepodarilo pridat (hra plna)
-                        Message error_msg;//vytvor chybovu spravu
-                        error_msg.type = MSG_ERROR;
-                        if (game->state.max_players == 1) {
-                            strcpy(error_msg.data.error_msg, "Game is singleplayer only");
-                        } else {
-                            snprintf(error_msg.data.error_msg, sizeof(error_msg.data.error_msg),
-                                    "Game is full (%d/%d players)", 
-                                    game->state.player_count, game->state.max_players);
-                        }
-                        size_t size;
-                        serialize_message(&error_msg, buffer, &size);//serializuj chybu
-                        send_data(client_socket, buffer, size);//posli chybu klientovi
-                        goto cleanup;//ukonci spojenie
-                    }
-                    printf("Player %d (%s) joined the game\n", player_id, msg.data.join_info.name);
-                }
-                break;
-                
-            case MSG_PLAYER_INPUT://vstup od hraca (smer)
-                if (player_id != -1) {
-                    handle_player_input(game, player_id, msg.data.direction);//spracuj vstup
-                }
-                break;
-                
-            case MSG_PAUSE://pozastavenie hry
-                if (player_id != -1) {
-                    pause_player(game, player_id);//pozastav hraca
-                }
-                break;
-                
-            case MSG_RESUME://obnovenie hry
-                if (player_id != -1) {
-                    resume_player(game, player_id);//obnov hraca
-                }
-                break;
-                
-            case MSG_PLAYER_DISCONNECT://hrac sa odpaja
-                goto cleanup;//ukonci spojenie
-                
-            default:
-                break;
-        }
+static bool hand_off(int successor, EventLoop *loop, GameRegistry *registry, int server_socket,
+                     int datagram_socket) {//odovzda hry a klientov novemu procesu
+    suspend_games(registry);//stav hier sa po aktualnom tiku uz nemeni
+    int count = 0;
+    HandoffConnection *connections = export_connections(loop, &count);
+    bool ok = connections && send_handoff(successor, server_socket, datagram_socket, registry, connections, count);
+    free(connections);
+    if (ok) {
+        abandon_connections(loop);//klientov drzi nasledovnik
+    } else {
+        resume_games(registry);//nasledovnik nic neprevzal
     }
-    
-cleanup://upratanie po odpojeni klienta
-    if (player_id != -1) {//ak mal pridelene ID
-        printf("Player %d disconnected\n", player_id);
-        remove_player(game, player_id);//odstran hraca z hry
-    }
-    close_socket(client_socket);//zatvor socket
-    return NULL;
-}
-
-void *game_loop(void *arg) {//hlavna slucka hry (bezi v samostatnom vlakne)
-    (void)arg;
-    
-    while (server_running && game->running && !game->state.game_over) {//kym bezi server, hra a nie je game over
-        update_game(game);//aktualizuj stav hry (jeden tick)
-        broadcast_game_state(game);//posli stav vsetkym klientom
-        usleep(1000000 / TICK_RATE);//cakaj 100ms (10 tikov za sekundu)
-    }
-    
-    // Game over - send final state
-    if (game->state.game_over) {//ak je hra ukoncena
-        printf("Game over!\n");
-        broadcast_game_state(game);//posli finalne stav
-        
-        // Wait a bit for clients to receive final state
-        sleep(2);//pocakaj aby klienti dostali finalny stav
-        
-        // Stop the server
-        server_running = false;//zastav server
-    }
-    
-    server_running = false;//zastav server
-    return NULL;
+    return ok;
 }
 
 int main(int argc, char *argv[]) {//hlavna funkcia servera
     int port = DEFAULT_PORT;//default port 8888
+    int max_dropped_frames = DEFAULT_MAX_DROPPED_FRAMES;//limit zahodenych snapshotov pre pomaleho klienta
+    int tick_rate = DEFAULT_TICK_RATE;//tiky za sekundu (uvodna hra aj predvolena pre nove hry)
+    int max_catch_up = DEFAULT_MAX_CATCH_UP_TICKS;//kolko zmeskanych tikov sa dobehne
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t seed = ((uint64_t)now.tv_sec << 32) ^ (uint64_t)now.tv_nsec ^ (uint64_t)getpid();//bez -s nahodny seed
+    const char *replay_dir = NULL;//adresar so zaznamami hier
+    const char *checkpoint_dir = NULL;//adresar checkpointov beziacich hier
+    const char *handoff_path = NULL;//Unix socket na odovzdanie hier novemu procesu
+    bool on_demand = false;//bez uvodnej hry, koniec po skonceni poslednej hry
+    bool use_datagrams = false;//snapshoty aj cez UDP (na rovnakom cisle portu)
     GameConfig config;//konfiguracia hry
     
     // Default configuration
@@ -133,6 +59,8 @@ int main(int argc, char *argv[]) {//hlavna funkcia servera
     config.load_from_file = false;//negeneruj z mapy
     config.map_file[0] = '\0';//prazdny nazov suboru
     config.max_players = MAX_PLAYERS;//max 8 hracov (multiplayer)
+    config.tick_rate = 0;//predvolena rychlost servera
+    config.seed = 0;//seed odvodeny zo seedu servera
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {//spracuj argumenty prikazoveho riadka
@@ -161,74 +89,183 @@ int main(int argc, char *argv[]) {//hlavna funkcia servera
             if (config.max_players < 1) config.max_players = 1;//min 1
             if (config.max_players > MAX_PLAYERS) config.max_players = MAX_PLAYERS;//max 8
             i++;
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {//odpojenie pomaleho klienta po N zahodenych snapshotoch
+            max_dropped_frames = atoi(argv[i + 1]);
+            if (max_dropped_frames < 0) max_dropped_frames = 0;//0 = nikdy neodpajaj, len drz najnovsi
+            i++;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {//rychlost hry v tikoch za sekundu
+            tick_rate = atoi(argv[i + 1]);
+            if (tick_rate < 1) tick_rate = 1;//min 1
+            if (tick_rate > MAX_TICK_RATE) tick_rate = MAX_TICK_RATE;//max 100
+            i++;
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {//max. pocet dobiehanych tikov po oneskoreni
+            max_catch_up = atoi(argv[i + 1]);
+            if (max_catch_up < 0) max_catch_up = 0;//0 = zmeskane tiky sa preskocia
+            i++;
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {//seed servera (reprodukovatelne mapy a jedlo)
+            seed = strtoull(argv[i + 1], NULL, 0);
+            i++;
+        } else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc) {//nahravaj kazdu hru do adresara
+            replay_dir = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-C") == 0 && i + 1 < argc) {//checkpointy hier a obnova po restarte
+            checkpoint_dir = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-H") == 0 && i + 1 < argc) {//prevezmi hry beziaceho servera / odovzdaj ich dalsiemu
+            handoff_path = argv[i + 1];
+            i++;
+        } else if (strcmp(argv[i], "-x") == 0) {//hry vytvaraju klienti, server skonci s poslednou
+            on_demand = true;
+        } else if (strcmp(argv[i], "-u") == 0) {//snapshoty cez UDP pre klientov, ktori ho otvoria
+            use_datagrams = true;
         }
     }
     
-    srand(time(NULL));//inicializuj generator nahodnych cisel
     signal(SIGINT, signal_handler);//nastav handler pre Ctrl+C
     signal(SIGTERM, signal_handler);//nastav handler pre SIGTERM
     
     printf("Starting Snake Game Server...\n");
     printf("Port: %d\n", port);
-    printf("Mode: %s\n", config.mode == MODE_STANDARD ? "Standard" : "Timed");
-    printf("World: %dx%d\n", config.width, config.height);
-    printf("Obstacles: %s\n", config.world_type == WORLD_WITH_OBSTACLES ? "Yes" : "No");
-    printf("Max players: %d (%s)\n", config.max_players, 
-           config.max_players == 1 ? "Singleplayer" : "Multiplayer");
-    
-    // Create game
-    game = create_game(&config);//vytvor hru s danou konfiguraciou
-    if (!game) {//ak sa nepodarilo vytvorit
-        fprintf(stderr, "Failed to create game\n");
-        return 1;
+    printf("Seed: %llu\n", (unsigned long long)seed);
+    
+    GameRegistry registry;//vsetky hry tohto procesu
+    init_game_registry(&registry, max_dropped_frames, on_demand, seed);
+    registry.default_tick_rate = tick_rate;
+    registry.max_catch_up = max_catch_up;
+    registry.replay_dir = replay_dir;
+    
+    int server_socket = -1;//pocuvajuci socket (vlastny alebo prevzaty)
+    int datagram_socket = -1;//UDP socket snapshotov (vlastny alebo prevzaty)
+    HandoffConnection *handed = NULL;//spojenia prevzate od predchodcu
+    int handed_count = 0;
+    int predecessor = handoff_path ? request_handoff(handoff_path) : -1;//bezi uz server s touto cestou?
+    if (predecessor >= 0) {
+        bool taken = receive_handoff(predecessor, &registry, &server_socket, &datagram_socket, &handed, &handed_count);
+        close(predecessor);//predchodca skonci
+        if (!taken) {
+            fprintf(stderr, "Failed to take over running server\n");
+            destroy_game_registry(&registry);
+            return 1;
+        }
+        printf("Took over running server (%d connections)\n", handed_count);
+    }
+    
+    int restored = predecessor >= 0 ? 1 : 0;//hry obnovene z checkpointov alebo prevzate
+    Checkpointer *checkpointer = NULL;
+    if (checkpoint_dir) {
+        if (predecessor < 0) {//prevzate hry su novsie nez checkpointy
+            restored = restore_checkpoints(&registry, checkpoint_dir);//hry pred padom/restartom bezia dalej
+        }
+        checkpointer = start_checkpoints(&registry, checkpoint_dir);
+        if (!checkpointer) {
+            fprintf(stderr, "Cannot write checkpoints to %s\n", checkpoint_dir);
+            destroy_game_registry(&registry);
+            return 1;
+        }
+    }
+    
+    if (!on_demand && restored == 0) {//uvodna hra podla argumentov (obnovene hry ju nahradia)
+        printf("Mode: %s\n", config.mode == MODE_STANDARD ? "Standard" : "Timed");
+        printf("World: %dx%d\n", config.width, config.height);
+        printf("Obstacles: %s\n", config.world_type == WORLD_WITH_OBSTACLES ? "Yes" : "No");
+        printf("Max players: %d (%s)\n", config.max_players, 
+               config.max_players == 1 ? "Singleplayer" : "Multiplayer");
+        printf("Tick rate: %d/s\n", tick_rate);
+        
+        int game_id = start_game(&registry, &config);//vytvor hru s danou konfiguraciou
+        if (game_id < 0) {//ak sa nepodarilo vytvorit
+            fprintf(stderr, "Failed to create game\n");
+            stop_checkpoints(checkpointer);
+            destroy_game_registry(&registry);
+            return 1;
+        }
+        printf("Game %d started\n", game_id);
     }
     
     // Create server socket
-    int server_socket = create_server_socket(port);//vytvor serverovy socket
+    if (server_socket < 0) {
+        server_socket = create_server_socket(port);//vytvor serverovy socket
+    }
     if (server_socket < 0) {//ak sa nepodarilo vytvorit
         fprintf(stderr, "Failed to create server socket\n");
-        destroy_game(game);
+        stop_checkpoints(checkpointer);
+        destroy_game_registry(&registry);
         return 1;
     }
     
-    printf("Server listening on port %d\n", port);
+    if (use_datagrams && datagram_socket < 0) {
+        datagram_socket = create_datagram_socket(port);
+        if (datagram_socket < 0) {//klienti dostanu snapshoty cez TCP
+            fprintf(stderr, "Cannot open UDP port %d, snapshots use TCP only\n", port);
+        }
+    }
     
-    // Start game loop thread
-    pthread_t game_thread;//vlakno pre hernu slucku
-    pthread_create(&game_thread, NULL, game_loop, NULL);//spusti hernu slucku v samostatnom vlakne
+    printf("Server listening on port %d%s\n", port, datagram_socket >= 0 ? " (TCP and UDP)" : "");
     
-    // Accept clients
-    while (server_running && !game->state.game_over) {//kym bezi server a hra nie je ukoncena
-        fd_set readfds;//mnozina file descriptorov
-        FD_ZERO(&readfds);//vymaz mnozinu
-        FD_SET(server_socket, &readfds);//pridaj serverovy socket
-        
-        struct timeval timeout;//timeout pre select
-        timeout.tv_sec = 1;//1 sekunda
-        timeout.tv_usec = 0;
-        
-        int activity = select(server_socket + 1, &readfds, NULL, NULL, &timeout);//cakaj na aktivitu alebo timeout
-        
-        if (activity > 0 && FD_ISSET(server_socket, &readfds)) {//ak je aktivita na serverovom sockete
-            int client_socket = accept_client(server_socket);//prijmi klienta
-            if (client_socket >= 0) {//ak sa podarilo prijat
-                printf("New client connected\n");
-                
-                int *sock_ptr = malloc(sizeof(int));//alokuj pamat pre socket descriptor
-                *sock_ptr = client_socket;
-                
-                pthread_t thread;//vlakno pre klienta
-                pthread_create(&thread, NULL, client_handler, sock_ptr);//spusti handler v samostatnom vlakne
-                pthread_detach(thread);//odpoj vlakno (automaticke upratanie po skonceni)
+    // Serve clients
+    EventLoop *loop = create_event_loop(server_socket, &registry);//epoll reaktor pre vsetkych klientov a hry
+    if (loop && datagram_socket >= 0 && !watch_datagram_socket(loop, datagram_socket)) {//pred prevzatymi spojeniami (ich UDP adresy)
+        close_socket(datagram_socket);
+        datagram_socket = -1;
+    }
+    for (int i = 0; i < handed_count; i++) {//prevzate spojenia (pri chybe sa zatvoria)
+        if (!loop) {
+            close_socket(handed[i].socket);
+            release_game(handed[i].game);
+        } else {
+            adopt_connection(loop, &handed[i]);
+        }
+    }
+    free_handoff_connections(handed, handed_count);
+    
+    int handoff_socket = -1;//nasledovnik sa pripaja sem
+    if (loop && handoff_path) {
+        handoff_socket = open_handoff_socket(handoff_path);
+        if (handoff_socket < 0 || !watch_handoff_socket(loop, handoff_socket)) {
+            fprintf(stderr, "Cannot listen for handoff on %s\n", handoff_path);
+        }
+    }
+    
+    bool handed_off = false;//hry a klientov prevzal novy proces
+    if (loop) {
+        while (!handed_off) {
+            run_event_loop(loop, &server_running);//obsluhuj klientov kym bezi server
+            int successor = take_successor(loop);
+            if (successor < 0) {//server konci
+                break;
+            }
+            if (accept_handoff_request(successor)) {
+                stop_checkpoints(checkpointer);//posledny checkpoint, dalej ich pise nasledovnik
+                checkpointer = NULL;
+                handed_off = hand_off(successor, loop, &registry, server_socket, datagram_socket);
+                if (!handed_off) {
+                    fprintf(stderr, "Handoff failed, server continues\n");
+                    checkpointer = checkpoint_dir ? start_checkpoints(&registry, checkpoint_dir) : NULL;
+                }
             }
+            close(successor);
         }
+        stop_checkpoints(checkpointer);//posledny checkpoint este s pripojenymi hracmi
+        checkpointer = NULL;
+        destroy_event_loop(loop);//zatvor vsetky klientske spojenia
+    } else {
+        fprintf(stderr, "Failed to create event loop\n");
     }
     
     // Cleanup
-    printf("Shutting down server...\n");
-    pthread_join(game_thread, NULL);//pocakaj na ukoncenie hernej slucky
+    printf(handed_off ? "Handed over to new server...\n" : "Shutting down server...\n");
+    stop_checkpoints(checkpointer);//ak event loop nevznikol
+    if (handoff_socket >= 0) {
+        close(handoff_socket);
+        if (!handed_off) {//cesta uz patri nasledovnikovi
+            unlink(handoff_path);
+        }
+    }
     close_socket(server_socket);//zatvor serverovy socket
-    destroy_game(game);//znic hru a uvolni zdroje
+    if (datagram_socket >= 0) {
+        close_socket(datagram_socket);
+    }
+    destroy_game_registry(&registry);//zastav vsetky hry a uvolni zdroje
     
     printf("Server stopped\n");
     return 0;
@@ -28,25 +28,11 @@ void init_snake(Snake *snake, int player_id, int start_x, int start_y, const cha
  * @param height World height
  * @param wrap_around Enable wrapping around edges (no obstacles mode)
  * 
- * Moves head forward, removes tail. Does not move if paused or direction is NONE.
+ * Applies oldest queued turn, moves head forward, removes tail.
+ * Does not move if paused or direction is NONE.
  */
 void move_snake(Snake *snake, int width, int height, bool wrap_around);
 
-/**
- * @brief Check if snake collides with itself
- * @param snake Snake to check
- * @return true if head collides with body, false otherwise
- */
-bool check_self_collision(const Snake *snake);
-
-/**
- * @brief Check collision between two snakes
- * @param snake1 First snake
- * @param snake2 Second snake
- * @return true if snake1's head collides with snake2's body, false otherwise
- */
-bool check_collision_with_snake(const Snake *snake1, const Snake *snake2);
-
 /**
  * @brief Grow snake by one segment
  * @param snake Snake to grow
@@ -55,21 +41,15 @@ bool check_collision_with_snake(const Snake *snake1, const Snake *snake2);
  */
 void grow_snake(Snake *snake);
 
-/**
- * @brief Check if position is on snake's body
- * @param snake Snake to check
- * @param pos Position to check
- * @return true if position is on snake, false otherwise
- */
-bool is_position_on_snake(const Snake *snake, Position pos);
-
 /**
  * @brief Change snake's direction
  * @param snake Snake to change
  * @param new_direction New direction
  * 
- * Prevents 180-degree turns (opposite direction).
- * Stores new direction in pending_direction for next tick.
+ * Appends turn to the snake's turn queue; move_snake applies one queued
+ * turn per tick. Turns are validated against the last queued direction:
+ * repeats and 180-degree reversals are ignored, as are turns beyond
+ * TURN_QUEUE_SIZE.
  */
 void change_direction(Snake *snake, Direction new_direction);
 
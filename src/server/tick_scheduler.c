@@ -0,0 +1,68 @@
+#include "tick_scheduler.h"
+#include <errno.h>
+
+#define NSEC_PER_SEC 1000000000LL
+
+static int64_t to_ns(const struct timespec *ts) {//prevod timespec na nanosekundy
+    return (int64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+static struct timespec from_ns(int64_t ns) {//prevod nanosekund na timespec
+    struct timespec ts;
+    ts.tv_sec = ns / NSEC_PER_SEC;
+    ts.tv_nsec = ns % NSEC_PER_SEC;
+    return ts;
+}
+
+static int64_t now_ns(void) {//aktualny monotonny cas
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return to_ns(&now);
+}
+
+void init_tick_scheduler(TickScheduler *scheduler, int tick_rate, int max_catch_up) {//zacne rozvrh tikov
+    scheduler->period_ns = NSEC_PER_SEC / tick_rate;
+    scheduler->max_catch_up = max_catch_up;
+    scheduler->deadline = from_ns(now_ns() + scheduler->period_ns);//prvy tik o jednu periodu
+    scheduler->wakeup_ns = 0;
+    TickStats empty = { 0 };
+    scheduler->stats = empty;
+}
+
+int wait_for_tick(TickScheduler *scheduler) {//caka na dalsi termin, vrati pocet tikov na odsimulovanie
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &scheduler->deadline, NULL) == EINTR) {//absolutny termin, signal nevadi
+    }
+
+    int64_t deadline = to_ns(&scheduler->deadline);
+    int64_t now = now_ns();
+    int64_t late = now > deadline ? now - deadline : 0;//oneskorenie prebudenia
+    scheduler->wakeup_ns = now;
+
+    // Every deadline that already passed is one due tick
+    int64_t passed = 1 + late / scheduler->period_ns;
+    int64_t due = passed;
+    if (due > 1 + scheduler->max_catch_up) {//prilis pozadu - zvysok preskoc
+        due = 1 + scheduler->max_catch_up;
+        scheduler->stats.skipped += passed - due;
+    }
+    scheduler->deadline = from_ns(deadline + passed * scheduler->period_ns);//dalsi termin ostava na povodnej mriezke
+
+    scheduler->stats.wakeups++;
+    scheduler->stats.ticks += due;
+    scheduler->stats.caught_up += due - 1;
+    scheduler->stats.total_jitter_ns += late;
+    if (late > scheduler->stats.max_jitter_ns) {
+        scheduler->stats.max_jitter_ns = late;
+    }
+    return (int)due;
+}
+
+void finish_tick(TickScheduler *scheduler) {//zaznamena dlzku prace v tiku
+    int64_t work = now_ns() - scheduler->wakeup_ns;
+    if (work > scheduler->period_ns) {//tik nestihol svoju periodu
+        scheduler->stats.overruns++;
+    }
+    if (work > scheduler->stats.max_work_ns) {
+        scheduler->stats.max_work_ns = work;
+    }
+}
@@ -0,0 +1,70 @@
+/**
+ * @file tick_scheduler.h
+ * @brief Fixed-timestep tick scheduler on CLOCK_MONOTONIC
+ *
+ * Ticks are due at absolute deadlines start + n * period, so time spent in
+ * the simulation or in a late wakeup never shifts the following ticks and
+ * the game runs at the same speed no matter how busy the machine is.
+ * A tick thread that falls behind runs the missed ticks back to back
+ * (catch-up) up to a limit; ticks beyond it are skipped and the schedule
+ * stays on its original grid.
+ */
+
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/** Default number of missed ticks run back to back before skipping */
+#define DEFAULT_MAX_CATCH_UP_TICKS 5
+
+/**
+ * @brief Tick timing counters
+ */
+typedef struct {
+    uint64_t ticks;             /**< Simulated ticks */
+    uint64_t wakeups;           /**< Scheduler wakeups (batches of ticks) */
+    uint64_t caught_up;         /**< Ticks run late, back to back with the previous one */
+    uint64_t skipped;           /**< Ticks dropped (over catch-up limit) */
+    uint64_t overruns;          /**< Batches whose work took longer than one period */
+    int64_t total_jitter_ns;    /**< Sum of wakeup lateness */
+    int64_t max_jitter_ns;      /**< Largest wakeup lateness */
+    int64_t max_work_ns;        /**< Longest batch work time */
+} TickStats;
+
+/**
+ * @brief Deadline scheduler of one tick thread
+ */
+typedef struct {
+    int64_t period_ns;          /**< Tick period */
+    int max_catch_up;           /**< Missed ticks run back to back (0 = skip all missed) */
+    struct timespec deadline;   /**< Absolute CLOCK_MONOTONIC time of next tick */
+    int64_t wakeup_ns;          /**< Time of last wakeup (start of batch work) */
+    TickStats stats;            /**< Timing counters */
+} TickScheduler;
+
+/**
+ * @brief Start schedule, first tick is due one period from now
+ * @param scheduler Scheduler to initialize
+ * @param tick_rate Ticks per second (> 0)
+ * @param max_catch_up Missed ticks run back to back before skipping
+ */
+void init_tick_scheduler(TickScheduler *scheduler, int tick_rate, int max_catch_up);
+
+/**
+ * @brief Sleep until next deadline
+ * @param scheduler Scheduler
+ * @return Number of ticks to simulate now (1 when on time, more when
+ *         catching up)
+ */
+int wait_for_tick(TickScheduler *scheduler);
+
+/**
+ * @brief Record end of batch work started by wait_for_tick
+ * @param scheduler Scheduler
+ */
+void finish_tick(TickScheduler *scheduler);
+
+#endif // TICK_SCHEDULER_H